@@ -13,6 +13,7 @@
 #include "debug.h"
 
 #include "allocation.h"
+#include "page_allocation.h"
 #include "placement_construction.h"
 
 
@@ -69,6 +70,11 @@ namespace tt {
 		// The maximum array size which may be allocated by the allocator.
 		static constexpr size_type MAX_SIZE = tt::max_of<size_type>;
 
+		// The number of bytes at or above which blocks are page allocated, via tt::page_alloc_uninit, rather than heap allocated.
+		// Page allocated blocks may be resized without copying, via reallocate and try_expand.
+		// Alignments beyond the minimum page size are always heap allocated.
+		static constexpr tt_size PAGE_THRESHOLD = ALIGNMENT <= 4096 ? (tt_size)1024 * 1024 : tt::max_size;
+
 		// Default initializes an aligned allocator.
 		inline aligned_allocator() noexcept = default;
 
@@ -100,22 +106,55 @@ namespace tt {
 		inline tt_bool operator!=(const this_t& rhs) const noexcept { return !equal(rhs); }
 
 		// Invokes the allocator to allocator a block of n values, returning a pointer to this block.
-		// This wraps tt::aligned_alloc_uninit and may throw accordingly.
+		// This wraps tt::aligned_alloc_uninit and may throw accordingly, or tt::page_alloc_uninit for blocks of at least PAGE_THRESHOLD bytes.
 		inline pointer allocate(size_type n) {
 
 
+			if (_is_page_backed(n))
+				return tt::page_alloc_uninit<value_type>(n);
+
 			return tt::aligned_alloc_uninit<value_type>(n, ALIGNMENT);
 		}
 
 		// Invokes the allocator to deallocate a block at address p of n values previous allocated by the allocator.
-		// This wraps tt::aligned_dealloc_uninit and will not throw.
+		// This wraps tt::aligned_dealloc_uninit and will not throw, or tt::page_dealloc_uninit for blocks of at least PAGE_THRESHOLD bytes.
 		inline void deallocate(pointer p, size_type n) noexcept {
 
 
-			if (p)
+			if (!p)
+				return;
+
+			if (_is_page_backed(n))
+				tt::page_dealloc_uninit<value_type>(p, n);
+
+			else
 				tt::aligned_dealloc_uninit<value_type>(p);
 		}
 
+		// Invokes the allocator to resize block p of old_n values to new_n values without copying, possibly moving it.
+		// Returns the resized block, or nullptr (leaving p untouched) if this isn't possible, which is the case unless both sizes are page allocated.
+		// This wraps tt::page_realloc_uninit and will not throw.
+		inline pointer reallocate(pointer p, size_type old_n, size_type new_n) noexcept {
+
+
+			if (_is_page_backed(old_n) && _is_page_backed(new_n))
+				return tt::page_realloc_uninit<value_type>(p, old_n, new_n);
+
+			return nullptr;
+		}
+
+		// Invokes the allocator to resize block p of old_n values to new_n values in place, returning if this succeeded.
+		// This is only possible if both sizes are page allocated.
+		// This wraps tt::page_try_expand_uninit and will not throw.
+		inline tt_bool try_expand(pointer p, size_type old_n, size_type new_n) noexcept {
+
+
+			if (_is_page_backed(old_n) && _is_page_backed(new_n))
+				return tt::page_try_expand_uninit<value_type>(p, old_n, new_n);
+
+			return false;
+		}
+
 		// Invokes the allocator to placement-construct an object of type U at address p, passing args to its constructor.
 		// This wraps tt::construct_at and may throw accordingly.
 		template<typename U, typename... Args> 
@@ -133,6 +172,15 @@ namespace tt {
 
 			tt::destroy_at(p);
 		}
+
+
+	private:
+
+		static constexpr tt_bool _is_page_backed(size_type n) noexcept {
+
+
+			return n >= PAGE_THRESHOLD / sizeof(value_type) + (PAGE_THRESHOLD % sizeof(value_type) != 0);
+		}
 	};
 }
 
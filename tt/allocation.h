@@ -6,11 +6,19 @@
 // A header file defining the low-level memory allocation functions of the Tirous Toolbox library.
 
 
+#include <cstring>
+#include <memory>
+#include <utility>
+
 #include "aliases.h"
 #include "compiler_detect.h"
 //#include "config.h"
 #include "macros.h"
 
+#if defined(TT_CONFIG_SIZE_CLASS_ALLOC)
+#include "size_class_allocation.h"
+#endif
+
 
 namespace tt {
 
@@ -67,7 +75,11 @@ namespace tt {
 		if (n == 0)
 			return nullptr;
 
+#if defined(TT_CONFIG_SIZE_CLASS_ALLOC)
+		return (Value*)tt::size_class_alloc(n * sizeof(Value), alignof(std::max_align_t));
+#else
 		return (Value*)std::malloc(n * sizeof(Value));
+#endif
 	}
 
 	// Deallocates arrays of uninitialized memory allocated using tt::alloc_uninit.
@@ -77,12 +89,17 @@ namespace tt {
 	inline void dealloc_uninit(Value* x) {
 
 
+#if defined(TT_CONFIG_SIZE_CLASS_ALLOC)
+		tt::size_class_dealloc((void*)x);
+#else
 		if (x)
 			std::free((void*)x);
+#endif
 	}
 
 	// A version of tt::alloc_uninit which allocates an block of memory who's address adheres to the given alignment.
 	// This function wraps std::aligned_alloc by default, or _aligned_malloc on MSVC.
+	// If TT_CONFIG_SIZE_CLASS_ALLOC is defined, this function, like tt::alloc_uninit, wraps tt::size_class_alloc instead.
 	// To this end, the alignment and size should follow the rules regarding whichever it's wrapping.
 	// If either n or alignment is zero, nullptr is returned. Beyond that, std::aligned_alloc/_aligned_malloc rules should be followed.
 	// Allocations made using this should be released using tt::aligned_dealloc_uninit.
@@ -96,7 +113,9 @@ namespace tt {
 		else if (alignment == 0)
 			return nullptr;
 
-#if defined(TT_COMPILER_IS_MSVC)
+#if defined(TT_CONFIG_SIZE_CLASS_ALLOC)
+		return (Value*)tt::size_class_alloc(n * sizeof(Value), alignment);
+#elif defined(TT_COMPILER_IS_MSVC)
 		return (Value*)_aligned_malloc(n * sizeof(Value), alignment);
 #else
 		return (Value*)std::aligned_alloc(alignment, n * sizeof(Value));
@@ -113,11 +132,42 @@ namespace tt {
 		if (!(x))
 			return;
 
-#if defined(TT_COMPILER_IS_MSVC)
+#if defined(TT_CONFIG_SIZE_CLASS_ALLOC)
+		tt::size_class_dealloc((void*)x);
+#elif defined(TT_COMPILER_IS_MSVC)
 		_aligned_free((void*)x);
 #else
 		std::free((void*)x);
 #endif
 	}
-}
 
+
+	// NOTE: detects the optional reallocate/try_expand allocator extension points, which containers
+	//		 (ie. tt::chunk) may use to resize trivially-relocatable blocks without copying them
+	//
+	//		 pointer reallocate(pointer p, size_type old_n, size_type new_n) resizes block p, possibly
+	//		 moving it, returning the resized block, or nullptr (leaving p untouched) if it can't
+	//
+	//		 bool try_expand(pointer p, size_type old_n, size_type new_n) resizes block p in place,
+	//		 returning if it could
+
+	template<typename Allocator, typename = void>
+	struct allocator_has_reallocate : std::false_type {};
+
+	template<typename Allocator>
+	struct allocator_has_reallocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().reallocate(std::declval<typename std::allocator_traits<Allocator>::pointer>(), tt_size{}, tt_size{}))>> : std::true_type {};
+
+	template<typename Allocator, typename = void>
+	struct allocator_has_try_expand : std::false_type {};
+
+	template<typename Allocator>
+	struct allocator_has_try_expand<Allocator, std::void_t<decltype(std::declval<Allocator&>().try_expand(std::declval<typename std::allocator_traits<Allocator>::pointer>(), tt_size{}, tt_size{}))>> : std::true_type {};
+
+	// If allocator type Allocator provides the reallocate extension point.
+	template<typename Allocator>
+	constexpr tt_bool allocator_has_reallocate_v = tt::allocator_has_reallocate<Allocator>::value;
+
+	// If allocator type Allocator provides the try_expand extension point.
+	template<typename Allocator>
+	constexpr tt_bool allocator_has_try_expand_v = tt::allocator_has_try_expand<Allocator>::value;
+}
@@ -0,0 +1,438 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's monotonic 'arena' memory allocator, and its associated allocator adaptor.
+
+// An arena hands out memory by bumping a pointer through a chain of large blocks, and never frees
+// individual allocations. Instead, all memory allocated from the arena is released at once, either
+// by resetting the arena (which keeps its blocks for reuse) or by destroying it.
+
+// This makes arenas ideal for short-lived scratch memory, such as that of a single request, where
+// many small allocations are made, then all discarded together.
+
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "numeric_limits.h"
+#include "math_util.h"
+#include "allocation.h"
+#include "placement_construction.h"
+
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's monotonic 'arena' memory allocator.
+	// Memory allocated from an arena is only released when the arena is reset, released, or destroyed.
+	// Destructors of objects placed in an arena are never invoked by the arena.
+	// Arenas are not thread-safe.
+	class arena final {
+	public:
+
+		using this_t = arena;
+
+		// The default number of bytes in each block of an arena.
+		static constexpr tt_size DEFAULT_BLOCK_SIZE = 64ULL * 1024ULL;
+
+
+		// Initializes an arena which allocates blocks of block_size bytes.
+		// No block is allocated until the first allocation is made.
+		// Allocations larger than block_size are given a block of their own.
+		inline explicit arena(tt_size block_size = DEFAULT_BLOCK_SIZE) noexcept;
+
+		arena(const this_t&) = delete;
+		inline arena(this_t&& x) noexcept;
+
+		inline ~arena() noexcept;
+
+		this_t& operator=(const this_t&) = delete;
+		inline this_t& operator=(this_t&& rhs) noexcept;
+
+
+		// Returns the number of bytes in each block of the arena.
+		constexpr tt_size block_size() const noexcept { return _block_size; }
+
+		// Returns the number of bytes allocated from the arena since it was last reset, including padding used for alignment.
+		constexpr tt_size bytes_used() const noexcept { return _used; }
+
+		// Returns the total number of bytes of block memory owned by the arena.
+		constexpr tt_size bytes_reserved() const noexcept { return _reserved; }
+
+		// Returns the number of blocks owned by the arena.
+		constexpr tt_size blocks() const noexcept { return _blocks; }
+
+
+		// Allocates n bytes of uninitialized memory from the arena, aligned to alignment.
+		// The alignment must be a power of two.
+		// If n is zero, nullptr is returned.
+		// Throws std::bad_alloc if a new block is needed but cannot be allocated, including if its size would exceed the max size.
+		inline void* allocate(tt_size n, tt_size alignment = alignof(std::max_align_t));
+
+		// Allocates uninitialized memory for n values of type Value from the arena.
+		// If n is zero, nullptr is returned.
+		// Throws std::bad_array_new_length if n values would exceed the max size, and std::bad_alloc if a new block is needed but cannot be allocated.
+		template<typename Value>
+		inline Value* allocate_n(tt_size n = 1) {
+
+
+			if (n > tt::max_size / sizeof(Value))
+				throw std::bad_array_new_length();
+
+			return (Value*)allocate(n * sizeof(Value), alignof(Value));
+		}
+
+		// Allocates and placement-constructs a Value in the arena, passing args to its constructor.
+		// The Value's destructor will never be invoked by the arena.
+		template<typename Value, typename... Args>
+		inline Value* make(Args&&... args) { return tt::construct_at(allocate_n<Value>(), TT_FMOVE_N(Args, args)); }
+
+
+		// Resets the arena, invalidating all memory allocated from it, while keeping its blocks for reuse.
+		// This does not release any memory, nor invoke any destructors, and is thus effectively a single pointer reset.
+		inline void reset() noexcept;
+
+		// Resets the arena, and releases all of its blocks.
+		inline void release() noexcept;
+
+
+	private:
+
+		struct _block final {
+
+			_block*		next;
+			tt_size		size;
+
+			inline tt_byte* data() noexcept { return (tt_byte*)(this + 1); }
+		};
+
+		tt_size		_block_size	= DEFAULT_BLOCK_SIZE;
+		_block*		_head		= nullptr;
+		_block*		_current	= nullptr;
+		tt_byte*	_cursor		= nullptr;
+		tt_byte*	_end		= nullptr;
+		tt_size		_used		= 0;
+		tt_size		_reserved	= 0;
+		tt_size		_blocks		= 0;
+
+		static inline tt_byte* _align_up(tt_byte* x, tt_size alignment) noexcept {
+
+
+			return (tt_byte*)(((tt_uintptr)x + (alignment - 1)) & ~(tt_uintptr)(alignment - 1));
+		}
+
+		inline void _enter(_block* x) noexcept;
+
+		inline void* _allocate_slow(tt_size n, tt_size alignment);
+	};
+
+
+	inline tt::arena::arena(tt_size block_size) noexcept
+		: _block_size(block_size > 0 ? block_size : DEFAULT_BLOCK_SIZE) {}
+
+	inline tt::arena::arena(this_t&& x) noexcept {
+
+
+		TT_MOVE(_block_size, x);
+		TT_MOVEPTR(_head, x);
+		TT_MOVEPTR(_current, x);
+		TT_MOVEPTR(_cursor, x);
+		TT_MOVEPTR(_end, x);
+		TT_MOVESET(_used, x, 0);
+		TT_MOVESET(_reserved, x, 0);
+		TT_MOVESET(_blocks, x, 0);
+	}
+
+	inline tt::arena::~arena() noexcept {
+
+
+		release();
+	}
+
+	inline arena& tt::arena::operator=(this_t&& rhs) noexcept {
+
+
+		TT_SELF_MOVE_TEST(rhs);
+
+		release();
+
+		TT_MOVE(_block_size, rhs);
+		TT_MOVEPTR(_head, rhs);
+		TT_MOVEPTR(_current, rhs);
+		TT_MOVEPTR(_cursor, rhs);
+		TT_MOVEPTR(_end, rhs);
+		TT_MOVESET(_used, rhs, 0);
+		TT_MOVESET(_reserved, rhs, 0);
+		TT_MOVESET(_blocks, rhs, 0);
+
+		TT_RETURN_THIS;
+	}
+
+	inline void* tt::arena::allocate(tt_size n, tt_size alignment) {
+
+
+		tt_assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+		if (n == 0)
+			return nullptr;
+
+		// NOTE: this is the fast path, which is just an align and a bump
+
+		if (_cursor) {
+
+
+			auto _p = _align_up(_cursor, alignment);
+
+			if (_p <= _end && (tt_size)(_end - _p) >= n) {
+
+
+				_used += (tt_size)(_p - _cursor) + n;
+
+				_cursor = _p + n;
+
+				return (void*)_p;
+			}
+		}
+
+		return _allocate_slow(n, alignment);
+	}
+
+	inline void tt::arena::reset() noexcept {
+
+
+		_used = 0;
+
+		if (_head)
+			_enter(_head);
+	}
+
+	inline void tt::arena::release() noexcept {
+
+
+		auto _p = _head;
+
+		while (_p) {
+
+
+			auto _next = _p->next;
+
+			tt::dealloc_uninit(_p);
+
+			_p = _next;
+		}
+
+		_head = nullptr;
+		_current = nullptr;
+		_cursor = nullptr;
+		_end = nullptr;
+		_used = 0;
+		_reserved = 0;
+		_blocks = 0;
+	}
+
+	inline void tt::arena::_enter(_block* x) noexcept {
+
+
+		tt_assert(x);
+
+		_current = x;
+		_cursor = x->data();
+		_end = x->data() + x->size;
+	}
+
+	inline void* tt::arena::_allocate_slow(tt_size n, tt_size alignment) {
+
+
+		// NOTE: the worst-case padding needed to align within a fresh block is alignment - 1 bytes
+
+		if (n > tt::max_size - (alignment - 1))
+			throw std::bad_alloc();
+
+		const auto _needed = n + alignment - 1;
+
+		// NOTE: following a reset, reuse the blocks already chained after the current one, so long
+		//		 as they're big enough, rather than allocating anew
+
+		while (_current && _current->next) {
+
+
+			_enter(_current->next);
+
+			auto _p = _align_up(_cursor, alignment);
+
+			if (_p <= _end && (tt_size)(_end - _p) >= n) {
+
+
+				_used += (tt_size)(_p - _cursor) + n;
+
+				_cursor = _p + n;
+
+				return (void*)_p;
+			}
+		}
+
+		const auto _size = tt::max(_block_size, _needed);
+
+		if (_size > tt::max_size - sizeof(_block))
+			throw std::bad_alloc();
+
+		auto _new = (_block*)tt::alloc_uninit<tt_byte>(sizeof(_block) + _size);
+
+		if (!_new)
+			throw std::bad_alloc();
+
+		_new->next = nullptr;
+		_new->size = _size;
+
+		// NOTE: splice the new block in after the current one, so any blocks beyond it remain reusable
+
+		if (_current)
+			_new->next = _current->next,
+			_current->next = _new;
+		else
+			_new->next = _head,
+			_head = _new;
+
+		_reserved += _size;
+		++_blocks;
+
+		_enter(_new);
+
+		auto _p = _align_up(_cursor, alignment);
+
+		_used += (tt_size)(_p - _cursor) + n;
+
+		_cursor = _p + n;
+
+		return (void*)_p;
+	}
+
+
+	// NOTE: this is not marked final, as some standard library implementations derive from their allocators
+
+	// An allocator adaptor which allocates from a tt::arena, usable with tt::chunk and standard library containers.
+	// Deallocation is a no-op, with memory only being released when the arena is reset, released, or destroyed.
+	// A default initialized arena allocator is not bound to any arena, and may not allocate until bound to one (ie. via assignment.)
+	// Two arena allocators are equal if they're bound to the same arena.
+	template<typename Value, tt_size Alignment = alignof(Value)>
+	struct arena_allocator {
+
+		using value_t = typename Value;
+
+		// The alignment of the allocator.
+		static constexpr tt_size ALIGNMENT = Alignment;
+
+		// defining this for rebind
+
+		template<typename U>
+		using arena_allocator_t = tt::arena_allocator<U, (alignof(U) > ALIGNMENT ? alignof(U) : ALIGNMENT)>;
+
+		using this_t = tt::arena_allocator<value_t, ALIGNMENT>;
+
+		using pointer = value_t*;
+		using const_pointer = const value_t*;
+		using void_pointer = void*;
+		using const_void_pointer = const void*;
+
+		using value_type = value_t;
+
+		using size_type = tt_size;
+		using difference_type = std::ptrdiff_t;
+
+		using is_always_equal = std::false_type;
+
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		template<typename U>
+		struct rebind final { using other = arena_allocator_t<U>; };
+
+		// The maximum array size which may be allocated by the allocator.
+		static constexpr size_type MAX_SIZE = tt::max_of<size_type> / sizeof(value_t);
+
+		// The arena the allocator is bound to, or nullptr if unbound.
+		tt::arena* target = nullptr;
+
+		// Default initializes an arena allocator, which is unbound.
+		inline arena_allocator() noexcept = default;
+
+		// Initializes an arena allocator bound to arena a.
+		inline arena_allocator(tt::arena& a) noexcept
+			: target(&a) {}
+
+		// Initializes an allocator of a different underlying type.
+		template<typename Other, tt_size OtherAlignment>
+		inline arena_allocator(const tt::arena_allocator<Other, OtherAlignment>& x) noexcept
+			: target(x.target) {}
+
+		// Copy-initializes an arena allocator.
+		inline arena_allocator(const this_t& x) noexcept
+			: target(x.target) {}
+
+		inline ~arena_allocator() noexcept = default;
+
+		inline this_t& operator=(const this_t& rhs) noexcept { TT_COPY(target, rhs); TT_RETURN_THIS; }
+
+		// Returns the maximum array size allocatable by this allocator.
+		constexpr size_type max_size() const noexcept { return MAX_SIZE; }
+
+		// Returns a version of this allocator that should be used when copy-constructing the allocator's owner.
+		constexpr this_t select_on_container_copy_construction() const noexcept { return this_t(*this); }
+
+		// Returns if this and the given arena allocator are equal.
+		template<typename Other, tt_size OtherAlignment>
+		constexpr tt_bool equal(const tt::arena_allocator<Other, OtherAlignment>& x) const noexcept { return target == x.target; }
+
+		template<typename Other, tt_size OtherAlignment>
+		inline tt_bool operator==(const tt::arena_allocator<Other, OtherAlignment>& rhs) const noexcept { return equal(rhs); }
+		template<typename Other, tt_size OtherAlignment>
+		inline tt_bool operator!=(const tt::arena_allocator<Other, OtherAlignment>& rhs) const noexcept { return !equal(rhs); }
+
+		// Invokes the allocator to allocator a block of n values, returning a pointer to this block.
+		// Throws std::bad_array_new_length if n exceeds MAX_SIZE, and std::bad_alloc if the allocation fails.
+		// Behaviour is undefined if the allocator is unbound.
+		inline pointer allocate(size_type n) {
+
+
+			// NOTE: unbound allocators do not fallback to the heap, as deallocate being a no-op would leak
+			//		 such allocations, and propagation would let arena-backed and heap-backed blocks mix
+
+			tt_assert(target);
+
+			if (n > MAX_SIZE)
+				throw std::bad_array_new_length();
+
+			return (pointer)target->allocate(n * sizeof(value_type), ALIGNMENT);
+		}
+
+		// Invokes the allocator to deallocate a block at address p of n values previous allocated by the allocator.
+		// This does nothing, as memory is only released by the allocator's arena.
+		inline void deallocate(pointer p, size_type n) noexcept {}
+
+		// Invokes the allocator to placement-construct an object of type U at address p, passing args to its constructor.
+		// This wraps tt::construct_at and may throw accordingly.
+		template<typename U, typename... Args>
+		inline void construct(U* p, Args&&... args) {
+
+
+			tt::construct_at(p, TT_FMOVE_N(Args, args));
+		}
+
+		// Invokes the allocator to placement-destroy an object of type U at address p.
+		// This wraps tt::destroy_at and will not throw.
+		template<typename U>
+		inline void destroy(U* p) noexcept {
+
+
+			tt::destroy_at(p);
+		}
+	};
+}
@@ -0,0 +1,474 @@
+
+
+#pragma once
+
+
+// A header file defining the Tirous Toolbox library's 'bulk' hash, a high-throughput non-cryptographic
+// hash of arrays of bytes, used by tt::array_hash_of to hash arrays of types whose values are equal only
+// if their bytes are.
+
+// Unlike tt::hash_factory, which performs one dependent multiply per element hashed, the bulk hash
+// consumes 48 bytes per iteration, across three independent 64-bit lanes, and so is limited by memory
+// bandwidth, rather than multiply latency, when hashing large arrays.
+
+// Arrays may also be hashed in pieces (ie. as they're read from a file, or appended to a chunk) via
+// tt::bulk_hasher, which produces the same hash codes as hashing the concatenation of its pieces would.
+
+// Arrays of integral values (ie. string literals) may also be hashed at compile-time via tt::bulk_hash_array,
+// which produces the same hash codes at compile-time as at runtime, such that tt::basic_str may hash its
+// literals at compile-time, while still producing the same hash codes as strings hashed at runtime.
+
+
+/*
+
+	The bulk hash is a wyhash-style hash, following wyhash 'final4' by Wang Yi (released into the public domain), with
+	each step multiplying two 64-bit words into a 128-bit product, and folding its halves together via XOR.
+
+	The hash is defined over the bytes of its input as little-endian words, and produces the same hash codes on all
+	platforms of the same endianness, regardless of whether tt_size is 32-bit or 64-bit (with 32-bit hash codes being
+	the two halves of the 64-bit hash code folded together.)
+
+	Bulk hashers buffer at most 48 bytes, alongside the 16 bytes preceding them, as the final step of the bulk hash
+	reads the last 16 bytes of its input, even if fewer than 16 bytes remain after its last 48 byte block, and so a
+	bulk hasher's state is a small, trivially copyable, value, which may be copied to checkpoint partial hashes.
+
+	The bulk hash is NOT vectorized, as SSE2/AVX2/NEON lack a fast 64x64-bit to 128-bit multiply, which scalar code
+	has, and as three independent multiply lanes already keep the CPU's multipliers busy.
+
+*/
+
+
+#include <cstring>
+#include <type_traits>
+
+#include "aliases.h"
+#include "compiler_detect.h"
+#include "config.h"
+#include "macros.h"
+
+#if defined(TT_COMPILER_IS_MSVC) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+
+namespace _tt {
+
+
+	constexpr tt_uint64 bulk_hash_secret[4] = {
+
+		0x2d358dccaa6c78a5ull,
+		0x8bb84b93962eacc9ull,
+		0x4b33a62ed433d4a3ull,
+		0x4d5a2da51de1aa47ull,
+	};
+
+	// NOTE: multiplies a and b into a 128-bit product, with a becoming its low half, and b its high half
+
+	constexpr void bulk_hash_mum(tt_uint64& a, tt_uint64& b) noexcept {
+
+
+#if defined(__SIZEOF_INT128__)
+		const auto r = (unsigned __int128)a * b;
+
+		a = (tt_uint64)r;
+		b = (tt_uint64)(r >> 64);
+#else
+#if defined(TT_COMPILER_IS_MSVC) && defined(_M_X64)
+		if (!TT_IS_CONSTANT_EVALUATED()) {
+
+
+			a = _umul128(a, b, &b);
+
+			return;
+		}
+#elif defined(TT_COMPILER_IS_MSVC) && defined(_M_ARM64)
+		if (!TT_IS_CONSTANT_EVALUATED()) {
+
+
+			const auto _lo = a * b;
+
+			b = __umulh(a, b);
+			a = _lo;
+
+			return;
+		}
+#endif
+		const tt_uint64 _ha = a >> 32, _hb = b >> 32, _la = (tt_uint32)a, _lb = (tt_uint32)b;
+		const tt_uint64 _rh = _ha * _hb, _rm0 = _ha * _lb, _rm1 = _hb * _la, _rl = _la * _lb;
+
+		const tt_uint64 _t = _rl + (_rm0 << 32);
+		tt_uint64 _carry = _t < _rl;
+
+		const tt_uint64 _lo = _t + (_rm1 << 32);
+		_carry += _lo < _t;
+
+		a = _lo;
+		b = _rh + (_rm0 >> 32) + (_rm1 >> 32) + _carry;
+#endif
+	}
+
+	constexpr tt_uint64 bulk_hash_mix(tt_uint64 a, tt_uint64 b) noexcept {
+
+
+		_tt::bulk_hash_mum(a, b);
+
+		return a ^ b;
+	}
+
+	// NOTE: the bulk hash reads its input via a 'reader', which reads little-endian words at byte offsets
+	//		 of its input, such that inputs other than arrays of bytes (ie. string literals, at compile-time)
+	//		 may also be hashed, producing the same hash codes as their bytes would
+
+	// NOTE: this reads words directly from memory, which presumes a little-endian platform (like all
+	//		 platforms the Tirous Toolbox library targets) and as such hash codes will differ on big-endian ones
+
+	struct bulk_hash_byte_reader final {
+
+		const tt_byte* x;
+
+
+		inline tt_uint64 read8(tt_size i) const noexcept {
+
+
+			tt_uint64 r = 0;
+
+			std::memcpy(&r, x + i, 8);
+
+			return r;
+		}
+
+		inline tt_uint64 read4(tt_size i) const noexcept {
+
+
+			tt_uint32 r = 0;
+
+			std::memcpy(&r, x + i, 4);
+
+			return r;
+		}
+
+		inline tt_uint64 read1(tt_size i) const noexcept { return x[i]; }
+	};
+
+	// NOTE: this reads the little-endian bytes of an array of integral values (ie. the characters of a string
+	//		 literal) one at a time, as memory cannot be reinterpreted at compile-time, and so is far slower than
+	//		 bulk_hash_byte_reader, and is only used when hashing at compile-time
+
+	template<typename Value>
+	struct bulk_hash_array_reader final {
+
+		using unsigned_t = std::make_unsigned_t<Value>;
+
+
+		const Value* x;
+
+
+		constexpr tt_uint64 read8(tt_size i) const noexcept {
+
+
+			tt_uint64 r = 0;
+
+			for (tt_size j = 0; j < 8; j++)
+				r |= read1(i + j) << (8 * j);
+
+			return r;
+		}
+
+		constexpr tt_uint64 read4(tt_size i) const noexcept {
+
+
+			tt_uint64 r = 0;
+
+			for (tt_size j = 0; j < 4; j++)
+				r |= read1(i + j) << (8 * j);
+
+			return r;
+		}
+
+		constexpr tt_uint64 read1(tt_size i) const noexcept { return (tt_uint8)((unsigned_t)x[i / sizeof(Value)] >> (8 * (i % sizeof(Value)))); }
+	};
+
+	// NOTE: returns the seed the bulk hash of seed begins from, which is also what its 48 byte lanes begin from
+
+	constexpr tt_uint64 bulk_hash_start(tt_uint64 seed) noexcept {
+
+
+		return seed ^ _tt::bulk_hash_mix(seed ^ _tt::bulk_hash_secret[0], _tt::bulk_hash_secret[1]);
+	}
+
+	// NOTE: absorbs the 48 bytes at byte offset i into the bulk hash's three lanes
+
+	template<typename Reader>
+	constexpr void bulk_hash_block(const Reader& r, tt_size i, tt_uint64& seed, tt_uint64& see1, tt_uint64& see2) noexcept {
+
+
+		seed = _tt::bulk_hash_mix(r.read8(i) ^ _tt::bulk_hash_secret[1], r.read8(i + 8) ^ seed);
+		see1 = _tt::bulk_hash_mix(r.read8(i + 16) ^ _tt::bulk_hash_secret[2], r.read8(i + 24) ^ see1);
+		see2 = _tt::bulk_hash_mix(r.read8(i + 32) ^ _tt::bulk_hash_secret[3], r.read8(i + 40) ^ see2);
+	}
+
+	// NOTE: finishes the bulk hash of n bytes, once all 48 byte blocks have been absorbed, and seed has had the
+	//		 other lanes folded into it, with the left bytes remaining (at most 48) ending at byte offset end,
+	//		 and with (if n > 16) the 16 bytes preceding end always being readable, even if fewer are left
+
+	template<typename Reader>
+	constexpr tt_uint64 bulk_hash_finish(const Reader& r, tt_size end, tt_size left, tt_size n, tt_uint64 seed) noexcept {
+
+
+		tt_uint64 _a = 0, _b = 0;
+
+		if (n <= 16) {
+
+
+			if (n >= 4)
+				_a = (r.read4(0) << 32) | r.read4((n >> 3) << 2),
+				_b = (r.read4(n - 4) << 32) | r.read4(n - 4 - ((n >> 3) << 2));
+
+			else if (n > 0)
+				_a = (r.read1(0) << 16) | (r.read1(n >> 1) << 8) | r.read1(n - 1);
+		}
+		else {
+
+
+			tt_size i = end - left;
+
+			for (; left > 16; i += 16, left -= 16)
+				seed = _tt::bulk_hash_mix(r.read8(i) ^ _tt::bulk_hash_secret[1], r.read8(i + 8) ^ seed);
+
+			_a = r.read8(end - 16);
+			_b = r.read8(end - 8);
+		}
+
+		_a ^= _tt::bulk_hash_secret[1];
+		_b ^= seed;
+
+		_tt::bulk_hash_mum(_a, _b);
+
+		return _tt::bulk_hash_mix(_a ^ _tt::bulk_hash_secret[0] ^ (tt_uint64)n, _b ^ _tt::bulk_hash_secret[1]);
+	}
+
+	template<typename Reader>
+	constexpr tt_uint64 bulk_hash_of(const Reader& r, tt_size n, tt_uint64 seed) noexcept {
+
+
+		seed = _tt::bulk_hash_start(seed);
+
+		tt_size i = 0;
+
+		if (n >= 48) {
+
+
+			tt_uint64 _see1 = seed, _see2 = seed;
+
+			for (; n - i >= 48; i += 48)
+				_tt::bulk_hash_block(r, i, seed, _see1, _see2);
+
+			seed ^= _see1 ^ _see2;
+		}
+
+		return _tt::bulk_hash_finish(r, n, n - i, n, seed);
+	}
+
+	// NOTE: 32-bit hash codes fold the two halves of the 64-bit hash code together
+
+	constexpr tt_size bulk_hash_fold(tt_uint64 x) noexcept {
+
+
+		if constexpr (tt::config_is_32bit)
+			return (tt_size)(x ^ (x >> 32));
+		else
+			return (tt_size)x;
+	}
+}
+
+namespace tt {
+
+
+	// Returns the 64-bit bulk hash of the n bytes at x, beginning from seed.
+	// If x is nullptr, n must be zero.
+	inline tt_uint64 bulk_hash64(const void* const x, tt_size n, tt_uint64 seed = 0) noexcept {
+
+
+		return _tt::bulk_hash_of(_tt::bulk_hash_byte_reader{ (const tt_byte*)x }, n, seed);
+	}
+
+	// Returns the bulk hash of the n bytes at x, beginning from seed, as a hash code.
+	// If x is nullptr, n must be zero.
+	inline tt_size bulk_hash(const void* const x, tt_size n, tt_uint64 seed = 0) noexcept {
+
+
+		return _tt::bulk_hash_fold(tt::bulk_hash64(x, n, seed));
+	}
+
+	// Returns the bulk hash of the n integral values (ie. characters) at x, beginning from seed, as a hash code.
+	// This is the same as tt::bulk_hash(x, n * sizeof(Value), seed), but may also be computed at compile-time (ie. of string literals.)
+	// If x is nullptr, n must be zero.
+	template<typename Value>
+	constexpr tt_size bulk_hash_array(const Value* const x, tt_size n, tt_uint64 seed = 0) noexcept {
+
+
+		static_assert(std::is_integral_v<Value> && !std::is_same_v<Value, tt_bool>, "tt::bulk_hash_array only hashes arrays of integral values!");
+
+		if (!TT_IS_CONSTANT_EVALUATED())
+			return tt::bulk_hash(x, n * sizeof(Value), seed);
+
+		return _tt::bulk_hash_fold(_tt::bulk_hash_of(_tt::bulk_hash_array_reader<Value>{ x }, n * sizeof(Value), seed));
+	}
+
+	// The Tirous Toolbox library's streaming bulk hasher.
+	// Absorbs bytes in pieces, producing the same hash codes as tt::bulk_hash would of the concatenation of the pieces.
+	// Bulk hashers are copyable, such that a partial hash may be checkpointed, and then continued from, or digested, more than once.
+	class bulk_hasher final {
+	public:
+
+		using this_t = tt::bulk_hasher;
+
+
+		// Initializes a bulk hasher beginning from seed.
+		inline bulk_hasher(tt_uint64 seed = 0) noexcept { reset(seed); }
+
+		bulk_hasher(const this_t&) = default;
+		bulk_hasher(this_t&&) noexcept = default;
+
+		~bulk_hasher() noexcept = default;
+
+		this_t& operator=(const this_t&) = default;
+		this_t& operator=(this_t&&) noexcept = default;
+
+
+		// Returns the number of bytes absorbed by the bulk hasher.
+		inline tt_size bytes() const noexcept { return _n; }
+
+
+		// Absorbs the n bytes at x.
+		// If x is nullptr, n must be zero.
+		inline this_t& update(const void* const x, tt_size n) noexcept;
+
+		// Absorbs the bytes of x, which must be of a type whose values are equal only if their bytes are.
+		template<typename Value>
+		inline this_t& update_value(const Value& x) noexcept {
+
+
+			static_assert(std::has_unique_object_representations_v<Value>, "tt::bulk_hasher::update_value requires values equal only if their bytes are!");
+
+			return update(&x, sizeof(Value));
+		}
+
+		// Returns the 64-bit bulk hash of the bytes absorbed so far.
+		// This does not modify the bulk hasher, which may continue absorbing bytes.
+		inline tt_uint64 digest64() const noexcept;
+
+		// Returns the bulk hash of the bytes absorbed so far, as a hash code.
+		// This does not modify the bulk hasher, which may continue absorbing bytes.
+		inline tt_size digest() const noexcept { return _tt::bulk_hash_fold(digest64()); }
+
+
+		// Resets the bulk hasher, discarding the bytes absorbed, and beginning from seed.
+		inline void reset(tt_uint64 seed = 0) noexcept {
+
+
+			_seed = _see1 = _see2 = _tt::bulk_hash_start(seed);
+			_n = 0;
+			_pending = 0;
+		}
+
+
+	private:
+
+		static constexpr tt_size _HISTORY = 16;
+		static constexpr tt_size _BLOCK = 48;
+
+
+		tt_uint64 _seed, _see1, _see2;
+		tt_size _n, _pending;
+
+		// NOTE: the first _HISTORY bytes of _buf are the bytes preceding the _pending bytes following them,
+		//		 which are the bytes absorbed, but not yet hashed, as a block might yet be the last one
+
+		tt_byte _buf[_HISTORY + _BLOCK];
+
+
+		inline void _hash_buffered_block() noexcept;
+	};
+
+
+	inline tt::bulk_hasher& bulk_hasher::update(const void* const x, tt_size n) noexcept {
+
+
+		auto _x = (const tt_byte*)x;
+
+		_n += n;
+
+		while (n > 0) {
+
+
+			// NOTE: a full buffered block with bytes still to come can't be the last one, and so is hashed
+
+			if (_pending == _BLOCK)
+				_hash_buffered_block();
+
+			// NOTE: with nothing buffered, blocks are hashed directly from x, leaving the last (up to) 48 bytes
+			//		 of x to be buffered, as a block might be the last one
+
+			if (_pending == 0 && n > _BLOCK) {
+
+
+				const tt_size _blocks = (n - 1) / _BLOCK;
+
+				const _tt::bulk_hash_byte_reader _r{ _x };
+
+				TT_FOR(i, _blocks)
+					_tt::bulk_hash_block(_r, i * _BLOCK, _seed, _see1, _see2);
+
+				const tt_size _hashed = _blocks * _BLOCK;
+
+				std::memcpy(_buf, _x + _hashed - _HISTORY, _HISTORY);
+
+				_x += _hashed;
+				n -= _hashed;
+			}
+
+			const tt_size _taken = n < _BLOCK - _pending ? n : _BLOCK - _pending;
+
+			std::memcpy(_buf + _HISTORY + _pending, _x, _taken);
+
+			_pending += _taken;
+			_x += _taken;
+			n -= _taken;
+		}
+
+		TT_RETURN_THIS;
+	}
+
+	inline tt_uint64 bulk_hasher::digest64() const noexcept {
+
+
+		auto _copy = *this;
+
+		// NOTE: a full buffered block is the last one, and so is hashed, with the final step then reading its last 16 bytes
+
+		if (_copy._pending == _BLOCK)
+			_copy._hash_buffered_block();
+
+		// NOTE: if no blocks were hashed, the lanes all still equal the seed, and folding them together changes nothing
+
+		const tt_uint64 _seed = _copy._seed ^ _copy._see1 ^ _copy._see2;
+
+		// NOTE: inputs of at most 16 bytes are read from their start, rather than their end, and are never preceded by a history
+
+		if (_n <= 16)
+			return _tt::bulk_hash_finish(_tt::bulk_hash_byte_reader{ _copy._buf + _HISTORY }, _copy._pending, _copy._pending, _n, _seed);
+
+		return _tt::bulk_hash_finish(_tt::bulk_hash_byte_reader{ _copy._buf }, _HISTORY + _copy._pending, _copy._pending, _n, _seed);
+	}
+
+	inline void bulk_hasher::_hash_buffered_block() noexcept {
+
+
+		_tt::bulk_hash_block(_tt::bulk_hash_byte_reader{ _buf + _HISTORY }, 0, _seed, _see1, _see2);
+
+		std::memcpy(_buf, _buf + _BLOCK, _HISTORY);
+
+		_pending = 0;
+	}
+}
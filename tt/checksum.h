@@ -0,0 +1,415 @@
+
+
+#pragma once
+
+
+// A header file of integrity checksums, for detecting the corruption of data (ie. data persisted via
+// tt::save_file), rather than for hash tables, namely CRC32C (the Castagnoli CRC) and Adler-32.
+
+// Both checksums may be computed incrementally, by passing the checksum of the preceding data, and
+// may be combined, such that the checksums of sections of data processed in parallel may be merged
+// into the checksum of their concatenation, given the lengths of the sections.
+
+
+/*
+
+	CRC32C is computed using the crc32 instruction of SSE4.2 (on x86, detected once at runtime via CPUID) or of the
+	ARMv8 CRC extension (on ARM64, if compiled for it), and otherwise using 'slicing-by-8' lookup tables, which consume
+	8 bytes per iteration.
+
+	CRC32C checksums are combined by multiplying the checksum of the first section by x^(8n) modulo the CRC polynomial,
+	n being the bytes of the second section, in the manner of zlib's crc32_combine, taking O(log(n)) time.
+
+	Defining TT_CONFIG_NO_SIMD disables the hardware CRC32C kernels, leaving only the lookup tables.
+
+*/
+
+
+#include <cstring>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "memory_simd.h"
+#include "chunk.h"
+
+#if defined(_TT_SIMD_NEON) && (defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64))
+#define _TT_CRC32C_ARM 1
+#if !defined(TT_COMPILER_IS_MSVC)
+#include <arm_acle.h>
+#endif
+#endif
+
+// NOTE: SSE4.2 kernels must be compiled for SSE4.2 on GCC/clang, without the rest of the program being so
+
+#if defined(TT_COMPILER_IS_MSVC)
+#define _TT_TARGET_SSE42
+#else
+#define _TT_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+
+
+namespace _tt {
+
+
+	// NOTE: the CRC32C polynomial, bit-reversed, as CRC32C is a reflected CRC
+
+	constexpr tt_uint32 CRC32C_POLY = 0x82f63b78u;
+
+	constexpr tt_uint32 ADLER32_BASE = 65521;
+
+	// NOTE: the most bytes Adler-32 may sum before its sums must be reduced modulo ADLER32_BASE to avoid overflow
+
+	constexpr tt_size ADLER32_NMAX = 5552;
+
+
+	// NOTE: table[k][i] is the CRC of byte i followed by k zero bytes, such that 8 bytes may be looked up at once
+
+	struct crc32c_tables final {
+
+		tt_uint32 table[8][256];
+	};
+
+	constexpr _tt::crc32c_tables make_crc32c_tables() noexcept {
+
+
+		_tt::crc32c_tables r{};
+
+		TT_FOR(i, 256) {
+
+
+			tt_uint32 _crc = (tt_uint32)i;
+
+			TT_FOR(j, 8)
+				_crc = (_crc & 1) ? (_crc >> 1) ^ _tt::CRC32C_POLY : _crc >> 1;
+
+			r.table[0][i] = _crc;
+		}
+
+		for (tt_size k = 1; k < 8; ++k)
+			TT_FOR(i, 256)
+				r.table[k][i] = (r.table[k - 1][i] >> 8) ^ r.table[0][r.table[k - 1][i] & 0xff];
+
+		return r;
+	}
+
+	inline constexpr _tt::crc32c_tables crc32c_tables_v = _tt::make_crc32c_tables();
+
+	// NOTE: these operate upon the CRC register, which is the complement of the checksum
+
+	inline tt_uint32 crc32c_scalar(tt_uint32 crc, const tt_byte* x, tt_size n) noexcept {
+
+
+		const auto& _t = _tt::crc32c_tables_v.table;
+
+		for (; n >= 8; n -= 8, x += 8) {
+
+
+			tt_uint32 _lo = 0, _hi = 0;
+
+			std::memcpy(&_lo, x, 4);
+			std::memcpy(&_hi, x + 4, 4);
+
+			_lo ^= crc;
+
+			crc =
+				_t[7][_lo & 0xff] ^ _t[6][(_lo >> 8) & 0xff] ^ _t[5][(_lo >> 16) & 0xff] ^ _t[4][_lo >> 24] ^
+				_t[3][_hi & 0xff] ^ _t[2][(_hi >> 8) & 0xff] ^ _t[1][(_hi >> 16) & 0xff] ^ _t[0][_hi >> 24];
+		}
+
+		TT_FOR(i, n)
+			crc = _t[0][(crc ^ x[i]) & 0xff] ^ (crc >> 8);
+
+		return crc;
+	}
+
+#if defined(_TT_SIMD_X86)
+
+	_TT_TARGET_SSE42 inline tt_uint32 crc32c_sse42(tt_uint32 crc, const tt_byte* x, tt_size n) noexcept {
+
+
+#if defined(_M_X64) || defined(__x86_64__)
+		tt_uint64 _crc = crc;
+
+		for (; n >= 8; n -= 8, x += 8) {
+
+
+			tt_uint64 _word = 0;
+
+			std::memcpy(&_word, x, 8);
+
+			_crc = _mm_crc32_u64(_crc, _word);
+		}
+
+		crc = (tt_uint32)_crc;
+#else
+		for (; n >= 4; n -= 4, x += 4) {
+
+
+			tt_uint32 _word = 0;
+
+			std::memcpy(&_word, x, 4);
+
+			crc = _mm_crc32_u32(crc, _word);
+		}
+#endif
+
+		TT_FOR(i, n)
+			crc = _mm_crc32_u8(crc, x[i]);
+
+		return crc;
+	}
+
+#elif defined(_TT_CRC32C_ARM)
+
+	inline tt_uint32 crc32c_arm(tt_uint32 crc, const tt_byte* x, tt_size n) noexcept {
+
+
+		for (; n >= 8; n -= 8, x += 8) {
+
+
+			tt_uint64 _word = 0;
+
+			std::memcpy(&_word, x, 8);
+
+			crc = __crc32cd(crc, _word);
+		}
+
+		TT_FOR(i, n)
+			crc = __crc32cb(crc, x[i]);
+
+		return crc;
+	}
+
+#endif
+
+	inline tt_bool detect_crc32c_hardware() noexcept {
+
+
+#if defined(_TT_SIMD_X86)
+		// NOTE: SSE4.2 support is bit 20 of ECX of CPUID leaf 1
+
+#if defined(TT_COMPILER_IS_MSVC)
+		int _regs[4]{};
+
+		__cpuid(_regs, 1);
+
+		return ((tt_uint32)_regs[2] >> 20) & 1;
+#else
+		unsigned _eax = 0, _ebx = 0, _ecx = 0, _edx = 0;
+
+		return __get_cpuid(1, &_eax, &_ebx, &_ecx, &_edx) && ((_ecx >> 20) & 1);
+#endif
+#elif defined(_TT_CRC32C_ARM)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// NOTE: returns the product of polynomials a and b modulo the CRC32C polynomial, with x^0 being the
+	//		 highest bit, as the CRC is reflected
+
+	constexpr tt_uint32 crc32c_multiply(tt_uint32 a, tt_uint32 b) noexcept {
+
+
+		tt_uint32 _m = (tt_uint32)1 << 31, r = 0;
+
+		while (true) {
+
+
+			if (a & _m) {
+
+
+				r ^= b;
+
+				if ((a & (_m - 1)) == 0)
+					break;
+			}
+
+			_m >>= 1;
+
+			b = (b & 1) ? (b >> 1) ^ _tt::CRC32C_POLY : b >> 1;
+		}
+
+		return r;
+	}
+
+	// NOTE: powers[k] is x^(2^k) modulo the CRC32C polynomial, for every k crc32c_shift may need (3 to 66)
+
+	struct crc32c_powers final {
+
+		tt_uint32 powers[67];
+	};
+
+	constexpr _tt::crc32c_powers make_crc32c_powers() noexcept {
+
+
+		_tt::crc32c_powers r{};
+
+		r.powers[0] = (tt_uint32)1 << 30;
+
+		for (tt_size k = 1; k < 67; ++k)
+			r.powers[k] = _tt::crc32c_multiply(r.powers[k - 1], r.powers[k - 1]);
+
+		return r;
+	}
+
+	inline constexpr _tt::crc32c_powers crc32c_powers_v = _tt::make_crc32c_powers();
+
+	// NOTE: returns x^(8n) modulo the CRC32C polynomial, that being what appending n zero bytes multiplies by
+
+	constexpr tt_uint32 crc32c_shift(tt_size n) noexcept {
+
+
+		tt_uint32 r = (tt_uint32)1 << 31;
+
+		for (tt_size k = 3; n > 0; n >>= 1, ++k)
+			if (n & 1)
+				r = _tt::crc32c_multiply(_tt::crc32c_powers_v.powers[k], r);
+
+		return r;
+	}
+}
+
+namespace tt {
+
+
+	// Returns if tt::crc32c computes checksums using hardware CRC instructions, rather than lookup tables.
+	// This is detected once at runtime.
+	inline tt_bool crc32c_is_hardware_accelerated() noexcept {
+
+
+		static const tt_bool _hardware = _tt::detect_crc32c_hardware();
+
+		return _hardware;
+	}
+
+	// Returns the CRC32C checksum of the n bytes at x, continuing from crc, the checksum of any bytes preceding them.
+	// If x is nullptr, n must be zero.
+	inline tt_uint32 crc32c(const void* const x, tt_size n, tt_uint32 crc = 0) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+
+		crc = ~crc;
+
+#if defined(_TT_SIMD_X86)
+		if (tt::crc32c_is_hardware_accelerated())
+			return ~_tt::crc32c_sse42(crc, _x, n);
+#elif defined(_TT_CRC32C_ARM)
+		if (tt::crc32c_is_hardware_accelerated())
+			return ~_tt::crc32c_arm(crc, _x, n);
+#endif
+
+		return ~_tt::crc32c_scalar(crc, _x, n);
+	}
+
+	// Returns the CRC32C checksum of the bytes of x, continuing from crc, the checksum of any bytes preceding them.
+	template<tt_size Alignment>
+	inline tt_uint32 crc32c(tt::chunk_view<Alignment> x, tt_uint32 crc = 0) noexcept {
+
+
+		// NOTE: get_byte_unchecked(0) is invalid for empty views, and the checksum of no bytes is crc itself
+
+		if (x.empty())
+			return crc;
+
+		return tt::crc32c(x.get_byte_unchecked(0), x.size_bytes(), crc);
+	}
+
+	// Returns the CRC32C checksum of the bytes of x, continuing from crc, the checksum of any bytes preceding them.
+	template<tt_size Alignment, typename Allocator>
+	inline tt_uint32 crc32c(const tt::chunk<Alignment, Allocator>& x, tt_uint32 crc = 0) noexcept {
+
+
+		return tt::crc32c(x.view(), crc);
+	}
+
+	// Returns the CRC32C checksum of the concatenation of two sections of data, given the checksum crc_a of the first, and the checksum crc_b of the second, of n_b bytes.
+	constexpr tt_uint32 crc32c_combine(tt_uint32 crc_a, tt_uint32 crc_b, tt_size n_b) noexcept {
+
+
+		return _tt::crc32c_multiply(_tt::crc32c_shift(n_b), crc_a) ^ crc_b;
+	}
+
+	// Returns the Adler-32 checksum of the n bytes at x, continuing from adler, the checksum of any bytes preceding them.
+	// The Adler-32 checksum of no bytes is 1, rather than 0.
+	// If x is nullptr, n must be zero.
+	inline tt_uint32 adler32(const void* const x, tt_size n, tt_uint32 adler = 1) noexcept {
+
+
+		auto _x = (const tt_byte*)x;
+
+		tt_uint32 _a = adler & 0xffff, _b = adler >> 16;
+
+		while (n > 0) {
+
+
+			const tt_size _k = n < _tt::ADLER32_NMAX ? n : _tt::ADLER32_NMAX;
+
+			TT_FOR(i, _k)
+				_a += _x[i],
+				_b += _a;
+
+			_a %= _tt::ADLER32_BASE;
+			_b %= _tt::ADLER32_BASE;
+
+			_x += _k;
+			n -= _k;
+		}
+
+		return _a | (_b << 16);
+	}
+
+	// Returns the Adler-32 checksum of the bytes of x, continuing from adler, the checksum of any bytes preceding them.
+	template<tt_size Alignment>
+	inline tt_uint32 adler32(tt::chunk_view<Alignment> x, tt_uint32 adler = 1) noexcept {
+
+
+		// NOTE: get_byte_unchecked(0) is invalid for empty views, and the checksum of no bytes is adler itself
+
+		if (x.empty())
+			return adler;
+
+		return tt::adler32(x.get_byte_unchecked(0), x.size_bytes(), adler);
+	}
+
+	// Returns the Adler-32 checksum of the bytes of x, continuing from adler, the checksum of any bytes preceding them.
+	template<tt_size Alignment, typename Allocator>
+	inline tt_uint32 adler32(const tt::chunk<Alignment, Allocator>& x, tt_uint32 adler = 1) noexcept {
+
+
+		return tt::adler32(x.view(), adler);
+	}
+
+	// Returns the Adler-32 checksum of the concatenation of two sections of data, given the checksum adler_a of the first, and the checksum adler_b of the second, of n_b bytes.
+	constexpr tt_uint32 adler32_combine(tt_uint32 adler_a, tt_uint32 adler_b, tt_size n_b) noexcept {
+
+
+		constexpr tt_uint32 _base = _tt::ADLER32_BASE;
+
+		const tt_uint32 _rem = (tt_uint32)(n_b % _base);
+
+		tt_uint32 _a = adler_a & 0xffff;
+		tt_uint32 _b = (tt_uint32)(((tt_uint64)_rem * _a) % _base);
+
+		_a += (adler_b & 0xffff) + _base - 1;
+		_b += (adler_a >> 16) + (adler_b >> 16) + _base - _rem;
+
+		if (_a >= _base)
+			_a -= _base;
+
+		if (_a >= _base)
+			_a -= _base;
+
+		if (_b >= _base * 2)
+			_b -= _base * 2;
+
+		if (_b >= _base)
+			_b -= _base;
+
+		return _a | (_b << 16);
+	}
+}
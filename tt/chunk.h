@@ -290,8 +290,7 @@ namespace tt {
 			auto r = std::basic_string<Char>(get<Char>(0), tt::division_instances(size_bytes(), sizeof(Char)));
 
 			if (!tt::is_native_endian(byte_order))
-				for (auto& I : r)
-					I = tt::flip_bytes(I);
+				tt::flip_bytes_n(r.data(), r.size());
 
 			return r;
 		}
@@ -326,12 +325,21 @@ namespace tt {
 		}
 
 		// Returns a hash of the chunk view.
+		// This equals the digest of a tt::bulk_hasher which has absorbed the bytes of the chunk view, whether all at once, or in pieces (see hash_into.)
 		inline tt_size hash() const noexcept {
 
 
 			return tt::array_hash_of(get_byte_unchecked(0), size_bytes());
 		}
 
+		// Absorbs the bytes of the chunk view into bulk hasher h.
+		// Absorbing sections of a chunk view as they're written (ie. via view(ind, n).hash_into(h)) computes the hash of the whole without a second pass over it.
+		inline void hash_into(tt::bulk_hasher& h) const noexcept {
+
+
+			h.update(get_byte_unchecked(0), size_bytes());
+		}
+
 		// Fills the given subsection of the chunk view's memory with the given byte value.
 		// The portion filled starts at unit index ind in the chunk view and continues for the first n units.
 		// If n is zero, the filled portion will continue to the end of the chunk view.
@@ -424,13 +432,33 @@ namespace tt {
 		inline chunk_unit_t* const _al_alloc(tt_size units) {
 
 
-			return allocator_traits_t::allocate(_al, units_to_bytes(units));
+			return allocator_traits_t::allocate(_al, units);
 		}
 
 		inline void _al_free(chunk_unit_t* const x, tt_size units) {
 
 
-			allocator_traits_t::deallocate(_al, x, units_to_bytes(units));
+			allocator_traits_t::deallocate(_al, x, units);
+		}
+
+		// NOTE: chunk units are trivially copyable, and so may be relocated by the allocator, via the
+		//		 optional try_expand/reallocate extension points, returning nullptr if it can't
+
+		inline chunk_unit_t* _al_try_resize(chunk_unit_t* const x, tt_size old_units, tt_size new_units) noexcept {
+
+
+			if constexpr (tt::allocator_has_try_expand_v<allocator_t>) {
+
+
+				if (_al.try_expand(x, old_units, new_units))
+					return x;
+			}
+
+			if constexpr (tt::allocator_has_reallocate_v<allocator_t>)
+				return _al.reallocate(x, old_units, new_units);
+
+			else
+				return nullptr;
 		}
 
 		// general helpers
@@ -515,6 +543,14 @@ namespace tt {
 
 				// if we're not SBO and we're changing to still not be in SBO size range
 
+				// if the allocator can resize the block without copying, let it
+
+				else if (auto _resized = _al_try_resize(_data, _old_capacity, n)) {
+
+
+					_data = _resized;
+				}
+
 				else {
 
 
@@ -523,7 +559,7 @@ namespace tt {
 					// nothing beyond here can throw, thus strong guarantee
 
 					if (preserve_data)
-						tt::copy_block(_data, _new_data, _old_capacity);
+						tt::copy_block_streaming(_data, _new_data, tt::min(_old_capacity, n));
 
 					_al_free(_data, _old_capacity);
 
@@ -1039,7 +1075,7 @@ namespace tt {
 
 			auto r = this_t(n);
 
-			tt::copy_block(data() + ind, r.data(), n);
+			tt::copy_block_streaming(data() + ind, r.data(), n);
 
 			return r;
 		}
@@ -1086,12 +1122,21 @@ namespace tt {
 		}
 
 		// Returns a hash of the chunk.
+		// This equals the digest of a tt::bulk_hasher which has absorbed the bytes of the chunk, whether all at once, or in pieces (see hash_into.)
 		inline tt_size hash() const noexcept {
 
 
 			return tt::array_hash_of(get_byte_unchecked(0), size_bytes());
 		}
 
+		// Absorbs the bytes of the chunk into bulk hasher h.
+		// Absorbing sections of a chunk as they're written (ie. via view(ind, n).hash_into(h)) computes the hash of the whole without a second pass over it.
+		inline void hash_into(tt::bulk_hasher& h) const noexcept {
+
+
+			h.update(get_byte_unchecked(0), size_bytes());
+		}
+
 		// Resizes the chunk, changing its size to n units, adding or removing uninitialized memory to or from the end of the chunk as needed.
 		// The values of any uninitialized memory added to the chunk will be arbitrary.
 		// Unless otherwise specified, indices and sizes in chunks are measured in alignment-sized 'units' of bytes.
@@ -1208,7 +1253,7 @@ namespace tt {
 			//if (n >= size())
 				//TT_RETURN_THIS;
 
-			tt::copy_block_overlap(data() + ind, data() + ind + n, size() - (ind + n));
+			tt::copy_block_overlap_streaming(data() + ind, data() + ind + n, size() - (ind + n));
 
 			TT_RETURN_THIS;
 		}
@@ -0,0 +1,631 @@
+
+
+#pragma once
+
+
+// A thread-safe version of tt::memoized_pool, which stripes its entries across a number of independently
+// locked 'shards', such that threads aquiring resources of different keys rarely contend with one another.
+
+
+/*
+
+	Concurrent pools are defined by the same Key, Resource, Builder and Map generic parameters as tt::memoized_pool,
+	and behave identically to them, except for the following:
+
+		- Entries are distributed across shards by the hash of their keys, with each shard being guarded by its own
+		  std::shared_mutex, such that lookups of resources which have already been built only take a shared lock.
+
+		- If multiple threads aquire the same missing resource at once, only one of them will invoke the builder
+		  to build it, with the others waiting on that build, and then sharing its result. If the build throws, the
+		  waiting threads will rethrow the same exception, and the resource will remain missing.
+
+		- As resources of different keys may be built concurrently, the get_resource method of Builder types must
+		  be thread-safe, as must the get_key method.
+
+		- Concurrent pools cannot be copied, and moving them is not thread-safe, with pools waiting for their
+		  asynchronous builds (see below) before being moved.
+
+	Resources may also be built asynchronously upon a tt::thread_pool, via aquire_async and prefetch, with these
+	builds being deduplicated against any other builds of the same key, whether synchronous or asynchronous, and
+	their resources being published to the pool once built, as with aquire.
+
+	The thread-pool must outlive any asynchronous builds dispatched upon it, and as the key of an asynchronous build
+	is copied, if it's a memory-view object, the memory it views must also outlive the build. The pool itself waits
+	for its asynchronous builds to be performed (or discarded) upon being destroyed, which may also be done via
+	wait_idle, such that it's safe to destroy a pool with builds still in flight.
+
+	If the thread-pool discards an asynchronous build before it's performed (ie. upon shutting down) then threads
+	waiting on that build will have an std::future_error thrown, and the resource will remain missing.
+
+*/
+
+
+#include <array>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "memoized_pool.h"
+#include "flat_hash_map.h"
+#include "thread_pool.h"
+
+
+namespace _tt {
+
+
+	// NOTE: this encapsulates a resource being built, which threads other than the one building it may wait upon
+
+	template<typename Resource>
+	struct concurrent_memoized_pool_build final {
+
+		std::promise<std::shared_ptr<const Resource>>		promise;
+		std::shared_future<std::shared_ptr<const Resource>>	future;
+
+
+		inline concurrent_memoized_pool_build()
+			: promise(),
+			future(promise.get_future().share()) {}
+	};
+
+	// NOTE: shards are cache line aligned so that threads locking neighbouring shards don't falsely share
+
+	// NOTE: builds are keyed using the hasher and key_equal of Map, such that keys needn't be hashable via std::hash
+
+	template<typename Key, typename Resource, typename Map>
+	struct alignas(64) concurrent_memoized_pool_shard final {
+
+		using builds_t = std::unordered_map<Key, std::shared_ptr<_tt::concurrent_memoized_pool_build<Resource>>, typename Map::hasher, typename Map::key_equal>;
+
+		mutable std::shared_mutex	mtx;
+		Map							resources;
+		builds_t					builds;
+	};
+}
+
+namespace tt {
+
+
+	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>, typename Map = std::unordered_map<Key, std::shared_ptr<const Resource>>>
+	class concurrent_memoized_pool final {
+	public:
+
+		using key_t				= typename Key;
+		using resource_t		= typename Resource;
+		using builder_t			= typename Builder;
+		using map_t				= typename Map;
+
+		using this_t			= concurrent_memoized_pool<key_t, resource_t, builder_t, map_t>;
+
+		using future_t			= std::shared_future<std::shared_ptr<const resource_t>>;
+
+		// The default number of shards of a pool.
+		static constexpr tt_size DEFAULT_SHARDS = 16;
+
+
+		// Initializes a pool of the given number of shards (rounded up to a power of two) with a default-constructed builder.
+		inline explicit concurrent_memoized_pool(tt_size shards = DEFAULT_SHARDS)
+			: concurrent_memoized_pool(builder_t(), shards) {}
+
+		// Initializes a pool of the given number of shards (rounded up to a power of two) with builder.
+		inline concurrent_memoized_pool(builder_t&& builder, tt_size shards = DEFAULT_SHARDS);
+
+		concurrent_memoized_pool(const this_t&) = delete;
+
+		// NOTE: asynchronous builds refer to the pool which dispatched them, and so pools wait for them before being moved
+
+		inline concurrent_memoized_pool(this_t&& x) noexcept
+			: _builder((x.wait_idle(), TT_FMOVE(builder_t, x._builder))),
+			_shards(std::move(x._shards)),
+			_shard_mask(x._shard_mask),
+			_inflight(std::move(x._inflight)) {}
+
+		inline ~concurrent_memoized_pool() noexcept { wait_idle(); }
+
+		this_t& operator=(const this_t&) = delete;
+
+		inline this_t& operator=(this_t&& rhs) noexcept;
+
+
+		// Returns a copy of the builder used by the pool.
+		inline builder_t get_builder() const noexcept { return _builder; }
+
+		// Returns the number of shards of the pool.
+		inline tt_size shards() const noexcept { return _shard_mask + 1; }
+
+
+		// Returns the number of memoized resources in the pool.
+		// As other threads may be modifying the pool, this is only a snapshot.
+		inline tt_size resources() const;
+
+		// Returns if the pool has no memoized resources.
+		// As other threads may be modifying the pool, this is only a snapshot.
+		inline tt_bool empty() const { return resources() == 0; }
+
+
+		// Returns a pointer to the memoized resource associated with key in the pool, if available, or returning nullptr if it's not yet available.
+		// The pointer returned is invalidated if the resource is discarded, which may happen on another thread, so prefer fetch_ptr.
+		inline const resource_t* fetch(const key_t& key) const { return fetch_ptr(key).get(); }
+
+		// Returns a pointer to the memoized resource associated with key in the pool, if available, or returning nullptr if it's not yet available.
+		// This returns a shared pointer of the underlying memory object itself.
+		inline std::shared_ptr<const resource_t> fetch_ptr(const key_t& key) const;
+
+		// Returns if the pool contains a memoized resource associated with key yet.
+		inline tt_bool contains(const key_t& key) const { return (tt_bool)fetch_ptr(key); }
+
+
+		// Instructs the memoized resource pool to aquire the resource associated with key, instantiated it if it's not yet available.
+		// If the resource is already being built by another thread, this waits for that build to complete, rather than building it again.
+		// If the builder is instructed to build a new resource, it may throw exceptions, and is expected to provide a basic guarantee of exception safety.
+		// The lvalue returned is invalidated if the resource is discarded, which may happen on another thread, so prefer aquire_ptr.
+		inline const resource_t& aquire(const key_t& key);
+
+		inline const resource_t& operator[](const key_t& key) { return aquire(key); }
+
+		// Instructs the memoized resource pool to aquire the resource associated with key, instantiated it if it's not yet available.
+		// If the resource is already being built by another thread, this waits for that build to complete, rather than building it again.
+		// If the builder is instructed to build a new resource, it may throw exceptions, and is expected to provide a basic guarantee of exception safety.
+		// This returns a shared pointer of the underlying memory object itself.
+		inline std::shared_ptr<const resource_t> aquire_ptr(const key_t& key);
+
+		// Instructs the memoized resource pool to aquire the resource associated with key, building it upon thread-pool tp if it's not yet available.
+		// Returns a shared future of the resource, which is ready immediately if the resource is already available.
+		// If the resource is already being built, this returns a future of that build, rather than building it again.
+		// If the builder throws, the exception is rethrown by the future, rather than by this method.
+		inline future_t aquire_async(const key_t& key, tt::thread_pool& tp);
+
+		// Instructs the memoized resource pool to aquire the resources associated with keys, building those not yet available upon thread-pool tp.
+		// Returns the shared futures of the resources, in the order of keys, which may be waited upon, or simply discarded.
+		// If the builder throws, the exception is rethrown by the future of that resource, which simply remains missing.
+		template<typename... Keys>
+		inline std::array<future_t, sizeof...(Keys)> prefetch(tt::thread_pool& tp, const Keys&... keys);
+
+		// Blocks until every asynchronous build dispatched by the pool has been performed, or discarded by its thread-pool.
+		// This is called by the pool's destructor, and must not be called from a task of a thread-pool with builds of the pool still queued behind it.
+		inline void wait_idle() const noexcept;
+
+
+		// Instructs the memoized resource pool to insert resource into the pool, using the pool's builder to get a key for it, discarding any current entry in the pool.
+		inline void insert(resource_t resource);
+
+		// Instructs the memoized resource pool to insert resource into the pool, using the pool's builder to get a key for it, discarding any current entry in the pool.
+		// This version inserts a resource already wrapped in a shared pointer.
+		// Fails quietly if resource is nullptr.
+		inline void insert(std::shared_ptr<resource_t> resource);
+
+
+		// Instructs the memoized resource pool to discard any memoized data associated with key.
+		// Fails quietly if there is no data to discard.
+		// Resources being built when this is called are not discarded.
+		inline void discard(const key_t& key);
+
+		// Discards all memoized resources of the pool.
+		// Resources being built when this is called are not discarded.
+		inline void reset();
+
+
+	private:
+
+		using _shard_t			= _tt::concurrent_memoized_pool_shard<key_t, resource_t, map_t>;
+		using _build_t			= _tt::concurrent_memoized_pool_build<resource_t>;
+
+		// NOTE: this counts the asynchronous builds of the pool which are in flight, such that the pool may
+		//		 wait for them before being destroyed, as they refer to it
+
+		struct _inflight_t final {
+
+			mutable std::mutex					mtx;
+			mutable std::condition_variable		cv;
+			tt_size								count		= 0;
+		};
+
+
+		builder_t					_builder;
+		std::unique_ptr<_shard_t[]>	_shards;
+		tt_size						_shard_mask;
+		std::unique_ptr<_inflight_t>	_inflight;
+
+
+		// NOTE: this encapsulates an asynchronous build dispatched to a thread-pool, which is shared by the
+		//		 copies of the task's function, and which abandons the build if destroyed without being performed
+
+		struct _async_build_t final {
+
+			this_t*						pool;
+			key_t						key;
+			std::shared_ptr<_build_t>	build;
+			tt_bool						performed;
+
+
+			inline _async_build_t(this_t* pool, const key_t& key, std::shared_ptr<_build_t> build)
+				: pool(pool),
+				key(key),
+				build(std::move(build)),
+				performed(false) {
+
+
+				std::scoped_lock lk(pool->_inflight->mtx);
+
+				++(pool->_inflight->count);
+			}
+
+			_async_build_t(const _async_build_t&) = delete;
+
+			// NOTE: the pool may be destroyed as soon as its in flight count reaches zero, and so this must
+			//		 be the last use of the pool, with the count being notified while still locked
+
+			inline ~_async_build_t() noexcept {
+
+
+				if (!performed)
+					pool->_abandon(key, *build);
+
+				std::scoped_lock lk(pool->_inflight->mtx);
+
+				--(pool->_inflight->count);
+
+				pool->_inflight->cv.notify_all();
+			}
+
+			_async_build_t& operator=(const _async_build_t&) = delete;
+
+			inline void perform() noexcept {
+
+
+				performed = true;
+
+				try {
+
+
+					(void)pool->_perform(key, *build);
+				}
+				catch (...) {}
+			}
+		};
+
+
+		// NOTE: the high bits of the mixed hash select the shard, so as to not correlate with the
+		//		 low bits of the hash, which hash maps like tt::flat_hash_map use to select buckets
+
+		inline _shard_t& _shard_of(const key_t& key) const noexcept {
+
+
+			const tt_size _hash = _tt::flat_mix(typename map_t::hasher()(key));
+
+			return _shards[(_hash >> (sizeof(tt_size) * 8 - 16)) & _shard_mask];
+		}
+
+		// NOTE: this returns the future of the resource, or of the build of it, if either exist, or otherwise
+		//		 registers a new build, returning it via build, which the caller is then responsible for performing
+
+		inline future_t _find_or_register(const key_t& key, std::shared_ptr<_build_t>& build);
+
+		inline std::shared_ptr<const resource_t> _perform(const key_t& key, _build_t& build);
+		inline void _abandon(const key_t& key, _build_t& build) noexcept;
+
+		inline void _insert(std::shared_ptr<const resource_t> resource);
+	};
+
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline concurrent_memoized_pool<Key, Resource, Builder, Map>::concurrent_memoized_pool(builder_t&& builder, tt_size shards)
+		: _builder(TT_FMOVE(builder_t, builder)) {
+
+
+		tt_size _n = 1;
+
+		while (_n < shards && _n < ((tt_size)1 << 16))
+			_n *= 2;
+
+		_shards = std::make_unique<_shard_t[]>(_n);
+		_shard_mask = _n - 1;
+		_inflight = std::make_unique<_inflight_t>();
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline typename concurrent_memoized_pool<Key, Resource, Builder, Map>::this_t& concurrent_memoized_pool<Key, Resource, Builder, Map>::operator=(this_t&& rhs) noexcept {
+
+
+		TT_SELF_MOVE_TEST(rhs);
+
+		wait_idle();
+		rhs.wait_idle();
+
+		TT_MOVE(_builder, rhs);
+		TT_MOVE(_shards, rhs);
+		TT_COPY(_shard_mask, rhs);
+		TT_MOVE(_inflight, rhs);
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline tt_size concurrent_memoized_pool<Key, Resource, Builder, Map>::resources() const {
+
+
+		tt_size r = 0;
+
+		TT_FOR(i, shards()) {
+
+
+			std::shared_lock lk(_shards[i].mtx);
+
+			r += _shards[i].resources.size();
+		}
+
+		return r;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline std::shared_ptr<const typename concurrent_memoized_pool<Key, Resource, Builder, Map>::resource_t> concurrent_memoized_pool<Key, Resource, Builder, Map>::fetch_ptr(const key_t& key) const {
+
+
+		auto& _shard = _shard_of(key);
+
+		std::shared_lock lk(_shard.mtx);
+
+		const auto ff = _shard.resources.find(key);
+
+		if (ff != _shard.resources.end())
+			return ff->second;
+		else
+			return nullptr;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline const typename concurrent_memoized_pool<Key, Resource, Builder, Map>::resource_t& concurrent_memoized_pool<Key, Resource, Builder, Map>::aquire(const key_t& key) {
+
+
+		const auto _aquired = aquire_ptr(key);
+
+		tt_assert(_aquired);
+
+		const auto& r = *_aquired;
+
+		return r;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline std::shared_ptr<const typename concurrent_memoized_pool<Key, Resource, Builder, Map>::resource_t> concurrent_memoized_pool<Key, Resource, Builder, Map>::aquire_ptr(const key_t& key) {
+
+
+		auto& _shard = _shard_of(key);
+
+		// NOTE: the fast path, which only takes a shared lock, and so doesn't block other readers
+
+		{
+			std::shared_lock lk(_shard.mtx);
+
+			const auto ff = _shard.resources.find(key);
+
+			if (ff != _shard.resources.end())
+				return ff->second;
+		}
+
+		// NOTE: the slow path, which either finds that another thread is building the resource, and waits
+		//		 on it, or registers a build of its own, with the resource being rechecked in case it was
+		//		 published in between the two locks
+
+		std::shared_ptr<_build_t> _build = nullptr;
+
+		const auto _future = _find_or_register(key, _build);
+
+		if (!_build)
+			return _future.get(); // <- rethrows if the build failed
+
+		return _perform(key, *_build);
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline typename concurrent_memoized_pool<Key, Resource, Builder, Map>::future_t concurrent_memoized_pool<Key, Resource, Builder, Map>::aquire_async(const key_t& key, tt::thread_pool& tp) {
+
+
+		std::shared_ptr<_build_t> _build = nullptr;
+
+		const auto _future = _find_or_register(key, _build);
+
+		if (!_build)
+			return _future;
+
+		// NOTE: if creating or dispatching the task throws, the build is abandoned by the destructor of
+		//		 the asynchronous build object, such that it isn't left registered forever
+
+		auto _async = std::make_shared<_async_build_t>(this, key, std::move(_build));
+
+		tp.dispatch<void()>([_async]() { _async->perform(); });
+
+		return _future;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	template<typename... Keys>
+	inline std::array<typename concurrent_memoized_pool<Key, Resource, Builder, Map>::future_t, sizeof...(Keys)> concurrent_memoized_pool<Key, Resource, Builder, Map>::prefetch(tt::thread_pool& tp, const Keys&... keys) {
+
+
+		return { aquire_async(keys, tp)... };
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::wait_idle() const noexcept {
+
+
+		// NOTE: moved-from pools have no in flight count, nor any builds
+
+		if (!_inflight)
+			return;
+
+		std::unique_lock lk(_inflight->mtx);
+
+		_inflight->cv.wait(lk, [this]() { return _inflight->count == 0; });
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline typename concurrent_memoized_pool<Key, Resource, Builder, Map>::future_t concurrent_memoized_pool<Key, Resource, Builder, Map>::_find_or_register(const key_t& key, std::shared_ptr<_build_t>& build) {
+
+
+		auto& _shard = _shard_of(key);
+
+		std::unique_lock lk(_shard.mtx);
+
+		const auto ff = _shard.resources.find(key);
+
+		if (ff != _shard.resources.end()) {
+
+
+			std::promise<std::shared_ptr<const resource_t>> _ready;
+
+			_ready.set_value(ff->second);
+
+			return _ready.get_future().share();
+		}
+
+		const auto bb = _shard.builds.find(key);
+
+		if (bb != _shard.builds.end())
+			return bb->second->future;
+
+		// NOTE: the key of the build entry is the caller's key, which for synchronous builds is valid as it
+		//		 lives until aquire_ptr returns, which is only after the build entry has been removed, and for
+		//		 asynchronous builds is valid as it's a copy owned by the task, which outlives the build
+
+		build = std::make_shared<_build_t>();
+
+		_shard.builds[key] = build;
+
+		return build->future;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline std::shared_ptr<const typename concurrent_memoized_pool<Key, Resource, Builder, Map>::resource_t> concurrent_memoized_pool<Key, Resource, Builder, Map>::_perform(const key_t& key, _build_t& build) {
+
+
+		auto& _shard = _shard_of(key);
+
+		try {
+
+
+			// NOTE: as with tt::memoized_pool, the builder is expected to provide a basic guarantee
+
+			auto res = _builder.get_resource(key);
+
+			std::shared_ptr<const resource_t> _shared = std::make_shared<const resource_t>(std::move(res));
+
+			tt_assert(_shared);
+
+			{
+				std::unique_lock lk(_shard.mtx);
+
+				// NOTE: as with tt::memoized_pool, the entry's key is gotten from the resource, so its lifetime
+				//		 matches or exceeds the resource's
+
+				_shard.resources[_builder.get_key(*_shared)] = _shared;
+
+				_shard.builds.erase(key);
+			}
+
+			build.promise.set_value(_shared);
+
+			return _shared;
+		}
+		catch (...) {
+
+
+			{
+				std::unique_lock lk(_shard.mtx);
+
+				_shard.builds.erase(key);
+			}
+
+			build.promise.set_exception(std::current_exception());
+
+			throw;
+		}
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::_abandon(const key_t& key, _build_t& build) noexcept {
+
+
+		auto& _shard = _shard_of(key);
+
+		{
+			std::unique_lock lk(_shard.mtx);
+
+			_shard.builds.erase(key);
+		}
+
+		build.promise.set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::insert(resource_t resource) {
+
+
+		_insert(std::make_shared<const resource_t>(std::move(resource)));
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::insert(std::shared_ptr<resource_t> resource) {
+
+
+		if (!resource)
+			return;
+
+		_insert(std::move(resource));
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::discard(const key_t& key) {
+
+
+		auto& _shard = _shard_of(key);
+
+		std::unique_lock lk(_shard.mtx);
+
+		_shard.resources.erase(key);
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::reset() {
+
+
+		TT_FOR(i, shards()) {
+
+
+			std::unique_lock lk(_shards[i].mtx);
+
+			_shards[i].resources.clear();
+		}
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map>
+	inline void concurrent_memoized_pool<Key, Resource, Builder, Map>::_insert(std::shared_ptr<const resource_t> resource) {
+
+
+		tt_assert(resource);
+
+		const auto _key = _builder.get_key(*resource);
+
+		auto& _shard = _shard_of(_key);
+
+		std::unique_lock lk(_shard.mtx);
+
+		// NOTE: the old entry is erased first, as its key may be a memory-view object of the old resource
+
+		_shard.resources.erase(_key);
+
+		_shard.resources[_key] = std::move(resource);
+	}
+
+
+	// A concurrent memoized pool which stores its entries in tt::flat_hash_map objects, rather than std::unordered_map objects.
+	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	using flat_concurrent_memoized_pool = tt::concurrent_memoized_pool<Key, Resource, Builder, tt::flat_hash_map<Key, std::shared_ptr<const Resource>, Hash, KeyEqual>>;
+}
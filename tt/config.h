@@ -34,6 +34,13 @@
 //
 // This logging is NOT thread-safe.
 
+// TT_CONFIG_SIZE_CLASS_ALLOC asserts that tt::alloc_uninit and tt::aligned_alloc_uninit (and their
+// corresponding deallocation functions) should use the thread-caching size-class allocator of
+// size_class_allocation.h, rather than wrapping the system allocator directly.
+
+// TT_CONFIG_NO_SIMD asserts that the SIMD kernels of memory_simd.h should not be used, leaving only
+// their scalar fallbacks.
+
 // TT_CONFIG_NO_IMPLY asserts that the above regarding implying the definition of things like
 // the TT_CONFIG_RELEASE configuration option should not occur.
 
@@ -10,6 +10,9 @@
 
 
 #include "aliases.h"
+#include "macros.h"
+
+#include "memory_util.h"
 
 
 namespace tt {
@@ -140,5 +143,66 @@ namespace tt {
 
 		write_to(from, to, tt::endian::LITTLE, bytes_written);
 	}
-}
 
+
+	// Reads n values from the bytes at 'from' into array 'to', interpreting them as being in the byte order provided.
+	// Values are converted in bulk, using SIMD kernels where possible, and so T must be trivially copyable.
+	// The arrays must not overlap.
+	// If bytes_read is not nullptr, it will be set to the amount of bytes read by the operation.
+	template<typename T, typename P>
+	inline void read_n(const P* const from, T* const to, tt_size n, tt::endian byte_order = tt::endian::NATIVE, tt_size* bytes_read = nullptr) noexcept {
+
+
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		if (is_native_endian(byte_order))
+			tt::copy_block_unchecked((const T*)from, to, n);
+
+		else
+			tt::flip_bytes_copy_n((const T*)from, to, n);
+
+		if (bytes_read)
+			*bytes_read = n * sizeof(T);
+	}
+
+	// Reads n values from the bytes at 'from' into array 'to', interpreting them as being in big endian byte order.
+	// If bytes_read is not nullptr, it will be set to the amount of bytes read by the operation.
+	template<typename T, typename P>
+	inline void read_n_be(const P* const from, T* const to, tt_size n, tt_size* bytes_read = nullptr) noexcept { read_n(from, to, n, tt::endian::BIG, bytes_read); }
+
+	// Reads n values from the bytes at 'from' into array 'to', interpreting them as being in little endian byte order.
+	// If bytes_read is not nullptr, it will be set to the amount of bytes read by the operation.
+	template<typename T, typename P>
+	inline void read_n_le(const P* const from, T* const to, tt_size n, tt_size* bytes_read = nullptr) noexcept { read_n(from, to, n, tt::endian::LITTLE, bytes_read); }
+
+
+	// Writes the n values of array 'from' into the bytes at 'to', in the byte order provided.
+	// Values are converted in bulk, using SIMD kernels where possible, and so T must be trivially copyable.
+	// The arrays must not overlap.
+	// If bytes_written is not nullptr, it will be set to the amount of bytes written by the operation.
+	template<typename T, typename P>
+	inline void write_n(const T* const from, P* const to, tt_size n, tt::endian byte_order = tt::endian::NATIVE, tt_size* bytes_written = nullptr) noexcept {
+
+
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		if (is_native_endian(byte_order))
+			tt::copy_block_unchecked(from, (T*)to, n);
+
+		else
+			tt::flip_bytes_copy_n(from, (T*)to, n);
+
+		if (bytes_written)
+			*bytes_written = n * sizeof(T);
+	}
+
+	// Writes the n values of array 'from' into the bytes at 'to', in big endian byte order.
+	// If bytes_written is not nullptr, it will be set to the amount of bytes written by the operation.
+	template<typename T, typename P>
+	inline void write_n_be(const T* const from, P* const to, tt_size n, tt_size* bytes_written = nullptr) noexcept { write_n(from, to, n, tt::endian::BIG, bytes_written); }
+
+	// Writes the n values of array 'from' into the bytes at 'to', in little endian byte order.
+	// If bytes_written is not nullptr, it will be set to the amount of bytes written by the operation.
+	template<typename T, typename P>
+	inline void write_n_le(const T* const from, P* const to, tt_size n, tt_size* bytes_written = nullptr) noexcept { write_n(from, to, n, tt::endian::LITTLE, bytes_written); }
+}
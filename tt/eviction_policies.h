@@ -0,0 +1,721 @@
+
+
+#pragma once
+
+
+// The eviction policies used by tt::memoized_pool to decide which resources to discard when it's full.
+
+
+/*
+
+	An eviction policy tracks the keys of the entries of a pool, and is informed of each entry's insertion,
+	access, and removal, from which it decides which entry to evict when the pool exceeds its capacity.
+
+	In specific, an eviction policy of keys of type Key is expected to provide methods equivalent to these:
+
+			void on_insert(const Key&)
+
+			void on_access(const Key&)
+
+			void on_erase(const Key&)
+
+			Key evict()
+
+			void clear() noexcept
+
+	The on_insert method is called after an entry of the key is inserted, the on_access method is called
+	when an entry of the key is aquired, and the on_erase method is called before an entry of the key is
+	removed by anything other than eviction.
+
+	The evict method chooses an entry to evict, stops tracking it, and returns its key. It's only called
+	while the policy is tracking at least one key.
+
+	Keys are tracked via copies of the keys held by the pool's entries, and so, like those, memory-view
+	keys remain valid so long as their entries do.
+
+	The provided policies take Hash and KeyEqual parameters, defaulting to std::hash and std::equal_to,
+	which should match those of the pool's map, as tt::bounded_memoized_pool's default policy does, such
+	that keys needn't be hashable via std::hash. Tracked keys are indexed by a tt::flat_hash_map, so as
+	to not allocate per entry, unless they aren't nothrow move-constructible.
+
+	Eviction policies must also define a static constexpr tt_bool ENABLED, which is false only for
+	tt::no_eviction, which tracks nothing, and thus allows the pool to skip this bookkeeping entirely.
+
+*/
+
+
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <type_traits>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "numeric_limits.h"
+#include "math_util.h"
+#include "flat_hash_map.h"
+
+
+namespace _tt {
+
+
+	constexpr tt_size EVICTION_NIL = tt::max_of<tt_size>;
+
+
+	// NOTE: tt::flat_hash_map requires nothrow move-constructible keys, so other keys fall back to std::unordered_map
+
+	template<typename Key, typename Hash, typename KeyEqual>
+	using eviction_index_t =
+		std::conditional_t<
+		std::is_nothrow_move_constructible_v<Key>,
+		tt::flat_hash_map<Key, tt_size, Hash, KeyEqual>,
+		std::unordered_map<Key, tt_size, Hash, KeyEqual>>;
+
+
+	// NOTE: this is a pool of index-linked nodes, each holding a key, and each belonging to one of a number of
+	//		 doubly-linked lists, with indices being used rather than pointers such that the whole thing can be
+	//		 trivially copied (as pools, and thus their policies, are copyable)
+
+	template<typename Key, typename Hash, typename KeyEqual>
+	class eviction_lists final {
+	public:
+
+		using key_t = typename Key;
+
+		struct list final {
+
+			tt_size head = _tt::EVICTION_NIL;
+			tt_size tail = _tt::EVICTION_NIL;
+			tt_size size = 0;
+		};
+
+
+		inline tt_size size() const noexcept { return _index.size(); }
+
+		inline tt_size find(const key_t& key) const {
+
+
+			const auto ff = _index.find(key);
+
+			return ff != _index.end() ? ff->second : _tt::EVICTION_NIL;
+		}
+
+		inline const key_t& key(tt_size x) const noexcept { return *_nodes[x].key; }
+
+		inline tt_uint8 tag(tt_size x) const noexcept { return _nodes[x].tag; }
+
+		// NOTE: adds a node of key to the front of l, returning its index
+
+		inline tt_size insert(const key_t& key, list& l, tt_uint8 tag) {
+
+
+			tt_size r = _tt::EVICTION_NIL;
+
+			if (!_free.empty())
+				r = _free.back(),
+				_free.pop_back();
+			else
+				r = _nodes.size(),
+				_nodes.emplace_back();
+
+			_nodes[r].key.emplace(key);
+
+			try {
+
+
+				_index[key] = r;
+			}
+			catch (...) {
+
+
+				_nodes[r].key.reset();
+				_free.push_back(r);
+
+				throw;
+			}
+
+			_link_front(r, l, tag);
+
+			return r;
+		}
+
+		// NOTE: moves node x from list from to the front of list to (which may be the same list)
+
+		inline void move_to_front(tt_size x, list& from, list& to, tt_uint8 tag) noexcept {
+
+
+			_unlink(x, from);
+			_link_front(x, to, tag);
+		}
+
+		// NOTE: removes node x from l, returning its key
+
+		inline key_t remove(tt_size x, list& l) {
+
+
+			_unlink(x, l);
+
+			key_t r = std::move(*_nodes[x].key);
+
+			_index.erase(r);
+
+			_nodes[x].key.reset();
+
+			_free.push_back(x);
+
+			return r;
+		}
+
+		inline void clear() noexcept {
+
+
+			_nodes.clear();
+			_free.clear();
+			_index.clear();
+		}
+
+
+	private:
+
+		struct _node final {
+
+			std::optional<key_t> key;
+			tt_size prev = _tt::EVICTION_NIL;
+			tt_size next = _tt::EVICTION_NIL;
+			tt_uint8 tag = 0;
+		};
+
+		std::vector<_node> _nodes;
+		std::vector<tt_size> _free;
+		_tt::eviction_index_t<key_t, Hash, KeyEqual> _index;
+
+
+		inline void _link_front(tt_size x, list& l, tt_uint8 tag) noexcept {
+
+
+			_nodes[x].tag = tag;
+			_nodes[x].prev = _tt::EVICTION_NIL;
+			_nodes[x].next = l.head;
+
+			if (l.head != _tt::EVICTION_NIL)
+				_nodes[l.head].prev = x;
+			else
+				l.tail = x;
+
+			l.head = x;
+
+			++l.size;
+		}
+
+		inline void _unlink(tt_size x, list& l) noexcept {
+
+
+			if (_nodes[x].prev != _tt::EVICTION_NIL)
+				_nodes[_nodes[x].prev].next = _nodes[x].next;
+			else
+				l.head = _nodes[x].next;
+
+			if (_nodes[x].next != _tt::EVICTION_NIL)
+				_nodes[_nodes[x].next].prev = _nodes[x].prev;
+			else
+				l.tail = _nodes[x].prev;
+
+			--l.size;
+		}
+	};
+
+
+	// NOTE: this is a count-min sketch of 4-bit saturating counters (stored one per byte, for simplicity), used
+	//		 to estimate how often keys have been seen, with all counters being halved periodically, such that
+	//		 the estimates favour recent history
+
+	template<typename Key, typename Hash>
+	class frequency_sketch final {
+	public:
+
+		using key_t = typename Key;
+
+		static constexpr tt_size ROWS = 4;
+		static constexpr tt_uint8 MAX_COUNT = 15;
+
+
+		inline tt_size width() const noexcept { return _width; }
+
+		// NOTE: grows the sketch to suit n tracked keys, discarding its counts if it grows
+
+		inline void ensure_capacity(tt_size n) {
+
+
+			tt_size _new_width = _width > 0 ? _width : 16;
+
+			while (_new_width < n * 2 && _new_width < ((tt_size)1 << 24))
+				_new_width *= 2;
+
+			if (_new_width == _width)
+				return;
+
+			_counters.assign(_new_width * ROWS, 0);
+			_width = _new_width;
+			_samples = 0;
+		}
+
+		inline void increment(const key_t& key) {
+
+
+			if (_width == 0)
+				ensure_capacity(1);
+
+			const tt_size _hash = _hasher(key);
+
+			TT_FOR(i, ROWS) {
+
+
+				tt_uint8& _counter = _counters[i * _width + _slot(_hash, i)];
+
+				if (_counter < MAX_COUNT)
+					++_counter;
+			}
+
+			if (++_samples >= _width * 10)
+				_age();
+		}
+
+		inline tt_uint8 estimate(const key_t& key) const {
+
+
+			if (_width == 0)
+				return 0;
+
+			const tt_size _hash = _hasher(key);
+
+			tt_uint8 r = MAX_COUNT;
+
+			TT_FOR(i, ROWS) {
+
+
+				const tt_uint8 _counter = _counters[i * _width + _slot(_hash, i)];
+
+				r = _counter < r ? _counter : r;
+			}
+
+			return r;
+		}
+
+		inline void clear() noexcept {
+
+
+			_counters.clear();
+			_width = 0;
+			_samples = 0;
+		}
+
+
+	private:
+
+		std::vector<tt_uint8> _counters;
+		Hash _hasher;
+		tt_size _width = 0;
+		tt_size _samples = 0;
+
+
+		inline tt_size _slot(tt_size hash, tt_size row) const noexcept {
+
+
+			return _tt::flat_mix(hash + row * (tt_size)0x9e3779b97f4a7c15ULL) & (_width - 1);
+		}
+
+		inline void _age() noexcept {
+
+
+			TT_FOR_RANGE(i, _counters)
+				i /= 2;
+
+			_samples /= 2;
+		}
+	};
+}
+
+namespace tt {
+
+
+	// An eviction policy which tracks nothing, and never evicts.
+	// Pools using this policy are unbounded, and pay no bookkeeping costs.
+	template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	struct no_eviction final {
+
+		using key_t = typename Key;
+
+		static constexpr tt_bool ENABLED = false;
+
+
+		inline void on_insert(const key_t&) noexcept {}
+		inline void on_access(const key_t&) noexcept {}
+		inline void on_erase(const key_t&) noexcept {}
+		inline key_t evict() { tt_assert(false); return key_t(); }
+		inline void clear() noexcept {}
+	};
+
+
+	// A least-recently-used eviction policy, which evicts the entry which was inserted or aquired the longest ago.
+	template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class lru_eviction final {
+	public:
+
+		using key_t = typename Key;
+
+		static constexpr tt_bool ENABLED = true;
+
+
+		inline void on_insert(const key_t& key) { _lists.insert(key, _list, 0); }
+
+		inline void on_access(const key_t& key) {
+
+
+			const tt_size _node = _lists.find(key);
+
+			if (_node != _tt::EVICTION_NIL)
+				_lists.move_to_front(_node, _list, _list, 0);
+		}
+
+		inline void on_erase(const key_t& key) {
+
+
+			const tt_size _node = _lists.find(key);
+
+			if (_node != _tt::EVICTION_NIL)
+				_lists.remove(_node, _list);
+		}
+
+		inline key_t evict() {
+
+
+			tt_assert(_list.tail != _tt::EVICTION_NIL);
+
+			return _lists.remove(_list.tail, _list);
+		}
+
+		inline void clear() noexcept {
+
+
+			_lists.clear();
+			_list = {};
+		}
+
+
+	private:
+
+		_tt::eviction_lists<key_t, Hash, KeyEqual> _lists;
+		typename _tt::eviction_lists<key_t, Hash, KeyEqual>::list _list;
+	};
+
+
+	// A CLOCK eviction policy, which approximates least-recently-used eviction using a single 'referenced' bit per entry.
+	// Entries are arranged in a ring, which a 'hand' sweeps across, clearing referenced bits, and evicting the first entry it finds without one.
+	// Unlike tt::lru_eviction, accesses only set a bit, rather than relinking a list.
+	template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class clock_eviction final {
+	public:
+
+		using key_t = typename Key;
+
+		static constexpr tt_bool ENABLED = true;
+
+
+		inline void on_insert(const key_t& key) {
+
+
+			tt_size _slot = _tt::EVICTION_NIL;
+
+			if (!_free.empty())
+				_slot = _free.back(),
+				_free.pop_back();
+			else
+				_slot = _ring.size(),
+				_ring.emplace_back();
+
+			_ring[_slot].key.emplace(key);
+			_ring[_slot].referenced = false;
+
+			try {
+
+
+				_index[key] = _slot;
+			}
+			catch (...) {
+
+
+				_ring[_slot].key.reset();
+				_free.push_back(_slot);
+
+				throw;
+			}
+		}
+
+		inline void on_access(const key_t& key) {
+
+
+			const auto ff = _index.find(key);
+
+			if (ff != _index.end())
+				_ring[ff->second].referenced = true;
+		}
+
+		inline void on_erase(const key_t& key) {
+
+
+			const auto ff = _index.find(key);
+
+			if (ff == _index.end())
+				return;
+
+			const tt_size _slot = ff->second;
+
+			_index.erase(ff);
+
+			_ring[_slot].key.reset();
+
+			_free.push_back(_slot);
+		}
+
+		inline key_t evict() {
+
+
+			tt_assert(_index.size() > 0);
+
+			while (true) {
+
+
+				if (_hand >= _ring.size())
+					_hand = 0;
+
+				auto& _entry = _ring[_hand++];
+
+				if (!_entry.key)
+					continue;
+
+				if (_entry.referenced) {
+
+
+					_entry.referenced = false;
+
+					continue;
+				}
+
+				key_t r = std::move(*_entry.key);
+
+				_index.erase(r);
+
+				_entry.key.reset();
+
+				_free.push_back(_hand - 1);
+
+				return r;
+			}
+		}
+
+		inline void clear() noexcept {
+
+
+			_ring.clear();
+			_free.clear();
+			_index.clear();
+			_hand = 0;
+		}
+
+
+	private:
+
+		struct _entry_t final {
+
+			std::optional<key_t> key;
+			tt_bool referenced = false;
+		};
+
+		std::vector<_entry_t> _ring;
+		std::vector<tt_size> _free;
+		_tt::eviction_index_t<key_t, Hash, KeyEqual> _index;
+		tt_size _hand = 0;
+	};
+
+
+	// A W-TinyLFU eviction policy, which combines recency and frequency information to decide what to evict.
+	// New entries enter a small LRU 'window', and upon leaving it, must be seen more often than the entry the main region would evict in order to be admitted to it.
+	// Entry frequencies are estimated using a count-min sketch, which is periodically aged.
+	// The main region is a segmented LRU, where entries aquired while on 'probation' are promoted to a 'protected' segment.
+	// This is resistant to scans, which would flush an LRU of its frequently used entries.
+	template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class tinylfu_eviction final {
+	public:
+
+		using key_t = typename Key;
+
+		static constexpr tt_bool ENABLED = true;
+
+		// The percentage of entries given to the window.
+		static constexpr tt_size WINDOW_PERCENT = 1;
+
+		// The percentage of the main region's entries given to the protected segment.
+		static constexpr tt_size PROTECTED_PERCENT = 80;
+
+
+		inline void on_insert(const key_t& key) {
+
+
+			_sketch.ensure_capacity(_lists.size() + 1);
+			_sketch.increment(key);
+
+			_lists.insert(key, _window, _WINDOW);
+
+			// NOTE: while the pool is below capacity, entries overflowing the window move straight to the
+			//		 main region on probation, as there is nothing yet for them to compete with
+
+			while (_window.size > _window_target())
+				_lists.move_to_front(_window.tail, _window, _probation, _PROBATION);
+		}
+
+		inline void on_access(const key_t& key) {
+
+
+			_sketch.increment(key);
+
+			const tt_size _node = _lists.find(key);
+
+			if (_node == _tt::EVICTION_NIL)
+				return;
+
+			switch (_lists.tag(_node)) {
+
+			case _WINDOW:
+				_lists.move_to_front(_node, _window, _window, _WINDOW);
+				break;
+
+			case _PROBATION:
+				_lists.move_to_front(_node, _probation, _protected, _PROTECTED);
+				_demote_protected();
+				break;
+
+			case _PROTECTED:
+				_lists.move_to_front(_node, _protected, _protected, _PROTECTED);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		inline void on_erase(const key_t& key) {
+
+
+			const tt_size _node = _lists.find(key);
+
+			if (_node != _tt::EVICTION_NIL)
+				_lists.remove(_node, _list_of(_lists.tag(_node)));
+		}
+
+		inline key_t evict() {
+
+
+			tt_assert(_lists.size() > 0);
+
+			// NOTE: pools evict before inserting, so the window is treated as full once it reaches its target, as
+			//		 the entry about to be inserted will join it
+
+			while (_window.size > 0 && _window.size >= _window_target()) {
+
+
+				// NOTE: the window's oldest entry is a candidate for the main region, competing with
+				//		 the entry the main region would evict, with the less frequently seen of the
+				//		 two being evicted
+
+				const tt_size _candidate = _window.tail;
+				const tt_size _victim = _main_victim();
+
+				if (_victim == _tt::EVICTION_NIL) {
+
+
+					_lists.move_to_front(_candidate, _window, _probation, _PROBATION);
+
+					continue;
+				}
+
+				if (_sketch.estimate(_lists.key(_candidate)) > _sketch.estimate(_lists.key(_victim))) {
+
+
+					_lists.move_to_front(_candidate, _window, _probation, _PROBATION);
+
+					return _lists.remove(_victim, _list_of(_lists.tag(_victim)));
+				}
+
+				return _lists.remove(_candidate, _window);
+			}
+
+			const tt_size _victim = _main_victim();
+
+			if (_victim != _tt::EVICTION_NIL)
+				return _lists.remove(_victim, _list_of(_lists.tag(_victim)));
+
+			return _lists.remove(_window.tail, _window);
+		}
+
+		inline void clear() noexcept {
+
+
+			_lists.clear();
+			_sketch.clear();
+			_window = {};
+			_probation = {};
+			_protected = {};
+		}
+
+
+	private:
+
+		using _list_t = typename _tt::eviction_lists<key_t, Hash, KeyEqual>::list;
+
+		static constexpr tt_uint8 _WINDOW = 0;
+		static constexpr tt_uint8 _PROBATION = 1;
+		static constexpr tt_uint8 _PROTECTED = 2;
+
+		_tt::eviction_lists<key_t, Hash, KeyEqual> _lists;
+		_tt::frequency_sketch<key_t, Hash> _sketch;
+		_list_t _window, _probation, _protected;
+
+
+		inline _list_t& _list_of(tt_uint8 tag) noexcept {
+
+
+			return
+				tag == _WINDOW
+				? _window
+				: tag == _PROBATION
+				? _probation
+				: _protected;
+		}
+
+		inline tt_size _window_target() const noexcept {
+
+
+			return tt::max<tt_size>(1, _lists.size() * WINDOW_PERCENT / 100);
+		}
+
+		inline tt_size _main_victim() const noexcept {
+
+
+			return _probation.tail != _tt::EVICTION_NIL ? _probation.tail : _protected.tail;
+		}
+
+		// NOTE: if the protected segment has outgrown its share of the main region, its oldest entry is put back on probation
+
+		inline void _demote_protected() noexcept {
+
+
+			const tt_size _main = _probation.size + _protected.size;
+
+			if (_protected.size > 1 && _protected.size * 100 > _main * PROTECTED_PERCENT)
+				_lists.move_to_front(_protected.tail, _protected, _probation, _PROBATION);
+		}
+	};
+}
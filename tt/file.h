@@ -9,9 +9,15 @@
 #include "aliases.h"
 
 #include "chunk.h"
+#include "thread_pool.h"
 
 #include <fstream>
 #include <filesystem>
+#include <vector>
+#include <queue>
+#include <set>
+#include <mutex>
+#include <condition_variable>
 
 
 namespace tt {
@@ -102,6 +108,40 @@ namespace tt {
 		tt_filepath path = {};
 	};
 
+	// The default number of bytes tt::hash_file reads at once.
+	constexpr tt_size hash_file_default_block_bytes = 64ULL * 1024ULL;
+
+	// Absorbs the contents of the file at f into bulk hasher h, reading it in blocks of block_bytes bytes, rather than all at once.
+	// Returns if the file was read successfully, with h having absorbed whatever was read prior to any failure.
+	inline tt_bool hash_file(const tt_filepath& f, tt::bulk_hasher& h, tt_size block_bytes = tt::hash_file_default_block_bytes) {
+
+
+		tt_assert(block_bytes > 0);
+
+		std::ifstream s{};
+
+		s.open(f, std::ios_base::in | std::ios_base::binary);
+
+		if (!s.is_open())
+			return false;
+
+		tt::chunk<1> _block{};
+
+		_block.resize(block_bytes);
+
+		while (s) {
+
+
+			s.read(_block.get<tt_char>(0), _block.size_bytes());
+
+			h.update(_block.get_byte_unchecked(0), (tt_size)s.gcount());
+		}
+
+		// NOTE: reading stops upon failing to read a whole block, which is only a success if it's due to reaching the end of the file
+
+		return s.eof() && !s.bad();
+	}
+
 	// Saves the contents of x to the file at f, creating a new file, or overwriting an existing one in the process.
 	// If append is true, the contents of f will be appended instead of overwritten.
 	inline tt::saved_file_info save_file(tt::chunk_view<1> x, tt_filepath f, tt_bool append = false) {
@@ -152,5 +192,567 @@ namespace tt {
 
 		return tt::save_file(tt::chunk_view<1>(x, n), f, append);
 	}
+
+	TT_EXCEPTION_STRUCT(walk_directory_incomplete_error);
+
+	// A struct describing which files are to be gathered by tt::walk_directory.
+	struct walk_directory_filter final {
+
+		// The file extensions (including the '.', ie. ".png") of files to be gathered.
+		// If empty, files of any extension will be gathered.
+		// Extensions are compared exactly, and are thus case-sensitive.
+		std::vector<tt_filepath> extensions = {};
+
+		// The minimum size, in bytes, of files to be gathered.
+		tt_size min_size = 0;
+
+		// The maximum size, in bytes, of files to be gathered.
+		tt_size max_size = tt::max_size;
+
+		// If symlinks to directories should be followed.
+		// Directories reached more than once (ie. via symlink cycles) are only walked the first time.
+		tt_bool follow_symlinks = false;
+	};
+}
+
+namespace _tt {
+
+
+	// NOTE: this encapsulates the shared state of a single tt::walk_directory call
+
+	struct walk_directory_state final {
+
+		std::mutex								mtx			= {};
+		std::condition_variable					cv			= {};
+		tt_size									outstanding	= 0;
+		tt_bool									incomplete	= false;
+		std::vector<tt_filepath>				results		= {};
+		std::set<tt_filepath>					visited		= {};
+		tt::walk_directory_filter				filter		= {};
+		tt::thread_pool*						pool		= nullptr;
+	};
+
+	inline tt_bool walk_directory_accepts(const tt::walk_directory_filter& filter, const tt::fs::directory_entry& entry) {
+
+
+		if (!filter.extensions.empty()) {
+
+
+			const auto _ext = entry.path().extension();
+
+			tt_bool _found = false;
+
+			for (const auto& I : filter.extensions)
+				if (_ext == I) {
+
+
+					_found = true;
+
+					break;
+				}
+
+			if (!_found)
+				return false;
+		}
+
+		// NOTE: only stat the file if the size filter actually needs it
+
+		if (filter.min_size > 0 || filter.max_size < tt::max_size) {
+
+
+			std::error_code ec{};
+
+			const auto _size = (tt_size)entry.file_size(ec);
+
+			if (ec || _size < filter.min_size || _size > filter.max_size)
+				return false;
+		}
+
+		return true;
+	}
+
+	inline void walk_directory_task(const std::shared_ptr<walk_directory_state>& state, const tt_filepath& dir);
+
+	// NOTE: this encapsulates the walk of a single directory dispatched to a thread-pool, which is shared by the
+	//		 copies of the task's function, and which, if destroyed without being performed (ie. as the thread-pool
+	//		 was shutdown, discarding it, or as dispatching it failed), marks the walk as incomplete
+
+	struct walk_directory_job final {
+
+		std::shared_ptr<walk_directory_state>	state;
+		tt_filepath								dir;
+		tt_bool									performed;
+
+
+		inline walk_directory_job(std::shared_ptr<walk_directory_state> state, tt_filepath dir)
+			: state(std::move(state)),
+			dir(std::move(dir)),
+			performed(false) {
+
+
+			std::scoped_lock lk(this->state->mtx);
+
+			++(this->state->outstanding);
+		}
+
+		walk_directory_job(const walk_directory_job&) = delete;
+
+		inline ~walk_directory_job() noexcept {
+
+
+			if (!performed)
+				_finish(false);
+		}
+
+		walk_directory_job& operator=(const walk_directory_job&) = delete;
+
+		inline void perform() noexcept {
+
+
+			performed = true;
+
+			walk_directory_task(state, dir);
+
+			_finish(true);
+		}
+
+
+	private:
+
+		inline void _finish(tt_bool walked) noexcept {
+
+
+			{
+				std::scoped_lock lk(state->mtx);
+
+				if (!walked)
+					state->incomplete = true;
+
+				--(state->outstanding);
+			}
+
+			state->cv.notify_all();
+		}
+	};
+
+	// NOTE: this never throws, with any failure to dispatch the walk of dir instead marking the walk as incomplete
+
+	inline void walk_directory_dispatch(const std::shared_ptr<walk_directory_state>& state, tt_filepath dir) noexcept {
+
+
+		tt_assert(state);
+
+		try {
+
+
+			// NOTE: when following symlinks, directories are identified by their canonical paths, such that
+			//		 symlink cycles cannot make the walk revisit a directory (and thus never end)
+
+			tt_filepath _canonical{};
+
+			if (state->filter.follow_symlinks) {
+
+
+				std::error_code ec{};
+
+				_canonical = tt::fs::canonical(dir, ec);
+
+				if (ec)
+					_canonical = dir;
+			}
+
+			{
+				std::scoped_lock lk(state->mtx);
+
+				// NOTE: once the walk is incomplete it's going to fail anyway, so dispatch nothing further,
+				//		 which also avoids dispatching to a thread-pool which has since been shutdown
+
+				if (state->incomplete)
+					return;
+
+				if (state->filter.follow_symlinks && !state->visited.insert(std::move(_canonical)).second)
+					return;
+			}
+
+			// NOTE: the job counts itself as outstanding BEFORE dispatch, so the count can never reach zero
+			//		 while a subdirectory is still queued, and uncounts itself however it's destroyed
+
+			auto _job = std::make_shared<walk_directory_job>(state, std::move(dir));
+
+			state->pool->dispatch<void()>([_job]() { _job->perform(); });
+		}
+
+		catch (...) {
+
+
+			{
+				std::scoped_lock lk(state->mtx);
+
+				state->incomplete = true;
+			}
+
+			state->cv.notify_all();
+		}
+	}
+
+	inline void walk_directory_task(const std::shared_ptr<walk_directory_state>& state, const tt_filepath& dir) {
+
+
+		std::vector<tt_filepath> _found{};
+
+		// NOTE: catch everything here, as an exception escaping the task would skip the rest of the
+		//		 directory, which is reported by marking the walk as incomplete
+
+		try {
+
+
+			std::error_code ec{};
+
+			const auto _options = 
+				state->filter.follow_symlinks 
+				? tt::fs::directory_options::skip_permission_denied | tt::fs::directory_options::follow_directory_symlink 
+				: tt::fs::directory_options::skip_permission_denied;
+
+			for (tt::fs::directory_iterator it(dir, _options, ec), e{}; !ec && it != e; it.increment(ec)) {
+
+
+				const auto& _entry = *it;
+
+				std::error_code _ec{};
+
+				if (_entry.is_directory(_ec)) {
+
+
+					if (state->filter.follow_symlinks || !_entry.is_symlink(_ec))
+						walk_directory_dispatch(state, _entry.path());
+				}
+
+				else if (_entry.is_regular_file(_ec) && walk_directory_accepts(state->filter, _entry))
+					_found.push_back(_entry.path());
+			}
+
+			std::scoped_lock lk(state->mtx);
+
+			state->results.insert(state->results.end(), std::make_move_iterator(_found.begin()), std::make_move_iterator(_found.end()));
+		}
+
+		catch (...) {
+
+
+			std::scoped_lock lk(state->mtx);
+
+			state->incomplete = true;
+		}
+	}
+}
+
+namespace tt {
+
+
+	// Walks the directory tree at root, returning the paths of all regular files within it which pass filter.
+	// Each directory visited is listed as its own task on pool, such that the tree is traversed in parallel.
+	// The order of the returned paths is unspecified.
+	// Directories which cannot be read are skipped quietly.
+	// Throws tt::walk_directory_incomplete_error if any directory could not be walked as its task could not be dispatched, or was discarded (ie. by pool being shutdown.)
+	// This blocks until the traversal completes, and so must not be called from one of pool's own worker-threads.
+	inline std::vector<tt_filepath> walk_directory(const tt_filepath& root, tt::thread_pool& pool, const tt::walk_directory_filter& filter = {}) {
+
+
+		auto _state = std::make_shared<_tt::walk_directory_state>();
+
+		_state->filter = filter;
+		_state->pool = &pool;
+
+		_tt::walk_directory_dispatch(_state, root);
+
+		std::unique_lock lk(_state->mtx);
+
+		_state->cv.wait(lk, [&]() { return _state->outstanding == 0; });
+
+		if (_state->incomplete)
+			TT_THROW(tt::walk_directory_incomplete_error, "directory walk could not be completed!");
+
+		return std::move(_state->results);
+	}
+}
+
+namespace _tt {
+
+
+	// NOTE: this encapsulates the shared state of a single tt::load_files call
+
+	struct load_files_result final {
+
+		tt::loaded_file_info	info;
+		tt_size					cost;
+		tt_size					index;
+	};
+
+	// NOTE: jobs measure their files themselves, as they begin loading, such that the calling thread needn't
+	//		 stat every file serially before any are loaded, with unmeasured counting the jobs dispatched but
+	//		 yet to measure their files, which the calling thread limits, such that in_flight stays bounded
+
+	struct load_files_state final {
+
+		std::mutex								mtx			= {};
+		std::condition_variable					cv			= {};
+		tt_size									in_flight	= 0;
+		tt_size									unmeasured	= 0;
+		tt_size									lost		= 0;
+		std::queue<load_files_result>			completed	= {};
+
+
+		inline void measured(tt_size cost) noexcept {
+
+
+			{
+				std::scoped_lock lk(mtx);
+
+				--unmeasured;
+
+				in_flight += cost;
+			}
+
+			cv.notify_all();
+		}
+
+		// NOTE: if the result cannot be queued (ie. std::bad_alloc) it's counted as lost, rather than
+		//		 being waited upon forever, with its cost being returned to the budget
+
+		inline void complete(load_files_result&& x) noexcept {
+
+
+			{
+				std::scoped_lock lk(mtx);
+
+				try {
+
+
+					completed.push(std::move(x));
+				}
+
+				catch (...) {
+
+
+					in_flight -= x.cost;
+
+					++lost;
+				}
+			}
+
+			cv.notify_all();
+		}
+	};
+
+	// NOTE: this encapsulates the load of a single file dispatched to a thread-pool, which is shared by the
+	//		 copies of the task's function, and which, if destroyed without being performed (ie. as the
+	//		 thread-pool was shutdown, discarding it), reports the file as having failed to load
+
+	struct load_files_job final {
+
+		std::shared_ptr<load_files_state>	state;
+		tt_filepath							path;
+		tt_size								index;
+		tt_bool								performed;
+
+
+		inline load_files_job(std::shared_ptr<load_files_state> state, tt_filepath path, tt_size index)
+			: state(std::move(state)),
+			path(std::move(path)),
+			index(index),
+			performed(false) {
+
+
+			std::scoped_lock lk(this->state->mtx);
+
+			++(this->state->unmeasured);
+		}
+
+		load_files_job(const load_files_job&) = delete;
+
+		inline ~load_files_job() noexcept {
+
+
+			if (!performed) {
+
+
+				state->measured(0);
+
+				_fail(0);
+			}
+		}
+
+		load_files_job& operator=(const load_files_job&) = delete;
+
+		inline void perform() noexcept {
+
+
+			performed = true;
+
+			std::error_code ec{};
+
+			const auto _size = (tt_size)tt::fs::file_size(path, ec);
+
+			const auto _cost = ec ? 0 : _size;
+
+			state->measured(_cost);
+
+			// NOTE: tt::load_file can throw std::bad_alloc, which we report as a failed load,
+			//		 as otherwise the file's cost would never be returned to the budget
+
+			try {
+
+
+				state->complete({ tt::load_file(path), _cost, index });
+			}
+
+			catch (...) {
+
+
+				_fail(_cost);
+			}
+		}
+
+
+	private:
+
+		inline void _fail(tt_size cost) noexcept {
+
+
+			load_files_result _result{};
+
+			_result.cost = cost;
+			_result.index = index;
+
+			try {
+
+
+				_result.info.path = path;
+			}
+
+			catch (...) {}
+
+			state->complete(std::move(_result));
+		}
+	};
+
+	// NOTE: this is tt::load_files, but passing each result's index in files to f alongside it
+
+	template<typename F>
+	inline void load_files_indexed(const std::vector<tt_filepath>& files, tt::thread_pool& pool, F&& f, tt_size max_bytes_in_flight) {
+
+
+		auto _state = std::make_shared<_tt::load_files_state>();
+
+		// NOTE: at most this many jobs may be dispatched without yet having measured their files
+
+		const tt_size _max_unmeasured = tt::max<tt_size>(1, pool.get_worker_threads() * 2);
+
+		tt_size _dispatched = 0, _received = 0;
+
+		std::unique_lock lk(_state->mtx);
+
+		auto _drain = [&]() {
+
+
+			while (!_state->completed.empty()) {
+
+
+				auto _result = std::move(_state->completed.front());
+
+				_state->completed.pop();
+
+				// NOTE: unlock while invoking f so worker-threads can continue to push results
+
+				lk.unlock();
+
+				f(_result.index, std::move(_result.info));
+
+				lk.lock();
+
+				_state->in_flight -= _result.cost;
+
+				++_received;
+			}
+		};
+
+		auto _done = [&]() { return _received + _state->lost == _dispatched; };
+
+		TT_FOR(i, files.size()) {
+
+
+			while (true) {
+
+
+				_drain();
+
+				if (_done() || (_state->in_flight < max_bytes_in_flight && _state->unmeasured < _max_unmeasured))
+					break;
+
+				_state->cv.wait(lk);
+			}
+
+			++_dispatched;
+
+			lk.unlock();
+
+			// NOTE: if dispatch fails, the job reports the file as having failed to load as it's destroyed,
+			//		 and the exception propagates to the caller
+
+			auto _job = std::make_shared<_tt::load_files_job>(_state, files[i], i);
+
+			pool.dispatch<void()>([_job]() { _job->perform(); });
+
+			lk.lock();
+		}
+
+		while (!_done()) {
+
+
+			_state->cv.wait(lk, [&]() { return !_state->completed.empty() || _done(); });
+
+			_drain();
+		}
+	}
 }
 
+namespace tt {
+
+
+	// The default number of bytes of file data which tt::load_files allows to be in flight at once.
+	constexpr tt_size load_files_default_bytes_in_flight = 256ULL * 1024ULL * 1024ULL;
+
+	// Loads the contents of each file in files concurrently, reading them via tasks dispatched to pool.
+	// As each file finishes loading, its tt::loaded_file_info is passed to f, which is always invoked on the calling thread, and never concurrently.
+	// The order in which f receives results is unspecified.
+	// Files whose tasks are discarded (ie. by pool being shutdown) are passed to f as having failed to load.
+	// Files are only dispatched while fewer than max_bytes_in_flight bytes of file data are loaded, or loading, but not yet passed to f.
+	// As files are measured by their tasks, as they begin loading, up to twice pool's worker-thread count of files may begin loading beyond this limit.
+	// This blocks until all files have been passed to f, and so must not be called from one of pool's own worker-threads.
+	template<typename F, typename = std::enable_if_t<std::is_invocable_v<F, tt::loaded_file_info&&>>>
+	inline void load_files(const std::vector<tt_filepath>& files, tt::thread_pool& pool, F&& f, tt_size max_bytes_in_flight = tt::load_files_default_bytes_in_flight) {
+
+
+		_tt::load_files_indexed(files, pool, [&](tt_size, tt::loaded_file_info&& x) { f(std::move(x)); }, max_bytes_in_flight);
+	}
+
+	// Loads the contents of each file in files concurrently, reading them via tasks dispatched to pool.
+	// The returned results are in the same order as files.
+	// Unlike the callback version of tt::load_files, every result is retained, and so max_bytes_in_flight only bounds how far reading may run ahead of the calling thread.
+	// This blocks until all files have been loaded, and so must not be called from one of pool's own worker-threads.
+	inline std::vector<tt::loaded_file_info> load_files(const std::vector<tt_filepath>& files, tt::thread_pool& pool, tt_size max_bytes_in_flight = tt::load_files_default_bytes_in_flight) {
+
+
+		std::vector<tt::loaded_file_info> r(files.size());
+
+		_tt::load_files_indexed(files, pool, [&](tt_size i, tt::loaded_file_info&& x) { r[i] = std::move(x); }, max_bytes_in_flight);
+
+		// NOTE: results lost to std::bad_alloc are left as failed loads, so give them their paths
+
+		TT_FOR(i, files.size())
+			if (!r[i].success && r[i].path.empty())
+				r[i].path = files[i];
+
+		return r;
+	}
+}
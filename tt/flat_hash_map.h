@@ -0,0 +1,1155 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's open-addressing 'flat' hash map implementation.
+
+// Unlike std::unordered_map, which allocates a node for each entry, a flat hash map stores its entries
+// directly in a single array of 'slots', alongside a parallel array of one byte 'control bytes', in the
+// style of Google's SwissTable.
+
+// Each control byte records if its slot is empty, deleted (a 'tombstone'), or full, and if full, holds
+// 7 bits of the hash of the slot's key. Lookups probe the control bytes a 'group' at a time, comparing
+// these 7 bit hashes across the whole group at once (via SSE2 where available), such that keys are only
+// ever compared for slots which almost certainly hold them, and usually only one cache line of slots
+// is ever touched.
+
+
+#include <new>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "exceptions.h"
+#include "forward_declarations.h"
+
+#include "numeric_limits.h"
+#include "allocation.h"
+#include "memory_util.h"
+#include "placement_construction.h"
+#include "endian.h"
+#include "memory_simd.h"
+
+
+namespace _tt {
+
+
+	// NOTE: a control byte is either EMPTY, DELETED, SENTINEL (which follows the last slot, so iteration knows
+	//		 where to stop), or 'full', in which case it holds the 7 bit 'H2' hash of its slot's key, and thus is
+	//		 never negative
+
+	using flat_ctrl_t = tt_int8;
+
+	constexpr _tt::flat_ctrl_t FLAT_EMPTY = -128;
+	constexpr _tt::flat_ctrl_t FLAT_DELETED = -2;
+	constexpr _tt::flat_ctrl_t FLAT_SENTINEL = -1;
+
+	constexpr tt_bool flat_is_full(_tt::flat_ctrl_t x) noexcept { return x >= 0; }
+	constexpr tt_bool flat_is_empty_or_deleted(_tt::flat_ctrl_t x) noexcept { return x < _tt::FLAT_SENTINEL; }
+
+
+	// NOTE: group 'masks' have a bit set for each control byte of the group which matched, with the index
+	//		 of a matched control byte being the index of its bit, shifted right by FLAT_MASK_SHIFT
+
+#if defined(_TT_SIMD_X86)
+
+	constexpr tt_size FLAT_GROUP_WIDTH = 16;
+	constexpr tt_size FLAT_MASK_SHIFT = 0;
+
+	using flat_mask_t = tt_uint32;
+
+	struct flat_group final {
+
+		__m128i ctrl;
+
+
+		inline explicit flat_group(const _tt::flat_ctrl_t* x) noexcept
+			: ctrl(_mm_loadu_si128((const __m128i*)x)) {}
+
+		inline _tt::flat_mask_t match(_tt::flat_ctrl_t h2) const noexcept {
+
+
+			return (_tt::flat_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+		}
+
+		inline _tt::flat_mask_t match_empty() const noexcept {
+
+
+			return (_tt::flat_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(_tt::FLAT_EMPTY), ctrl));
+		}
+
+		inline _tt::flat_mask_t match_empty_or_deleted() const noexcept {
+
+
+			return (_tt::flat_mask_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(_tt::FLAT_SENTINEL), ctrl));
+		}
+	};
+
+#else
+
+	// NOTE: this portable group matches 8 control bytes at once, by treating them as a single 64-bit word,
+	//		 with each matching byte having its high bit set in the resulting mask
+
+	// NOTE: match may report false positives for bytes directly above a true match, which is fine, as
+	//		 matches are always confirmed by comparing keys
+
+	constexpr tt_size FLAT_GROUP_WIDTH = 8;
+	constexpr tt_size FLAT_MASK_SHIFT = 3;
+
+	using flat_mask_t = tt_uint64;
+
+	struct flat_group final {
+
+		static constexpr tt_uint64 LSBS = 0x0101010101010101ULL;
+		static constexpr tt_uint64 MSBS = 0x8080808080808080ULL;
+
+		tt_uint64 ctrl;
+
+
+		inline explicit flat_group(const _tt::flat_ctrl_t* x) noexcept {
+
+
+			std::memcpy(&ctrl, x, sizeof(ctrl));
+
+			if (!tt::is_native_endian(tt::endian::LITTLE))
+				ctrl = _tt::byteswap<8>(ctrl);
+		}
+
+		inline _tt::flat_mask_t match(_tt::flat_ctrl_t h2) const noexcept {
+
+
+			const tt_uint64 x = ctrl ^ (LSBS * (tt_uint8)h2);
+
+			return (x - LSBS) & ~x & MSBS;
+		}
+
+		inline _tt::flat_mask_t match_empty() const noexcept {
+
+
+			return (ctrl & (~ctrl << 6)) & MSBS;
+		}
+
+		inline _tt::flat_mask_t match_empty_or_deleted() const noexcept {
+
+
+			return (ctrl & (~ctrl << 7)) & MSBS;
+		}
+	};
+
+#endif
+
+	// Returns the index of the lowest matched control byte of non-zero mask x.
+	inline tt_size flat_mask_lowest(_tt::flat_mask_t x) noexcept {
+
+
+		if constexpr (sizeof(_tt::flat_mask_t) == 8)
+			return _tt::simd_ctz64(x) >> _tt::FLAT_MASK_SHIFT;
+		else
+			return _tt::simd_ctz((tt_uint32)x) >> _tt::FLAT_MASK_SHIFT;
+	}
+
+	// Returns the number of unmatched control bytes at the start of the group of mask x.
+	inline tt_size flat_mask_leading_unmatched(_tt::flat_mask_t x) noexcept {
+
+
+		return x ? _tt::flat_mask_lowest(x) : _tt::FLAT_GROUP_WIDTH;
+	}
+
+	// Returns the bit of a group mask corresponding to the control byte at index i.
+	constexpr _tt::flat_mask_t flat_mask_bit(tt_size i) noexcept {
+
+
+		return (_tt::flat_mask_t)1 << ((i << _tt::FLAT_MASK_SHIFT) + (_tt::FLAT_MASK_SHIFT ? 7 : 0));
+	}
+
+	// Returns the number of unmatched control bytes at the end of the group of mask x.
+	inline tt_size flat_mask_trailing_unmatched(_tt::flat_mask_t x) noexcept {
+
+
+		tt_size r = 0;
+
+		while (r < _tt::FLAT_GROUP_WIDTH && !(x & _tt::flat_mask_bit(_tt::FLAT_GROUP_WIDTH - 1 - r)))
+			++r;
+
+		return r;
+	}
+
+
+	// NOTE: probing visits groups at triangular number offsets from the initial position, which, as capacities
+	//		 are always one less than a power of two, visits every group exactly once before repeating
+
+	struct flat_probe final {
+
+		tt_size mask, offset, index;
+
+
+		inline flat_probe(tt_size hash, tt_size mask) noexcept
+			: mask(mask),
+			offset(hash & mask),
+			index(0) {}
+
+		inline tt_size at(tt_size i) const noexcept { return (offset + i) & mask; }
+
+		inline void next() noexcept {
+
+
+			index += _tt::FLAT_GROUP_WIDTH;
+			offset = (offset + index) & mask;
+		}
+	};
+
+
+	// NOTE: std::hash is often the identity function for integers, so hash codes are mixed (via the 'fmix'
+	//		 finalizer of MurmurHash3) such that both H1 and H2 get well distributed bits
+
+	inline tt_size flat_mix(tt_size x) noexcept {
+
+
+		if constexpr (sizeof(tt_size) == 8) {
+
+
+			tt_uint64 h = (tt_uint64)x;
+
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdULL;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ULL;
+			h ^= h >> 33;
+
+			return (tt_size)h;
+		}
+		else {
+
+
+			tt_uint32 h = (tt_uint32)x;
+
+			h ^= h >> 16;
+			h *= 0x85ebca6bU;
+			h ^= h >> 13;
+			h *= 0xc2b2ae35U;
+			h ^= h >> 16;
+
+			return (tt_size)h;
+		}
+	}
+
+	inline tt_size flat_h1(tt_size hash) noexcept { return hash >> 7; }
+	inline _tt::flat_ctrl_t flat_h2(tt_size hash) noexcept { return (_tt::flat_ctrl_t)(hash & 0x7F); }
+
+
+	// NOTE: default initialized flat hash maps point to this, rather than allocating, such that
+	//		 lookups on them need not test for a missing table
+
+	inline const _tt::flat_ctrl_t* flat_empty_group() noexcept {
+
+
+		alignas(16) static const _tt::flat_ctrl_t r[16] = {
+			_tt::FLAT_SENTINEL, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY,
+			_tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY,
+			_tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY,
+			_tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY, _tt::FLAT_EMPTY,
+		};
+
+		return r;
+	}
+
+
+	// NOTE: hints that the memory at x, such as the control bytes a lookup will probe first, be brought into cache
+
+	inline void flat_prefetch(const void* x) noexcept {
+
+
+#if defined(_TT_SIMD_X86)
+		_mm_prefetch((const char*)x, _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(x);
+#else
+		(void)x;
+#endif
+	}
+
+
+	template<typename T, typename = void>
+	struct flat_is_transparent final : std::false_type {};
+
+	template<typename T>
+	struct flat_is_transparent<T, std::void_t<typename T::is_transparent>> final : std::true_type {};
+
+	// NOTE: lookups take keys of type K if the map is transparent, and otherwise of its key type, with this
+	//		 being done via a member alias template of a non-dependent class, such that K is still deduced
+
+	template<tt_bool Transparent>
+	struct flat_key_arg final {
+
+		template<typename K, typename Key>
+		using type = Key;
+	};
+
+	template<>
+	struct flat_key_arg<true> final {
+
+		template<typename K, typename Key>
+		using type = K;
+	};
+
+
+	// NOTE: this is passed to the functions given to lazy_emplace, to construct the new entry in its slot
+
+	template<typename Value>
+	struct flat_constructor final {
+
+		Value*			slot;
+		tt_bool			constructed;
+
+
+		template<typename... Args>
+		inline void operator()(Args&&... args) {
+
+
+			tt_assert(!constructed);
+
+			tt::construct_at(slot, TT_FMOVE_N(Args, args));
+
+			constructed = true;
+		}
+	};
+}
+
+namespace tt {
+
+
+	// An iterator used to iterate across the entries of a tt::flat_hash_map.
+	template<typename Value>
+	class flat_hash_map_iterator final {
+	public:
+
+		using value_t = typename Value;
+
+		// If the iterator is a 'const-iterator' or not.
+		static constexpr tt_bool IS_CONST = std::is_const_v<value_t>;
+
+		using this_t = tt::flat_hash_map_iterator<value_t>;
+
+		using difference_type = std::ptrdiff_t;
+		using value_type = std::remove_const_t<value_t>;
+		using pointer = value_t*;
+		using reference = value_t&;
+
+		using iterator_category = std::forward_iterator_tag;
+
+
+		// Default initializes a past-the-end flat hash map iterator.
+		inline flat_hash_map_iterator() noexcept {
+
+
+			_ctrl = nullptr;
+			_slot = nullptr;
+		}
+
+		// Explicitly initializes an iterator of the slot x, with control byte ctrl.
+		// If ctrl is not that of a full slot, the iterator advances to the next full slot.
+		inline flat_hash_map_iterator(const _tt::flat_ctrl_t* ctrl, pointer x) noexcept {
+
+
+			_ctrl = ctrl;
+			_slot = x;
+
+			_skip();
+		}
+
+		// Copy-initializes a flat hash map iterator.
+		inline flat_hash_map_iterator(const this_t& x) noexcept {
+
+
+			TT_COPY(_ctrl, x);
+			TT_COPY(_slot, x);
+		}
+
+		inline ~flat_hash_map_iterator() noexcept {};
+
+		inline this_t& operator=(const this_t& rhs) noexcept { TT_COPY(_ctrl, rhs); TT_COPY(_slot, rhs); TT_RETURN_THIS; }
+
+		// Returns the pointer associated with the iterator.
+		constexpr pointer get() const noexcept { return _slot; }
+
+		// Returns if the iterator is a const-iterator or not.
+		constexpr tt_bool is_const() const noexcept { return IS_CONST; }
+
+		// Returns the const-iterator equivalent of this iterator.
+		inline tt::flat_hash_map_iterator<std::add_const_t<value_t>> to_const() const noexcept {
+
+
+			return tt::flat_hash_map_iterator<std::add_const_t<value_t>>(_ctrl, _slot);
+		}
+
+		// Returns if this and the given flat hash map iterator are equal.
+		constexpr tt_bool equal(const this_t& other) const noexcept { return get() == other.get(); }
+
+		constexpr tt_bool operator==(const this_t& rhs) const noexcept { return equal(rhs); }
+		constexpr tt_bool operator!=(const this_t& rhs) const noexcept { return !equal(rhs); }
+
+		inline reference operator*() const noexcept { return *_slot; }
+		inline pointer operator->() const noexcept { return _slot; }
+
+		inline this_t& operator++() noexcept {
+
+
+			++_ctrl;
+			++_slot;
+
+			_skip();
+
+			TT_RETURN_THIS;
+		}
+
+		inline this_t operator++(int) noexcept { auto t = *this; ++* this; return t; }
+
+
+	private:
+
+		const _tt::flat_ctrl_t* _ctrl;
+		pointer _slot;
+
+
+		// NOTE: skips past empty and deleted slots, becoming past-the-end upon reaching the sentinel
+
+		inline void _skip() noexcept {
+
+
+			if (!_ctrl)
+				return;
+
+			while (_tt::flat_is_empty_or_deleted(*_ctrl))
+				++_ctrl,
+				++_slot;
+
+			if (*_ctrl == _tt::FLAT_SENTINEL)
+				_ctrl = nullptr,
+				_slot = nullptr;
+		}
+	};
+
+
+	// The Tirous Toolbox library's open-addressing 'flat' hash map implementation.
+	// Entries are stored inline in a single array, with lookups probing groups of control bytes at a time.
+	// Keys and values must be nothrow move-constructible, and Hash and KeyEqual must not throw.
+	// Unlike std::unordered_map, any insertion may invalidate all iterators, pointers and references to entries.
+	// If both Hash and KeyEqual define an is_transparent member type, lookups may be performed with objects other than keys (ie. string views for string keys) without building keys of them.
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	class flat_hash_map final {
+	public:
+
+		using key_t = typename Key;
+		using mapped_t = typename Value;
+
+		using this_t = tt::flat_hash_map<key_t, mapped_t, Hash, KeyEqual>;
+
+		using key_type = key_t;
+		using mapped_type = mapped_t;
+		using value_type = std::pair<const key_t, mapped_t>;
+		using size_type = tt_size;
+		using difference_type = std::ptrdiff_t;
+		using hasher = typename Hash;
+		using key_equal = typename KeyEqual;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+
+		using iterator = tt::flat_hash_map_iterator<value_type>;
+		using const_iterator = tt::flat_hash_map_iterator<const value_type>;
+
+		// If the flat hash map supports heterogeneous lookup, via Hash and KeyEqual both being transparent.
+		static constexpr tt_bool IS_TRANSPARENT = _tt::flat_is_transparent<hasher>::value && _tt::flat_is_transparent<key_equal>::value;
+
+		// The type of the keys taken by lookups, which is K if the flat hash map is transparent, and key_t otherwise.
+		template<typename K>
+		using key_arg_t = typename _tt::flat_key_arg<IS_TRANSPARENT>::template type<K, key_t>;
+
+		static_assert(std::is_nothrow_move_constructible_v<key_t>, "tt::flat_hash_map keys must be nothrow move-constructible!");
+		static_assert(std::is_nothrow_move_constructible_v<mapped_t>, "tt::flat_hash_map values must be nothrow move-constructible!");
+
+		// The number of control bytes probed at once.
+		static constexpr tt_size GROUP_WIDTH = _tt::FLAT_GROUP_WIDTH;
+
+		// The smallest non-zero capacity of a flat hash map.
+		static constexpr tt_size MIN_CAPACITY = 15;
+
+		// The alignment of the block holding a flat hash map's slots and control bytes.
+		static constexpr tt_size ALIGNMENT = alignof(value_type) > 16 ? alignof(value_type) : 16;
+
+
+		// Default initializes an empty flat hash map.
+		// No memory is allocated until the first insertion.
+		inline flat_hash_map() noexcept {
+
+
+			_block = nullptr;
+			_ctrl = (_tt::flat_ctrl_t*)_tt::flat_empty_group();
+			_slots = nullptr;
+			_size = 0;
+			_capacity = 0;
+			_growth_left = 0;
+		}
+
+		// Initializes an empty flat hash map, with room for at least n entries.
+		inline explicit flat_hash_map(tt_size n)
+			: flat_hash_map() {
+
+
+			reserve(n);
+		}
+
+		// Initializes a flat hash map with the given entries.
+		// If an entry's key is repeated, the first entry with that key is used.
+		inline flat_hash_map(std::initializer_list<value_type> x)
+			: flat_hash_map(x.size()) {
+
+
+			TT_FOR_RANGE(i, x)
+				insert(i);
+		}
+
+		// Copy-initializes a flat hash map.
+		inline flat_hash_map(const this_t& x)
+			: flat_hash_map() {
+
+
+			// NOTE: the hash and equality function objects are copied before any entry is hashed, as they may be stateful
+
+			_hasher = x._hasher;
+			_key_equal = x._key_equal;
+
+			reserve(x.size());
+
+			// NOTE: as no key is repeated, entries are placed directly, skipping the search for an existing entry
+
+			TT_FOR_RANGE(i, x) {
+
+
+				const tt_size _hash = _hash_of(i.first);
+				const tt_size _index = _prepare_insert(_hash);
+
+				tt::construct_at(_slots + _index, i);
+
+				_commit_insert(_index, _hash);
+			}
+		}
+
+		// Move-initializes a flat hash map.
+		inline flat_hash_map(this_t&& x) noexcept
+			: flat_hash_map() {
+
+
+			swap(x);
+		}
+
+		inline ~flat_hash_map() noexcept {
+
+
+			_release();
+		}
+
+		inline this_t& operator=(const this_t& rhs) {
+
+
+			TT_SELF_COPY_TEST(rhs);
+
+			this_t _temp(rhs);
+
+			swap(_temp);
+
+			TT_RETURN_THIS;
+		}
+
+		inline this_t& operator=(this_t&& rhs) noexcept {
+
+
+			TT_SELF_MOVE_TEST(rhs);
+
+			_release();
+
+			swap(rhs);
+
+			TT_RETURN_THIS;
+		}
+
+		// Returns the number of entries in the flat hash map.
+		constexpr tt_size size() const noexcept { return _size; }
+
+		// Returns if the flat hash map has no entries.
+		constexpr tt_bool empty() const noexcept { return size() == 0; }
+
+		// Returns the number of slots in the flat hash map.
+		constexpr tt_size capacity() const noexcept { return _capacity; }
+
+		// Returns the ratio of entries to slots in the flat hash map.
+		inline tt_double load_factor() const noexcept { return capacity() > 0 ? (tt_double)size() / (tt_double)capacity() : 0.0; }
+
+		// Returns the maximum ratio of entries to slots the flat hash map allows before growing.
+		constexpr tt_double max_load_factor() const noexcept { return 7.0 / 8.0; }
+
+		// Returns the hash function object of the flat hash map.
+		inline hasher hash_function() const { return _hasher; }
+
+		// Returns the key equality function object of the flat hash map.
+		inline key_equal key_eq() const { return _key_equal; }
+
+		// Returns the hash code the flat hash map uses for the given key.
+		// This may be passed to the overloads of find, contains, prefetch and lazy_emplace taking one, to avoid hashing a key more than once.
+		template<typename K = key_t>
+		inline tt_size hash_of(const key_arg_t<K>& key) const noexcept { return _hash_of(key); }
+
+		// Returns an iterator to the entry with the given key, or end() if there is none.
+		template<typename K = key_t>
+		inline iterator find(const key_arg_t<K>& key) noexcept { return find(key, _hash_of(key)); }
+
+		// Returns an iterator to the entry with the given key, or end() if there is none.
+		template<typename K = key_t>
+		inline const_iterator find(const key_arg_t<K>& key) const noexcept { return find(key, _hash_of(key)); }
+
+		// Returns an iterator to the entry with the given key, or end() if there is none.
+		// Behaviour is undefined if hash is not the hash code of key, as returned by hash_of.
+		template<typename K = key_t>
+		inline iterator find(const key_arg_t<K>& key, tt_size hash) noexcept {
+
+
+			const tt_size _index = _find(key, hash);
+
+			return _index != _NOT_FOUND ? _iterator_at(_index) : end();
+		}
+
+		// Returns an iterator to the entry with the given key, or end() if there is none.
+		// Behaviour is undefined if hash is not the hash code of key, as returned by hash_of.
+		template<typename K = key_t>
+		inline const_iterator find(const key_arg_t<K>& key, tt_size hash) const noexcept {
+
+
+			const tt_size _index = _find(key, hash);
+
+			return _index != _NOT_FOUND ? _iterator_at(_index) : end();
+		}
+
+		// Returns if the flat hash map contains an entry with the given key.
+		template<typename K = key_t>
+		inline tt_bool contains(const key_arg_t<K>& key) const noexcept { return _find(key, _hash_of(key)) != _NOT_FOUND; }
+
+		// Returns if the flat hash map contains an entry with the given key.
+		// Behaviour is undefined if hash is not the hash code of key, as returned by hash_of.
+		template<typename K = key_t>
+		inline tt_bool contains(const key_arg_t<K>& key, tt_size hash) const noexcept { return _find(key, hash) != _NOT_FOUND; }
+
+		// Returns the number of entries with the given key, which is either 0 or 1.
+		template<typename K = key_t>
+		inline tt_size count(const key_arg_t<K>& key) const noexcept { return contains<K>(key) ? 1 : 0; }
+
+		// Hints that the control bytes and slots a lookup of a key of the given hash code will probe first be brought into cache.
+		// Prefetching the lookups of many keys before performing them allows their cache misses to overlap.
+		inline void prefetch(tt_size hash) const noexcept {
+
+
+			const tt_size _offset = _tt::flat_h1(hash) & _capacity;
+
+			_tt::flat_prefetch(_ctrl + _offset);
+
+			if (_slots)
+				_tt::flat_prefetch(_slots + _offset);
+		}
+
+		// Returns an lvalue of the value of the entry with the given key.
+		// Throws tt::out_of_range_error if there is no such entry.
+		template<typename K = key_t>
+		inline mapped_t& at(const key_arg_t<K>& key) {
+
+
+			const tt_size _index = _find(key, _hash_of(key));
+
+			if (_index == _NOT_FOUND)
+				TT_THROW(tt::out_of_range_error, "flat_hash_map has no entry with the given key!");
+
+			return _slots[_index].second;
+		}
+
+		// Returns an lvalue of the value of the entry with the given key.
+		// Throws tt::out_of_range_error if there is no such entry.
+		template<typename K = key_t>
+		inline const mapped_t& at(const key_arg_t<K>& key) const {
+
+
+			const tt_size _index = _find(key, _hash_of(key));
+
+			if (_index == _NOT_FOUND)
+				TT_THROW(tt::out_of_range_error, "flat_hash_map has no entry with the given key!");
+
+			return _slots[_index].second;
+		}
+
+		// Returns an lvalue of the value of the entry with the given key, inserting a value-initialized one if there is none.
+		inline mapped_t& operator[](const key_t& key) { return try_emplace(key).first->second; }
+
+		// Returns an lvalue of the value of the entry with the given key, inserting a value-initialized one if there is none.
+		inline mapped_t& operator[](key_t&& key) { return try_emplace(std::move(key)).first->second; }
+
+		// Inserts an entry with the given key, and a value constructed from args, if there is no entry with that key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		// Provides a strong guarantee of exception-safety, excluding the flat hash map's capacity.
+		template<typename K, typename... Args>
+		inline std::pair<iterator, tt_bool> try_emplace(K&& key, Args&&... args) {
+
+
+			const tt_size _hash = _hash_of(key);
+
+			tt_size _index = _find(key, _hash);
+
+			if (_index != _NOT_FOUND)
+				return std::make_pair(_iterator_at(_index), false);
+
+			_index = _prepare_insert(_hash);
+
+			tt::construct_at(_slots + _index, std::piecewise_construct, std::forward_as_tuple(TT_FMOVE(K, key)), std::forward_as_tuple(TT_FMOVE_N(Args, args)));
+
+			_commit_insert(_index, _hash);
+
+			return std::make_pair(_iterator_at(_index), true);
+		}
+
+		// If there is no entry with the given key, invokes f with an lvalue of a function object which constructs the new entry in place from its arguments.
+		// f must invoke this function object exactly once, constructing an entry with a key equal to the given key, and must not otherwise modify the flat hash map.
+		// This performs only one lookup, with the new entry only being built if there is no entry with the given key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		// If f throws, no insertion occurs, providing a strong guarantee of exception-safety, excluding the flat hash map's capacity.
+		template<typename K = key_t, typename F>
+		inline std::pair<iterator, tt_bool> lazy_emplace(const key_arg_t<K>& key, F&& f) { return lazy_emplace(key, _hash_of(key), TT_FMOVE(F, f)); }
+
+		// If there is no entry with the given key, invokes f with an lvalue of a function object which constructs the new entry in place from its arguments.
+		// f must invoke this function object exactly once, constructing an entry with a key equal to the given key, and must not otherwise modify the flat hash map.
+		// This performs only one lookup, with the new entry only being built if there is no entry with the given key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		// If f throws, no insertion occurs, providing a strong guarantee of exception-safety, excluding the flat hash map's capacity.
+		// Behaviour is undefined if hash is not the hash code of key, as returned by hash_of.
+		template<typename K = key_t, typename F>
+		inline std::pair<iterator, tt_bool> lazy_emplace(const key_arg_t<K>& key, tt_size hash, F&& f) {
+
+
+			tt_size _index = _find(key, hash);
+
+			if (_index != _NOT_FOUND)
+				return std::make_pair(_iterator_at(_index), false);
+
+			_index = _prepare_insert(hash);
+
+			_tt::flat_constructor<value_type> _constructor{ _slots + _index, false };
+
+			try {
+
+
+				f(_constructor);
+			}
+			catch (...) {
+
+
+				if (_constructor.constructed)
+					tt::destroy_at(_slots + _index);
+
+				throw;
+			}
+
+			tt_assert(_constructor.constructed);
+			tt_assert(_key_equal(_slots[_index].first, key));
+
+			_commit_insert(_index, hash);
+
+			return std::make_pair(_iterator_at(_index), true);
+		}
+
+		// Inserts a copy of the given entry, if there is no entry with its key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		inline std::pair<iterator, tt_bool> insert(const value_type& x) { return try_emplace(x.first, x.second); }
+
+		// Inserts the given entry, if there is no entry with its key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		inline std::pair<iterator, tt_bool> insert(value_type&& x) { return try_emplace(std::move(const_cast<key_t&>(x.first)), std::move(x.second)); }
+
+		// Inserts an entry with the given key and value, or assigns value to the existing entry with that key.
+		// Returns an iterator to the entry with the key, and if an insertion occurred.
+		template<typename K, typename V>
+		inline std::pair<iterator, tt_bool> insert_or_assign(K&& key, V&& value) {
+
+
+			auto r = try_emplace(TT_FMOVE(K, key), TT_FMOVE(V, value));
+
+			if (!r.second)
+				r.first->second = TT_FMOVE(V, value);
+
+			return r;
+		}
+
+		// Erases the entry with the given key, returning the number of entries erased, which is either 0 or 1.
+		template<typename K = key_t>
+		inline tt_size erase(const key_arg_t<K>& key) noexcept {
+
+
+			const tt_size _index = _find(key, _hash_of(key));
+
+			if (_index == _NOT_FOUND)
+				return 0;
+
+			_erase_at(_index);
+
+			return 1;
+		}
+
+		// Erases the entry of the given iterator, returning an iterator to the entry following it.
+		// If x is past-the-end, the function fails quietly.
+		inline iterator erase(const_iterator x) noexcept {
+
+
+			if (x == cend())
+				return end();
+
+			const tt_size _index = (tt_size)(x.get() - _slots);
+
+			_erase_at(_index);
+
+			// NOTE: as the slot is no longer full, the iterator will advance to the entry following it
+
+			return _iterator_at(_index);
+		}
+
+		// Erases the entry of the given iterator, returning an iterator to the entry following it.
+		// If x is past-the-end, the function fails quietly.
+		inline iterator erase(iterator x) noexcept { return erase(x.to_const()); }
+
+		// Erases all entries, without changing the flat hash map's capacity.
+		inline void clear() noexcept {
+
+
+			if (capacity() == 0)
+				return;
+
+			_destroy_slots();
+
+			_reset_ctrl();
+
+			_size = 0;
+			_growth_left = _growth_of(capacity());
+		}
+
+		// Ensures the flat hash map can hold at least n entries without growing.
+		// Throws tt::max_size_error if the capacity required is too large.
+		inline void reserve(tt_size n) {
+
+
+			if (n > _growth_left + size())
+				_resize(_capacity_for(n));
+		}
+
+		// Resizes the flat hash map to the smallest capacity able to hold at least n entries, and at least its size, discarding any tombstones.
+		// Throws tt::max_size_error if the capacity required is too large.
+		inline void rehash(tt_size n) {
+
+
+			if (n == 0 && size() == 0) {
+
+
+				_release();
+
+				return;
+			}
+
+			_resize(_capacity_for(n > size() ? n : size()));
+		}
+
+		// Swaps the contents of this and the given flat hash map.
+		inline void swap(this_t& other) noexcept {
+
+
+			std::swap(_block, other._block);
+			std::swap(_ctrl, other._ctrl);
+			std::swap(_slots, other._slots);
+			std::swap(_size, other._size);
+			std::swap(_capacity, other._capacity);
+			std::swap(_growth_left, other._growth_left);
+			std::swap(_hasher, other._hasher);
+			std::swap(_key_equal, other._key_equal);
+		}
+
+		inline iterator begin() noexcept { return iterator(_ctrl, _slots); }
+		inline const_iterator begin() const noexcept { return cbegin(); }
+		inline const_iterator cbegin() const noexcept { return const_iterator(_ctrl, _slots); }
+
+		inline iterator end() noexcept { return iterator(); }
+		inline const_iterator end() const noexcept { return cend(); }
+		inline const_iterator cend() const noexcept { return const_iterator(); }
+
+
+	private:
+
+		static constexpr tt_size _NOT_FOUND = tt::max_of<tt_size>;
+
+		tt_byte* _block;
+		_tt::flat_ctrl_t* _ctrl;
+		value_type* _slots;
+
+		tt_size _size, _capacity, _growth_left;
+
+		hasher _hasher;
+		key_equal _key_equal;
+
+
+		// NOTE: the block holds capacity slots, followed by capacity + GROUP_WIDTH control bytes, where the
+		//		 control byte at index capacity is the sentinel, and the GROUP_WIDTH - 1 after it are clones
+		//		 of the first GROUP_WIDTH - 1, so that group loads near the end of the table need not wrap
+
+		static constexpr tt_size _slot_bytes(tt_size capacity) noexcept {
+
+
+			return tt::aligned_size(capacity * sizeof(value_type), ALIGNMENT);
+		}
+
+		static constexpr tt_size _block_bytes(tt_size capacity) noexcept {
+
+
+			return tt::aligned_size(_slot_bytes(capacity) + capacity + GROUP_WIDTH, ALIGNMENT);
+		}
+
+		// NOTE: at least one slot is always left empty, so that probing is guaranteed to terminate
+
+		static constexpr tt_size _growth_of(tt_size capacity) noexcept { return capacity - capacity / 8; }
+
+		static inline tt_size _capacity_for(tt_size n) {
+
+
+			tt_size r = MIN_CAPACITY;
+
+			while (_growth_of(r) < n) {
+
+
+				if (r > (tt::max_size / 2 - GROUP_WIDTH) / sizeof(value_type))
+					TT_THROW(tt::max_size_error, "flat_hash_map capacity exceeds max size!");
+
+				r = r * 2 + 1;
+			}
+
+			return r;
+		}
+
+		inline tt_size _grown_capacity() const {
+
+
+			if (capacity() == 0)
+				return MIN_CAPACITY;
+
+			if (capacity() > (tt::max_size / 2 - GROUP_WIDTH) / sizeof(value_type))
+				TT_THROW(tt::max_size_error, "flat_hash_map capacity exceeds max size!");
+
+			return capacity() * 2 + 1;
+		}
+
+		template<typename K>
+		inline tt_size _hash_of(const K& key) const noexcept { return _tt::flat_mix(_hasher(key)); }
+
+		inline iterator _iterator_at(tt_size index) noexcept { return iterator(_ctrl + index, _slots + index); }
+		inline const_iterator _iterator_at(tt_size index) const noexcept { return const_iterator(_ctrl + index, _slots + index); }
+
+		template<typename K>
+		inline tt_size _find(const K& key, tt_size hash) const noexcept {
+
+
+			_tt::flat_probe _seq(_tt::flat_h1(hash), _capacity);
+
+			const _tt::flat_ctrl_t _h2 = _tt::flat_h2(hash);
+
+			while (true) {
+
+
+				const _tt::flat_group _group(_ctrl + _seq.offset);
+
+				for (auto m = _group.match(_h2); m; m &= m - 1) {
+
+
+					const tt_size _index = _seq.at(_tt::flat_mask_lowest(m));
+
+					if (_key_equal(_slots[_index].first, key))
+						return _index;
+				}
+
+				if (_group.match_empty())
+					return _NOT_FOUND;
+
+				_seq.next();
+			}
+		}
+
+		inline tt_size _find_first_non_full(tt_size hash) const noexcept {
+
+
+			_tt::flat_probe _seq(_tt::flat_h1(hash), _capacity);
+
+			while (true) {
+
+
+				const auto m = _tt::flat_group(_ctrl + _seq.offset).match_empty_or_deleted();
+
+				if (m)
+					return _seq.at(_tt::flat_mask_lowest(m));
+
+				_seq.next();
+			}
+		}
+
+		inline void _set_ctrl(tt_size index, _tt::flat_ctrl_t x) noexcept {
+
+
+			_ctrl[index] = x;
+			_ctrl[((index - (GROUP_WIDTH - 1)) & _capacity) + ((GROUP_WIDTH - 1) & _capacity)] = x;
+		}
+
+		inline void _reset_ctrl() noexcept {
+
+
+			tt::fill_array(_ctrl, _capacity + GROUP_WIDTH, _tt::FLAT_EMPTY);
+
+			_ctrl[_capacity] = _tt::FLAT_SENTINEL;
+		}
+
+		// NOTE: returns the index of the slot the new entry should be constructed in, growing the table if needed,
+		//		 with the entry only being counted once _commit_insert is called, after its construction succeeds
+
+		inline tt_size _prepare_insert(tt_size hash) {
+
+
+			tt_size r = _find_first_non_full(hash);
+
+			if (_growth_left == 0 && _ctrl[r] != _tt::FLAT_DELETED) {
+
+
+				// NOTE: tombstones are only purged in place if doing so frees a sizable fraction of the table (ie. at
+				//		 most ~78% of it is full), as otherwise mixed erase/insert traffic near max load would rehash
+				//		 the whole table for every insert, so in all other cases the table always doubles in size
+
+				_resize(capacity() > 0 && size() * 32 <= capacity() * 25 ? capacity() : _grown_capacity());
+
+				r = _find_first_non_full(hash);
+			}
+
+			return r;
+		}
+
+		inline void _commit_insert(tt_size index, tt_size hash) noexcept {
+
+
+			if (_ctrl[index] == _tt::FLAT_EMPTY)
+				--_growth_left;
+
+			_set_ctrl(index, _tt::flat_h2(hash));
+
+			++_size;
+		}
+
+		// NOTE: a slot may only be marked EMPTY, rather than DELETED, if no probe could have ever passed
+		//		 over it while it was full, which is the case if there's no run of GROUP_WIDTH non-empty
+		//		 slots containing it
+
+		inline void _erase_at(tt_size index) noexcept {
+
+
+			tt::destroy_at(_slots + index);
+
+			const tt_size _before = (index - GROUP_WIDTH) & _capacity;
+
+			const auto _empty_after = _tt::flat_group(_ctrl + index).match_empty();
+			const auto _empty_before = _tt::flat_group(_ctrl + _before).match_empty();
+
+			const tt_bool _was_never_full =
+				_empty_before &&
+				_empty_after &&
+				_tt::flat_mask_leading_unmatched(_empty_after) + _tt::flat_mask_trailing_unmatched(_empty_before) < GROUP_WIDTH;
+
+			_set_ctrl(index, _was_never_full ? _tt::FLAT_EMPTY : _tt::FLAT_DELETED);
+
+			_growth_left += _was_never_full ? 1 : 0;
+
+			--_size;
+		}
+
+		inline void _destroy_slots() noexcept {
+
+
+			if constexpr (!std::is_trivially_destructible_v<value_type>)
+				TT_FOR(i, _capacity)
+					if (_tt::flat_is_full(_ctrl[i]))
+						tt::destroy_at(_slots + i);
+		}
+
+		inline void _resize(tt_size new_capacity) {
+
+
+			tt_assert(new_capacity >= MIN_CAPACITY);
+			tt_assert(_growth_of(new_capacity) >= size());
+
+			tt_byte* _new_block = tt::aligned_alloc_uninit<tt_byte>(_block_bytes(new_capacity), ALIGNMENT);
+
+			if (!_new_block)
+				throw std::bad_alloc();
+
+			// nothing beyond here can throw
+
+			tt_byte* _old_block = _block;
+			_tt::flat_ctrl_t* _old_ctrl = _ctrl;
+			value_type* _old_slots = _slots;
+			const tt_size _old_capacity = _capacity;
+
+			_block = _new_block;
+			_slots = (value_type*)_new_block;
+			_ctrl = (_tt::flat_ctrl_t*)(_new_block + _slot_bytes(new_capacity));
+			_capacity = new_capacity;
+
+			_reset_ctrl();
+
+			TT_FOR(i, _old_capacity) {
+
+
+				if (!_tt::flat_is_full(_old_ctrl[i]))
+					continue;
+
+				const tt_size _hash = _hash_of(_old_slots[i].first);
+				const tt_size _index = _find_first_non_full(_hash);
+
+				// NOTE: the key of the old entry is about to be destroyed, so it's moved from, despite being const
+
+				tt::construct_at(_slots + _index, std::move(const_cast<key_t&>(_old_slots[i].first)), std::move(_old_slots[i].second));
+				tt::destroy_at(_old_slots + i);
+
+				_set_ctrl(_index, _tt::flat_h2(_hash));
+			}
+
+			_growth_left = _growth_of(_capacity) - size();
+
+			tt::aligned_dealloc_uninit(_old_block);
+		}
+
+		inline void _release() noexcept {
+
+
+			if (!_block)
+				return;
+
+			_destroy_slots();
+
+			tt::aligned_dealloc_uninit(_block);
+
+			_block = nullptr;
+			_ctrl = (_tt::flat_ctrl_t*)_tt::flat_empty_group();
+			_slots = nullptr;
+			_size = 0;
+			_capacity = 0;
+			_growth_left = 0;
+		}
+	};
+}
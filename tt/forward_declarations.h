@@ -6,6 +6,8 @@
 // A header file of class forward declarations, to avoid circular dependency issues.
 
 
+#include <functional>
+
 #include "aliases.h"
 
 
@@ -46,6 +48,20 @@ namespace tt {
 
 	template<typename Value, tt_size Alignment>
 	struct aligned_allocator;
+
+	template<typename Value>
+	struct page_allocator;
+
+	class arena;
+
+	template<typename Value, tt_size Alignment>
+	struct arena_allocator;
+
+	template<typename Value>
+	class object_pool;
+
+	template<typename Header, typename BodyItem>
+	class inline_object;
 	
 
 	template<typename Value>
@@ -63,6 +79,18 @@ namespace tt {
 	template<tt_size Alignment, typename Allocator = tt::aligned_allocator<tt::chunk_unit<Alignment>, Alignment>>
 	class chunk;
 
+	template<typename Vector>
+	class soa_vector_iterator;
+
+	template<typename Value>
+	class flat_hash_map_iterator;
+
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class flat_hash_map;
+
+	template<typename... Fields>
+	class soa_vector;
+
 
 	template<typename A, typename B = void, typename C = void, typename D = void, typename E = void, typename F = void, typename G = void, typename H = void>
 	struct tuple_struct;
@@ -13,7 +13,16 @@
 
 #include "../chunk.h"
 
+#include "../soa_vector.h"
+
 #include "../str.h"
+#include "../str_interner.h"
+#include "../str_builder.h"
+#include "../str_rope.h"
+
+#include "../flat_hash_map.h"
 
+#include "../eviction_policies.h"
 #include "../memoized_pool.h"
+#include "../concurrent_memoized_pool.h"
 
@@ -10,3 +10,6 @@
 #include "../hash_functions.h"
 #include "../hash_factory.h"
 
+#include "../bulk_hash.h"
+
+#include "../checksum.h"
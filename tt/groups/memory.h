@@ -7,12 +7,19 @@
 
 
 #include "../allocation.h"
+#include "../page_allocation.h"
+#include "../size_class_allocation.h"
 #include "../deletion.h"
 #include "../placement_construction.h"
 #include "../endian.h"
 #include "../memory_util.h"
+#include "../memory_simd.h"
 
 #include "../aligned_allocator.h"
+#include "../page_allocator.h"
+#include "../arena.h"
+#include "../object_pool.h"
 
 #include "../inline_layout.h"
+#include "../inline_object.h"
 
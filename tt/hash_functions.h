@@ -7,12 +7,14 @@
 
 
 #include <functional>
+#include <type_traits>
 
 #include "aliases.h"
 
 #include "memory_util.h"
 
 #include "hash_factory.h"
+#include "bulk_hash.h"
 
 
 namespace tt {
@@ -29,10 +31,15 @@ namespace tt {
 
 	// Returns the hash code of the given array.
 	// The Tirous Toolbox library does not guarantee that hash codes will be (reasonably) unique unless two objects are of the same type.
+	// Arrays of scalar types whose values are equal only if their bytes are (ie. integers and characters, but not floats) are hashed via tt::bulk_hash.
+	// Arrays of class types are always hashed element by element, as their operator== may ignore some of their bytes.
 	template<typename Value>
 	inline tt_size array_hash_of(const Value* const x, tt_size n) noexcept {
 
 
+		if constexpr (std::is_scalar_v<Value> && std::has_unique_object_representations_v<Value>)
+			return tt::bulk_hash(x, n * sizeof(Value));
+
 		tt::hash_factory h(1880177309, 3725419109, (tt_size)3342954644411632897, (tt_size)2453334075520421939);
 
 		h.add(n);
@@ -32,11 +32,12 @@ namespace tt {
 		~inline_layout() noexcept = delete;
 
 
-		static_assert(alignof(header_t) <= alignof(body_item_t));
-
-
 		static constexpr auto ALIGNMENT = alignof(body_item_t);
 
+		// The alignment blocks of this layout must adhere to, which is that of the header or body item, whichever is greater.
+		// Layout math is done in units of ALIGNMENT bytes, so a header aligned more strictly than its body items is still supported.
+		static constexpr auto BLOCK_ALIGNMENT = alignof(header_t) > alignof(body_item_t) ? alignof(header_t) : alignof(body_item_t);
+
 		struct unit final {
 
 			alignas(ALIGNMENT) tt_byte _dummy[ALIGNMENT] = {};
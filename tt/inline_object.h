@@ -0,0 +1,344 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's 'inline object' implementation.
+
+// An inline object owns a single block of memory laid out via tt::inline_layout, holding a header
+// followed by a runtime-sized body array, such that variable-length records (ie. strings with metadata,
+// or nodes with inline children) require only one allocation, and one cache miss, to access.
+
+// The block may either be heap allocated, or be allocated from a tt::arena.
+
+
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "exceptions.h"
+#include "forward_declarations.h"
+
+#include "math_util.h"
+#include "allocation.h"
+#include "placement_construction.h"
+#include "inline_layout.h"
+#include "arena.h"
+
+#include "slice.h"
+
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's 'inline object' implementation.
+	// Owns a single block containing a header of type Header, followed by a body of n items of type BodyItem.
+	// Inline objects are move-only, and destroy their header and body items upon destruction.
+	// If arena-backed, the block's memory is released by the arena, rather than by the inline object.
+	template<typename Header, typename BodyItem>
+	class inline_object final {
+	public:
+
+		using header_t = typename Header;
+		using body_item_t = typename BodyItem;
+
+		using this_t = tt::inline_object<header_t, body_item_t>;
+
+		using layout_t = tt::inline_layout<header_t, body_item_t>;
+		using unit_t = typename layout_t::unit;
+
+
+		// Default initializes a null inline object.
+		inline inline_object() noexcept {
+
+
+			_block = nullptr;
+			_n = 0;
+			_arena = nullptr;
+		}
+
+		inline_object(const this_t&) = delete;
+
+		// Move-initializes an inline object.
+		inline inline_object(this_t&& x) noexcept
+			: inline_object() {
+
+
+			swap(x);
+		}
+
+		inline ~inline_object() noexcept {
+
+
+			reset();
+		}
+
+		this_t& operator=(const this_t&) = delete;
+
+		inline this_t& operator=(this_t&& rhs) noexcept {
+
+
+			TT_SELF_MOVE_TEST(rhs);
+
+			reset();
+
+			swap(rhs);
+
+			TT_RETURN_THIS;
+		}
+
+		// Returns a heap allocated inline object of n value-initialized body items, with its header constructed from args.
+		// Provides a strong guarantee of exception-safety.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		template<typename... Args>
+		static inline this_t make(tt_size n, Args&&... args) {
+
+
+			this_t r;
+
+			r._build(nullptr, nullptr, n, TT_FMOVE_N(Args, args));
+
+			return r;
+		}
+
+		// Returns a heap allocated inline object of n body items copied from items, with its header constructed from args.
+		// Provides a strong guarantee of exception-safety.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		template<typename... Args>
+		static inline this_t make_copy(const body_item_t* items, tt_size n, Args&&... args) {
+
+
+			tt_assert(items || n == 0);
+
+			this_t r;
+
+			r._build(nullptr, items, n, TT_FMOVE_N(Args, args));
+
+			return r;
+		}
+
+		// Returns an inline object allocated from arena a, of n value-initialized body items, with its header constructed from args.
+		// The inline object must be destroyed before a is reset, released, or destroyed.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		template<typename... Args>
+		static inline this_t make_in(tt::arena& a, tt_size n, Args&&... args) {
+
+
+			this_t r;
+
+			r._build(&a, nullptr, n, TT_FMOVE_N(Args, args));
+
+			return r;
+		}
+
+		// Returns an inline object allocated from arena a, of n body items copied from items, with its header constructed from args.
+		// The inline object must be destroyed before a is reset, released, or destroyed.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		template<typename... Args>
+		static inline this_t make_copy_in(tt::arena& a, const body_item_t* items, tt_size n, Args&&... args) {
+
+
+			tt_assert(items || n == 0);
+
+			this_t r;
+
+			r._build(&a, items, n, TT_FMOVE_N(Args, args));
+
+			return r;
+		}
+
+		// Returns the number of bytes of a block holding a body of n items.
+		static constexpr tt_size bytes_for(tt_size n) noexcept {
+
+
+			return tt::aligned_size(layout_t::get_bytes_total(n), layout_t::BLOCK_ALIGNMENT);
+		}
+
+		// Returns if the inline object is non-null.
+		constexpr tt_bool has_value() const noexcept { return _block; }
+
+		// Returns if the inline object is null.
+		constexpr tt_bool is_null() const noexcept { return !has_value(); }
+
+		// Returns if the inline object's block was allocated from an arena.
+		constexpr tt_bool is_arena_backed() const noexcept { return _arena; }
+
+		// Returns the number of items in the inline object's body.
+		constexpr tt_size size() const noexcept { return _n; }
+
+		// Returns the number of bytes of the inline object's block, or 0 if it is null.
+		constexpr tt_size bytes() const noexcept { return has_value() ? bytes_for(size()) : 0; }
+
+		// Returns if the given index is within the bounds of the inline object's body.
+		constexpr tt_bool in_bounds(tt_size x) const noexcept { return x < size(); }
+
+		// Returns a pointer to the inline object's block, or nullptr if it is null.
+		inline unit_t* block() noexcept { return _block; }
+
+		// Returns a pointer to the inline object's block, or nullptr if it is null.
+		inline const unit_t* block() const noexcept { return _block; }
+
+		// Returns an lvalue of the inline object's header.
+		// Throws tt::illegal_deref_error if the inline object is null.
+		inline header_t& header() {
+
+
+			if (is_null())
+				TT_THROW(tt::illegal_deref_error, "inline_object is null!");
+
+			return layout_t::deref_header(_block);
+		}
+
+		// Returns an lvalue of the inline object's header.
+		// Throws tt::illegal_deref_error if the inline object is null.
+		inline const header_t& header() const {
+
+
+			if (is_null())
+				TT_THROW(tt::illegal_deref_error, "inline_object is null!");
+
+			return layout_t::deref_header(_block);
+		}
+
+		// Returns a pointer to the inline object's body, or nullptr if it is null or has no body items.
+		inline body_item_t* data() noexcept { return size() > 0 ? &layout_t::deref_body_item(_block, 0) : nullptr; }
+
+		// Returns a pointer to the inline object's body, or nullptr if it is null or has no body items.
+		inline const body_item_t* data() const noexcept { return size() > 0 ? &layout_t::deref_body_item(_block, 0) : nullptr; }
+
+		// Returns a slice of the inline object's body.
+		inline tt::slice<body_item_t> body() noexcept { return tt::slice<body_item_t>(data(), size()); }
+
+		// Returns a const-slice of the inline object's body.
+		inline tt::slice<const body_item_t> body() const noexcept { return tt::slice<const body_item_t>(data(), size()); }
+
+		// Returns an lvalue of the body item at the given index.
+		// This performs no bounds checking, and thus the lvalue returned may be invalid.
+		inline body_item_t& at_unchecked(tt_size x) noexcept { return layout_t::deref_body_item(_block, x); }
+
+		// Returns an lvalue of the body item at the given index.
+		// This performs no bounds checking, and thus the lvalue returned may be invalid.
+		inline const body_item_t& at_unchecked(tt_size x) const noexcept { return layout_t::deref_body_item(_block, x); }
+
+		// Returns an lvalue of the body item at the given index.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		inline body_item_t& at(tt_size x) {
+
+
+			if (!in_bounds(x))
+				TT_THROW(tt::out_of_range_error, "inline_object index out-of-range!");
+
+			return at_unchecked(x);
+		}
+
+		// Returns an lvalue of the body item at the given index.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		inline const body_item_t& at(tt_size x) const {
+
+
+			if (!in_bounds(x))
+				TT_THROW(tt::out_of_range_error, "inline_object index out-of-range!");
+
+			return at_unchecked(x);
+		}
+
+		inline body_item_t& operator[](tt_size x) { return at(x); }
+		inline const body_item_t& operator[](tt_size x) const { return at(x); }
+
+		// Destroys the inline object's header and body, releases its block (unless arena-backed), and makes it null.
+		inline void reset() noexcept {
+
+
+			if (is_null())
+				return;
+
+			tt::destroy_n_at(data(), size());
+			tt::destroy_at(&layout_t::deref_header(_block));
+
+			if (!is_arena_backed())
+				tt::aligned_dealloc_uninit(_block);
+
+			_block = nullptr;
+			_n = 0;
+			_arena = nullptr;
+		}
+
+		// Swaps the contents of this and the given inline object.
+		inline void swap(this_t& other) noexcept {
+
+
+			std::swap(_block, other._block);
+			std::swap(_n, other._n);
+			std::swap(_arena, other._arena);
+		}
+
+
+	private:
+
+		unit_t* _block;
+		tt_size _n;
+		tt::arena* _arena;
+
+
+		// NOTE: constructs the header, then each body item, destroying what has already been
+		//		 constructed, and releasing the block, if any of these throw
+
+		template<typename... Args>
+		inline void _build(tt::arena* a, const body_item_t* items, tt_size n, Args&&... args) {
+
+
+			tt_assert(is_null());
+
+			unit_t* _new_block =
+				a
+				? (unit_t*)a->allocate(bytes_for(n), layout_t::BLOCK_ALIGNMENT)
+				: tt::aligned_alloc_uninit<unit_t>(bytes_for(n) / sizeof(unit_t), layout_t::BLOCK_ALIGNMENT);
+
+			if (!_new_block)
+				throw std::bad_alloc();
+
+			tt_size _constructed = 0;
+			tt_bool _header_constructed = false;
+
+			try {
+
+
+				tt::construct_at(&layout_t::deref_header(_new_block), TT_FMOVE_N(Args, args));
+
+				_header_constructed = true;
+
+				for (; _constructed < n; ++_constructed) {
+
+
+					if (items)
+						tt::construct_at(&layout_t::deref_body_item(_new_block, _constructed), items[_constructed]);
+
+					else
+						tt::construct_at(&layout_t::deref_body_item(_new_block, _constructed));
+				}
+			}
+			catch (...) {
+
+
+				TT_FOR(i, _constructed)
+					tt::destroy_at(&layout_t::deref_body_item(_new_block, i));
+
+				if (_header_constructed)
+					tt::destroy_at(&layout_t::deref_header(_new_block));
+
+				if (!a)
+					tt::aligned_dealloc_uninit(_new_block);
+
+				throw;
+			}
+
+			_block = _new_block;
+			_n = n;
+			_arena = a;
+		}
+	};
+}
@@ -115,6 +115,18 @@
 #define TT_REINTERPRET(new_type, x) (*(new_type*)&(x))
 
 
+// NOTE: C++17 lacks std::is_constant_evaluated, but MSVC, GCC and clang all provide the builtin it wraps
+
+// A macro which expands to an expression which evaluates to if it's being evaluated at compile-time.
+// This is used to select runtime-only optimizations in constexpr functions.
+// If the compiler is unknown, this is always true, such that these optimizations are skipped.
+#if defined(TT_COMPILER_IS_UNKNOWN)
+#define TT_IS_CONSTANT_EVALUATED() true
+#else
+#define TT_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+
 // NOTE: (hopefully) portable macros for disabling warnings
 
 // NOTE: see https://www.fluentcpp.com/2019/08/30/how-to-disable-a-warning-in-cpp/
@@ -58,6 +58,31 @@
 					  be valid for at least the lifetime of the resource which produced it. The key
 					  returned must also equal the key used to produce the resource.
 
+		Map			- The type of associative container used to store the pool's entries, mapping Key objects to
+					  std::shared_ptr<const Resource> objects.
+
+					  By default this is std::unordered_map, however tt::flat_hash_map may be used instead (see
+					  tt::flat_memoized_pool) to avoid a heap allocation, and a pointer-chase, per entry.
+
+					  All Map types are expected to provide find, end, erase (by key and by iterator), clear, size,
+					  try_emplace, and operator[] methods equivalent to those of std::unordered_map.
+
+		Eviction	- The eviction policy used to decide which resources to discard when the pool is full (see
+					  tt/eviction_policies.h for details.)
+
+					  By default this is tt::no_eviction, in which case the pool is unbounded. Otherwise, capacity
+					  limits may be set via set_max_entries and set_max_weight, with tt::lru_eviction,
+					  tt::clock_eviction and tt::tinylfu_eviction being provided (see tt::bounded_memoized_pool.)
+
+					  Eviction policies index keys via their own Hash and KeyEqual parameters, which should be
+					  the hasher and key_equal of Map.
+
+					  If a Builder type provides a 'tt_size get_weight(const Resource&) const noexcept' method,
+					  it's used to weigh resources for set_max_weight, otherwise each resource weighs 1.
+
+					  Evicted resources remain valid so long as shared pointers to them, such as those returned
+					  by aquire_ptr, remain.
+
 	Put simply, a pool is instructed to 'aquire' a resource, and is provided a Key object to identify it
 	thusly in said pool.
 
@@ -90,10 +115,45 @@
 */
 
 
+#include <memory>
+#include <vector>
 #include <unordered_map>
+#include <type_traits>
 
 #include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "numeric_limits.h"
+#include "slice.h"
+#include "flat_hash_map.h"
+#include "eviction_policies.h"
+
+
+namespace _tt {
+
+
+	template<typename Builder, typename Resource, typename = void>
+	struct memoized_pool_has_get_weight final : std::false_type {};
 
+	template<typename Builder, typename Resource>
+	struct memoized_pool_has_get_weight<Builder, Resource, std::void_t<decltype(std::declval<const Builder&>().get_weight(std::declval<const Resource&>()))>> final : std::true_type {};
+
+	// NOTE: maps which, like tt::flat_hash_map, expose their hashing, prefetching and lazy_emplace, let pools
+	//		 find-or-insert entries in a single lookup, and batch the lookups of aquire_many
+
+	template<typename Map, typename Key, typename = void>
+	struct memoized_pool_is_flat final : std::false_type {};
+
+	template<typename Map, typename Key>
+	struct memoized_pool_is_flat<Map, Key, std::void_t<decltype(std::declval<const Map&>().hash_of(std::declval<const Key&>())), decltype(std::declval<const Map&>().prefetch(tt_size()))>> final : std::true_type {};
+
+	template<typename Map, typename = void>
+	struct memoized_pool_is_transparent final : std::false_type {};
+
+	template<typename Map>
+	struct memoized_pool_is_transparent<Map, std::void_t<decltype(Map::IS_TRANSPARENT)>> final : std::bool_constant<Map::IS_TRANSPARENT> {};
+}
 
 namespace tt {
 
@@ -118,17 +178,47 @@ namespace tt {
 	};
 
 
-	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>>
+	// The hit, miss and eviction counters of a tt::memoized_pool.
+	struct memoized_pool_stats final {
+
+		// The number of aquisitions which found their resource already memoized.
+		tt_size hits = 0;
+
+		// The number of aquisitions which had to build their resource.
+		tt_size misses = 0;
+
+		// The number of resources evicted to keep the pool within its capacity.
+		tt_size evictions = 0;
+
+
+		// Returns the fraction of aquisitions which were hits, or 0 if there were none.
+		inline tt_double hit_rate() const noexcept { return hits + misses > 0 ? (tt_double)hits / (tt_double)(hits + misses) : 0.0; }
+	};
+
+
+	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>, typename Map = std::unordered_map<Key, std::shared_ptr<const Resource>>, typename Eviction = tt::no_eviction<Key>>
 	class memoized_pool final {
 	public:
 
 		using key_t				= typename Key;
 		using resource_t		= typename Resource;
 		using builder_t			= typename Builder;
+		using map_t				= typename Map;
+		using eviction_t		= typename Eviction;
+
+		using this_t			= memoized_pool<key_t, resource_t, builder_t, map_t, eviction_t>;
+
+		using unordered_map_t	= map_t; // <- kept for backwards compatibility
 
-		using this_t			= memoized_pool<key_t, resource_t, builder_t>;
+		// If the builder provides resource weights, via a get_weight method.
+		static constexpr tt_bool HAS_WEIGHTS = _tt::memoized_pool_has_get_weight<builder_t, resource_t>::value;
 
-		using unordered_map_t	= std::unordered_map<key_t, std::shared_ptr<const resource_t>>;
+		// If the pool supports heterogeneous lookup, via its map (see tt::flat_hash_map), such that resources may be looked up via objects other than keys (ie. string views for tt::str keys) without building keys of them.
+		static constexpr tt_bool IS_TRANSPARENT = _tt::memoized_pool_is_transparent<map_t>::value;
+
+		// The type of the keys taken by lookups, which is K if the pool is transparent, and key_t otherwise.
+		template<typename K>
+		using key_arg_t = typename _tt::flat_key_arg<IS_TRANSPARENT>::template type<K, key_t>;
 
 
 		// Initializes a pool with a default-constructed builder.
@@ -144,7 +234,12 @@ namespace tt {
 
 		inline memoized_pool(this_t&& x) noexcept
 			: _builder(TT_FMOVE(builder_t, x._builder)), 
-			_resources(TT_FMOVE(unordered_map_t, x._resources)) {}
+			_resources(TT_FMOVE(map_t, x._resources)),
+			_eviction(TT_FMOVE(eviction_t, x._eviction)),
+			_max_entries(x._max_entries),
+			_max_weight(x._max_weight),
+			_weight(x._weight),
+			_stats(x._stats) {}
 
 		~memoized_pool() noexcept = default;
 
@@ -164,29 +259,74 @@ namespace tt {
 		inline tt_bool empty() const noexcept { return resources() == 0; }
 
 
+		// Returns the maximum number of memoized resources the pool may hold before evicting them.
+		inline tt_size max_entries() const noexcept { return _max_entries; }
+
+		// Returns the maximum total weight of the memoized resources the pool may hold before evicting them.
+		inline tt_size max_weight() const noexcept { return _max_weight; }
+
+		// Returns the total weight of the memoized resources in the pool.
+		// If the builder provides no get_weight method, each resource weighs 1.
+		// Weights are only tracked if the pool's eviction policy is enabled, and thus this is otherwise 0.
+		inline tt_size weight() const noexcept { return _weight; }
+
+		// Sets the maximum number of memoized resources the pool may hold, evicting resources as needed.
+		// Only usable if the pool's eviction policy is enabled.
+		inline void set_max_entries(tt_size n);
+
+		// Sets the maximum total weight of the memoized resources the pool may hold, evicting resources as needed.
+		// Resource weights are gotten via the builder's get_weight method, if it has one, which is expected to be equivalent to:
+		//		tt_size get_weight(const Resource&) const noexcept
+		// A resource heavier than the maximum weight on its own is still memoized, with all other resources being evicted to make room for it.
+		// Only usable if the pool's eviction policy is enabled.
+		inline void set_max_weight(tt_size n);
+
+		// Returns the hit, miss and eviction counters of the pool.
+		inline tt::memoized_pool_stats stats() const noexcept { return _stats; }
+
+		// Resets the hit, miss and eviction counters of the pool.
+		inline void reset_stats() noexcept { _stats = {}; }
+
+
 		// NOTE: while HIGHLY unlikely, 'find' is not noexcept, so no noexcept on fetch(_ptr) or contains
 
 		// Returns a pointer to the memoized resource associated with key in the pool, if available, or returning nullptr if it's not yet available.
-		inline const resource_t* fetch(const key_t& key) const;
+		template<typename K = key_t>
+		inline const resource_t* fetch(const key_arg_t<K>& key) const;
 
 		// Returns a pointer to the memoized resource associated with key in the pool, if available, or returning nullptr if it's not yet available.
 		// This returns a shared pointer of the underlying memory object itself.
-		inline std::shared_ptr<const resource_t> fetch_ptr(const key_t& key) const;
+		template<typename K = key_t>
+		inline std::shared_ptr<const resource_t> fetch_ptr(const key_arg_t<K>& key) const;
 
 		// Returns if the pool contains a memoized resource associated with key yet.
-		inline tt_bool contains(const key_t& key) const { return fetch(key); }
+		template<typename K = key_t>
+		inline tt_bool contains(const key_arg_t<K>& key) const { return fetch<K>(key); }
 
 		
 		// Instructs the memoized resource pool to aquire the resource associated with key, instantiated it if it's not yet available.
 		// If the builder is instructed to build a new resource, it may throw exceptions, and is expected to provide a basic guarantee of exception safety.
-		inline const resource_t& aquire(const key_t& key);
+		// If key is not a key_t, a key_t is built from it to pass to the builder, but only if the resource must be built.
+		// If the pool's eviction policy is enabled, the lvalue returned is invalidated if the resource is later evicted, so prefer aquire_ptr.
+		template<typename K = key_t>
+		inline const resource_t& aquire(const key_arg_t<K>& key);
 
-		inline const resource_t& operator[](const key_t& key) { return aquire(key); }
+		template<typename K = key_t>
+		inline const resource_t& operator[](const key_arg_t<K>& key) { return aquire<K>(key); }
 
 		// Instructs the memoized resource pool to aquire the resource associated with key, instantiated it if it's not yet available.
 		// If the builder is instructed to build a new resource, it may throw exceptions, and is expected to provide a basic guarantee of exception safety.
-		// This returns a shared pointer of the underlying memory object itself.
-		inline std::shared_ptr<const resource_t> aquire_ptr(const key_t& key);
+		// If key is not a key_t, a key_t is built from it to pass to the builder, but only if the resource must be built.
+		// If the pool's map supports it (see tt::flat_hash_map) this performs only one lookup, even if the resource must be built.
+		// This returns a shared pointer of the underlying memory object itself, which remains valid even if the resource is later evicted.
+		template<typename K = key_t>
+		inline std::shared_ptr<const resource_t> aquire_ptr(const key_arg_t<K>& key);
+
+		// Instructs the memoized resource pool to aquire the resources associated with keys, instantiating those not yet available.
+		// Returns shared pointers of the resources, in the order of their keys.
+		// If the pool's map supports it (see tt::flat_hash_map) the keys are hashed, and their lookups prefetched, in batches, ahead of the lookups themselves, such that their cache misses overlap.
+		// If the builder throws, the resources aquired before it did remain memoized, providing a basic guarantee of exception safety.
+		inline std::vector<std::shared_ptr<const resource_t>> aquire_many(tt::slice<const key_t> keys);
 
 
 		// Instructs the memoized resource pool to insert resource into the pool, using the pool's builder to get a key for it, discarding any current entry in the pool.
@@ -202,33 +342,103 @@ namespace tt {
 
 		// Instructs the memoized resource pool to discard any memoized data associated with key.
 		// Fails quietly if there is no data to discard.
-		inline void discard(const key_t& key) { _resources.erase(key); }
+		template<typename K = key_t>
+		inline void discard(const key_arg_t<K>& key);
 
 		// Resets the internal state of the memoized resource pool.
-		inline void reset() noexcept { _resources.clear(); }
+		// This does not reset the pool's capacity limits, nor its counters.
+		inline void reset() noexcept;
 
 
 	private:
 
-		builder_t		_builder;
-		unordered_map_t	_resources;
+		static constexpr tt_bool _IS_FLAT = _tt::memoized_pool_is_flat<map_t, key_t>::value;
+
+		// NOTE: the number of keys aquire_many hashes, and prefetches the lookups of, at once
+
+		static constexpr tt_size _BATCH = 16;
+
+		builder_t					_builder;
+		map_t						_resources;
+		eviction_t					_eviction;
+		tt_size						_max_entries	= tt::max_of<tt_size>;
+		tt_size						_max_weight		= tt::max_of<tt_size>;
+		tt_size						_weight			= 0;
+		tt::memoized_pool_stats		_stats			= {};
+
+
+		inline tt_size _weight_of(const resource_t& resource) const noexcept {
+
+
+			if constexpr (HAS_WEIGHTS)
+				return _builder.get_weight(resource);
+			else
+				return 1;
+		}
+
+		// NOTE: builders take keys, so this builds one from key, if key isn't one already
+
+		template<typename K>
+		static inline decltype(auto) _as_key(const K& key) {
+
+
+			if constexpr (std::is_same_v<K, key_t>)
+				return (key);
+			else
+				return key_t(key);
+		}
+
+		inline void _evict_to_fit(tt_size entries, tt_size weight, tt_size uncounted = 0);
+
+		template<typename K>
+		inline std::shared_ptr<const resource_t> _aquire_ptr_flat(const K& key, tt_size hash);
+
+		inline void _emplace(std::shared_ptr<const resource_t> resource);
 	};
 
 
-	template<typename Key, typename Resource, typename Builder>
-	inline typename memoized_pool<Key, Resource, Builder>::this_t& memoized_pool<Key, Resource, Builder>::operator=(this_t&& rhs) noexcept {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline typename memoized_pool<Key, Resource, Builder, Map, Eviction>::this_t& memoized_pool<Key, Resource, Builder, Map, Eviction>::operator=(this_t&& rhs) noexcept {
 
 
 		TT_SELF_MOVE_TEST(rhs);
 
 		TT_MOVE(_builder, rhs);
 		TT_MOVE(_resources, rhs);
+		TT_MOVE(_eviction, rhs);
+		TT_COPY(_max_entries, rhs);
+		TT_COPY(_max_weight, rhs);
+		TT_COPY(_weight, rhs);
+		TT_COPY(_stats, rhs);
 
 		TT_RETURN_THIS;
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline const typename memoized_pool<Key, Resource, Builder>::resource_t* memoized_pool<Key, Resource, Builder>::fetch(const key_t& key) const {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::set_max_entries(tt_size n) {
+
+
+		static_assert(eviction_t::ENABLED, "tt::memoized_pool capacity limits require an enabled eviction policy!");
+
+		_max_entries = n;
+
+		_evict_to_fit(0, 0);
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::set_max_weight(tt_size n) {
+
+
+		static_assert(eviction_t::ENABLED, "tt::memoized_pool capacity limits require an enabled eviction policy!");
+
+		_max_weight = n;
+
+		_evict_to_fit(0, 0);
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t* memoized_pool<Key, Resource, Builder, Map, Eviction>::fetch(const key_arg_t<K>& key) const {
 
 
 		const auto ff = _resources.find(key);
@@ -239,8 +449,9 @@ namespace tt {
 			return nullptr;
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline std::shared_ptr<const typename memoized_pool<Key, Resource, Builder>::resource_t> memoized_pool<Key, Resource, Builder>::fetch_ptr(const key_t& key) const {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline std::shared_ptr<const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t> memoized_pool<Key, Resource, Builder, Map, Eviction>::fetch_ptr(const key_arg_t<K>& key) const {
 
 
 		const auto ff = _resources.find(key);
@@ -251,11 +462,12 @@ namespace tt {
 			return nullptr;
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline const typename memoized_pool<Key, Resource, Builder>::resource_t& memoized_pool<Key, Resource, Builder>::aquire(const key_t& key) {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t& memoized_pool<Key, Resource, Builder, Map, Eviction>::aquire(const key_arg_t<K>& key) {
 
 
-		const auto _aquired = aquire_ptr(key);
+		const auto _aquired = aquire_ptr<K>(key);
 
 		tt_assert(_aquired);
 
@@ -264,64 +476,328 @@ namespace tt {
 		return r;
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline std::shared_ptr<const typename memoized_pool<Key, Resource, Builder>::resource_t> memoized_pool<Key, Resource, Builder>::aquire_ptr(const key_t& key) {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline std::shared_ptr<const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t> memoized_pool<Key, Resource, Builder, Map, Eviction>::aquire_ptr(const key_arg_t<K>& key) {
+
+
+		if constexpr (_IS_FLAT)
+			return _aquire_ptr_flat(key, _resources.hash_of(key));
+
+		else {
+
+
+			const auto ff = _resources.find(key);
+
+			if (ff != _resources.end()) {
+
 
+				++_stats.hits;
 
-		auto ff = fetch_ptr(key);
+				if constexpr (eviction_t::ENABLED)
+					_eviction.on_access(ff->first);
 
-		if (!ff) {
+				return ff->second;
+			}
 
+			++_stats.misses;
 
 			// NOTE: if this throws, the method's execution up to here means we'll provide a strong guarantee,
 			//		 with the builder in turn being expected to provide a basic guarantee for its internal state
 
-			auto res = _builder.get_resource(key);
+			auto res = _builder.get_resource(_as_key(key));
 
 			// NOTE: this may throw too, but res should be destroyed properly, so we're still providing
 			//		 a strong guarantee on our end
 
-			auto _shared = std::make_shared<const Resource>(std::move(res));
+			std::shared_ptr<const resource_t> _shared = std::make_shared<const Resource>(std::move(res));
 
 			tt_assert(_shared);
 
-			// NOTE: this get_key usage here is to ensure that our _resource entry is made with a key object
-			//		 who's lifetime will match or exceed *_shared's lifetime (such as when the key is a memory-view
-			//		 object who's validity is tied to the memory of the object of its entry)
+			// NOTE: unlike _emplace, the lookup above has already shown there's no entry to discard, so the
+			//		 entry is made via a single try_emplace, with its key gotten from the resource (see _emplace),
+			//		 which is why it can't be made up front, before the resource is built, as with lazy_emplace
 
-			_resources[_builder.get_key(*_shared)] = std::move(_shared);
+			const auto _key = _builder.get_key(*_shared);
 
-			ff = fetch_ptr(key);
-		}
+			if constexpr (eviction_t::ENABLED) {
+
+
+				const tt_size _resource_weight = _weight_of(*_shared);
+
+				_evict_to_fit(1, _resource_weight);
+
+				const auto _result = _resources.try_emplace(_key, _shared);
+
+				tt_assert(_result.second);
+
+				try {
+
+
+					_eviction.on_insert(_key);
+				}
+				catch (...) {
+
+
+					_resources.erase(_result.first);
+
+					throw;
+				}
 
-		tt_assert(ff);
+				_weight += _resource_weight;
+			}
+			else
+				_resources.try_emplace(_key, _shared);
 
-		return ff;
+			return _shared;
+		}
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline void memoized_pool<Key, Resource, Builder>::insert(resource_t resource) {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline std::vector<std::shared_ptr<const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t>> memoized_pool<Key, Resource, Builder, Map, Eviction>::aquire_many(tt::slice<const key_t> keys) {
 
 
-		const auto _key = _builder.get_key(resource);
+		std::vector<std::shared_ptr<const resource_t>> r;
 
-		discard(_key);
+		r.reserve(keys.size());
+
+		if constexpr (_IS_FLAT) {
+
+
+			// NOTE: the prefetches are only hints, so they remain correct even if building a resource
+			//		 of the batch grows the map, or evicts entries, before the later lookups of the batch
+
+			tt_size _hashes[_BATCH];
+
+			for (tt_size i = 0; i < keys.size(); i += _BATCH) {
+
+
+				const tt_size _n = tt::min(_BATCH, keys.size() - i);
+
+				TT_FOR(j, _n) {
+
+
+					_hashes[j] = _resources.hash_of(keys[i + j]);
 
-		_resources[_key] = std::make_shared<const Resource>(std::move(resource));
+					_resources.prefetch(_hashes[j]);
+				}
+
+				TT_FOR(j, _n)
+					r.push_back(_aquire_ptr_flat(keys[i + j], _hashes[j]));
+			}
+		}
+		else {
+
+
+			TT_FOR_RANGE(i, keys)
+				r.push_back(aquire_ptr(i));
+		}
+
+		return r;
 	}
 
-	template<typename Key, typename Resource, typename Builder>
-	inline void memoized_pool<Key, Resource, Builder>::insert(std::shared_ptr<resource_t> resource) {
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::insert(resource_t resource) {
+
+
+		_emplace(std::make_shared<const Resource>(std::move(resource)));
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::insert(std::shared_ptr<resource_t> resource) {
 
 
 		if (!resource)
 			return;
 
+		_emplace(std::move(resource));
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::discard(const key_arg_t<K>& key) {
+
+
+		if constexpr (eviction_t::ENABLED) {
+
+
+			const auto ff = _resources.find(key);
+
+			if (ff == _resources.end())
+				return;
+
+			_eviction.on_erase(ff->first);
+
+			_weight -= _weight_of(*ff->second);
+
+			_resources.erase(ff);
+		}
+		else
+			_resources.erase(key);
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::reset() noexcept {
+
+
+		_resources.clear();
+		_eviction.clear();
+		_weight = 0;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::_evict_to_fit(tt_size entries, tt_size weight, tt_size uncounted) {
+
+
+		// NOTE: evicts resources until entries more resources, of weight more weight, would fit in the pool,
+		//		 with resources still held elsewhere via shared pointers remaining valid
+		
+		// NOTE: uncounted is the number of entries already in the map, which the eviction policy, and the
+		//		 pool's weight, don't yet know of, and which are thus neither evictable nor counted
+
+		if constexpr (eviction_t::ENABLED) {
+
+
+			while (
+				resources() > uncounted &&
+				(resources() - uncounted > _max_entries - tt::min(entries, _max_entries) ||
+				_weight > _max_weight - tt::min(weight, _max_weight))) {
+
+
+				// NOTE: the victim's entry is erased via an iterator, rather than via its key, as the key
+				//		 may be a memory-view object of the resource being erased
+
+				const key_t _victim = _eviction.evict();
+
+				const auto ff = _resources.find(_victim);
+
+				tt_assert(ff != _resources.end());
+
+				_weight -= _weight_of(*ff->second);
+
+				_resources.erase(ff);
+
+				++_stats.evictions;
+			}
+		}
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	template<typename K>
+	inline std::shared_ptr<const typename memoized_pool<Key, Resource, Builder, Map, Eviction>::resource_t> memoized_pool<Key, Resource, Builder, Map, Eviction>::_aquire_ptr_flat(const K& key, tt_size hash) {
+
+
+		// NOTE: the resource is only built, and its entry constructed, if the lookup misses, with the entry's
+		//		 key being gotten from the resource, as with _emplace, and if the builder throws, no entry is made
+
+		std::shared_ptr<const resource_t> _shared = nullptr;
+
+		const auto _result = _resources.lazy_emplace(key, hash, [&](auto& construct) {
+
+
+			++_stats.misses;
+
+			auto res = _builder.get_resource(_as_key(key));
+
+			_shared = std::make_shared<const resource_t>(std::move(res));
+
+			construct(_builder.get_key(*_shared), _shared);
+		});
+
+		if (!_result.second) {
+
+
+			++_stats.hits;
+
+			if constexpr (eviction_t::ENABLED)
+				_eviction.on_access(_result.first->first);
+
+			return _result.first->second;
+		}
+
+		tt_assert(_shared);
+
+		if constexpr (eviction_t::ENABLED) {
+
+
+			// NOTE: the new entry is already in the map, so it's excluded from the eviction which makes
+			//		 room for it, and being unknown to the eviction policy, it cannot be chosen for it
+
+			const auto _key = _builder.get_key(*_shared);
+			const tt_size _resource_weight = _weight_of(*_shared);
+
+			_evict_to_fit(1, _resource_weight, 1);
+
+			try {
+
+
+				_eviction.on_insert(_key);
+			}
+			catch (...) {
+
+
+				_resources.erase(_resources.find(_key));
+
+				throw;
+			}
+
+			_weight += _resource_weight;
+		}
+
+		return _shared;
+	}
+
+	template<typename Key, typename Resource, typename Builder, typename Map, typename Eviction>
+	inline void memoized_pool<Key, Resource, Builder, Map, Eviction>::_emplace(std::shared_ptr<const resource_t> resource) {
+
+
+		tt_assert(resource);
+
+		// NOTE: this get_key usage here is to ensure that our _resource entry is made with a key object
+		//		 who's lifetime will match or exceed *resource's lifetime (such as when the key is a memory-view
+		//		 object who's validity is tied to the memory of the object of its entry)
+
 		const auto _key = _builder.get_key(*resource);
 
 		discard(_key);
 
-		_resources[_key] = std::move(resource);
+		if constexpr (eviction_t::ENABLED) {
+
+
+			const tt_size _resource_weight = _weight_of(*resource);
+
+			_evict_to_fit(1, _resource_weight);
+
+			_resources[_key] = std::move(resource);
+
+			try {
+
+
+				_eviction.on_insert(_key);
+			}
+			catch (...) {
+
+
+				_resources.erase(_resources.find(_key));
+
+				throw;
+			}
+
+			_weight += _resource_weight;
+		}
+		else
+			_resources[_key] = std::move(resource);
 	}
-}
 
+
+	// A memoized pool which stores its entries in a tt::flat_hash_map, rather than a std::unordered_map.
+	// If Hash and KeyEqual are transparent (ie. tt::str_hash and tt::str_equal) the pool supports heterogeneous lookup.
+	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	using flat_memoized_pool = tt::memoized_pool<Key, Resource, Builder, tt::flat_hash_map<Key, std::shared_ptr<const Resource>, Hash, KeyEqual>>;
+
+	// A memoized pool of bounded capacity, which evicts resources according to the eviction policy Eviction.
+	// Its capacity limits are set via set_max_entries and/or set_max_weight.
+	// Its template parameters are those of tt::memoized_pool, differing only in that Eviction defaults to tt::lru_eviction, using the hasher and key_equal of Map.
+	template<typename Key, typename Resource, typename Builder = naive_builder<Key, Resource>, typename Map = std::unordered_map<Key, std::shared_ptr<const Resource>>, typename Eviction = tt::lru_eviction<Key, typename Map::hasher, typename Map::key_equal>>
+	using bounded_memoized_pool = tt::memoized_pool<Key, Resource, Builder, Map, Eviction>;
+}
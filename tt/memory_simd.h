@@ -0,0 +1,1251 @@
+
+
+#pragma once
+
+
+// A header file defining the SIMD kernels underlying the memory access functions of memory_util.h.
+
+// Kernels are provided for SSE2 and AVX2 (on x86), and NEON (on ARM64), with the best instruction
+// set supported by the CPU being selected once, at runtime, via CPUID.
+
+// Defining TT_CONFIG_NO_SIMD disables these kernels, leaving only their scalar fallbacks.
+
+
+#include <cstring>
+#include <type_traits>
+
+#include "aliases.h"
+#include "compiler_detect.h"
+#include "macros.h"
+
+// NOTE: the bit scan intrinsics used by simd_ctz and simd_ctz64 are needed on every MSVC target, SIMD or not
+
+#if defined(TT_COMPILER_IS_MSVC)
+#include <intrin.h>
+#endif
+
+
+#if !defined(TT_CONFIG_NO_SIMD)
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _TT_SIMD_X86 1
+#include <immintrin.h>
+#if !defined(TT_COMPILER_IS_MSVC)
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define _TT_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+// NOTE: AVX2 kernels must be compiled for AVX2 on GCC/clang, without the rest of the program being so
+
+#if defined(TT_COMPILER_IS_MSVC)
+#define _TT_TARGET_AVX2
+#else
+#define _TT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// NOTE: the null terminator scans read whole aligned vectors, which may extend past the end of
+//		 the string, but never past the end of its page, which address sanitizers can't know
+
+#if defined(TT_COMPILER_IS_MSVC)
+#define _TT_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#else
+#define _TT_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+
+
+namespace tt {
+
+
+	// An enumeration of SIMD instruction sets known to the Tirous Toolbox library.
+	enum class simd_level : tt_byte {
+
+		NONE,
+		SSE2,
+		AVX2,
+		NEON,
+	};
+
+	// Returns the SIMD instruction set used by the Tirous Toolbox library's SIMD kernels.
+	// This is the best instruction set supported by both the CPU and the compilation, detected once at runtime.
+	inline tt::simd_level current_simd_level() noexcept;
+}
+
+namespace _tt {
+
+
+	// NOTE: the bytes below which the kernels aren't worth their setup, and scalar loops are used instead
+
+	constexpr tt_size SIMD_MIN_BYTES = 16;
+
+	// NOTE: the bytes ahead of the current position at which the streaming copies prefetch
+
+	constexpr tt_size SIMD_PREFETCH_DISTANCE = 512;
+
+	// NOTE: the most elements a set searched for may have for its elements to be compared against in
+	//		 vector registers, with larger sets being searched for by the scalar kernels
+
+	constexpr tt_size SIMD_MAX_SET = 16;
+
+	// NOTE: the kernels compare values bytewise, so may only be used with scalar types whose values are equal
+	//		 only if their bytes are (ie. integers, characters, enums and pointers, but not floats), and never with
+	//		 class types, as their operator== may well ignore some of their bytes
+
+	template<typename Value>
+	constexpr tt_bool simd_bytewise_comparable = std::is_scalar_v<Value> && std::has_unique_object_representations_v<Value>;
+
+	template<typename Value>
+	constexpr tt_bool simd_width_supported = simd_bytewise_comparable<Value> && (sizeof(Value) == 1 || sizeof(Value) == 2 || sizeof(Value) == 4);
+
+	template<tt_size Width>
+	using simd_elem_t = std::conditional_t<Width == 1, tt_uint8, std::conditional_t<Width == 2, tt_uint16, tt_uint32>>;
+
+	template<tt_size Width>
+	using simd_uint_t = std::conditional_t<Width == 2, tt_uint16, std::conditional_t<Width == 4, tt_uint32, tt_uint64>>;
+
+	// NOTE: returns the bits of a 1, 2 or 4 byte value, as the kernels below compare them
+
+	template<typename Value>
+	inline tt_uint32 simd_value_bits(const Value& x) noexcept {
+
+
+		static_assert(sizeof(Value) == 1 || sizeof(Value) == 2 || sizeof(Value) == 4);
+
+		_tt::simd_elem_t<sizeof(Value)> r{};
+
+		std::memcpy(&r, &x, sizeof(Value));
+
+		return (tt_uint32)r;
+	}
+
+	// NOTE: comparison masks have one bit per byte (x86) or four bits per byte (NEON), and so masking them
+	//		 with these leaves one bit per element, marking where each element starts
+
+	template<tt_size Width>
+	constexpr tt_uint32 simd_start_bits_x86 = Width == 1 ? 0xffffffffu : Width == 2 ? 0x55555555u : 0x11111111u;
+
+	template<tt_size Width>
+	constexpr tt_uint64 simd_start_bits_neon = Width == 1 ? 0x1111111111111111u : Width == 2 ? 0x0101010101010101u : 0x0001000100010001u;
+
+	inline tt_uint32 simd_ctz(tt_uint32 x) noexcept {
+
+
+#if defined(TT_COMPILER_IS_MSVC)
+		unsigned long r = 0;
+
+		_BitScanForward(&r, x);
+
+		return (tt_uint32)r;
+#else
+		return (tt_uint32)__builtin_ctz(x);
+#endif
+	}
+
+	inline tt_uint32 simd_ctz64(tt_uint64 x) noexcept {
+
+
+#if defined(TT_COMPILER_IS_MSVC) && (defined(_M_IX86) || defined(_M_ARM))
+		// NOTE: 32-bit targets lack _BitScanForward64, so scan each half in turn
+
+		unsigned long r = 0;
+
+		if (_BitScanForward(&r, (unsigned long)x))
+			return (tt_uint32)r;
+
+		_BitScanForward(&r, (unsigned long)(x >> 32));
+
+		return (tt_uint32)r + 32;
+#elif defined(TT_COMPILER_IS_MSVC)
+		unsigned long r = 0;
+
+		_BitScanForward64(&r, x);
+
+		return (tt_uint32)r;
+#else
+		return (tt_uint32)__builtin_ctzll(x);
+#endif
+	}
+
+
+	template<tt_size Width>
+	inline _tt::simd_uint_t<Width> byteswap(_tt::simd_uint_t<Width> x) noexcept {
+
+
+#if defined(TT_COMPILER_IS_MSVC)
+		if constexpr (Width == 2)
+			return _byteswap_ushort(x);
+		else if constexpr (Width == 4)
+			return _byteswap_ulong(x);
+		else
+			return _byteswap_uint64(x);
+#else
+		if constexpr (Width == 2)
+			return __builtin_bswap16(x);
+		else if constexpr (Width == 4)
+			return __builtin_bswap32(x);
+		else
+			return __builtin_bswap64(x);
+#endif
+	}
+
+
+	// scalar kernels (n is measured in bytes, unless otherwise specified)
+
+	inline tt_size simd_mismatch_scalar(const tt_byte* x, const tt_byte* y, tt_size n) noexcept {
+
+
+		TT_FOR(i, n)
+			if (x[i] != y[i])
+				return i;
+
+		return n;
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_find_scalar(const tt_byte* x, tt_uint32 v, tt_size n) noexcept {
+
+
+		for (tt_size i = 0; i < n; i += Width) {
+
+
+			_tt::simd_elem_t<Width> _elem{};
+
+			std::memcpy(&_elem, x + i, Width);
+
+			if (_elem == (_tt::simd_elem_t<Width>)v)
+				return i;
+		}
+
+		return n;
+	}
+
+	// NOTE: max is measured in elements, and the value returned is also
+
+	template<tt_size Width>
+	inline tt_size simd_measure_scalar(const tt_byte* x, tt_uint32 v, tt_size max) noexcept {
+
+
+		const auto _x = (const _tt::simd_elem_t<Width>*)x;
+
+		TT_FOR(i, max)
+			if (_x[i] == (_tt::simd_elem_t<Width>)v)
+				return i;
+
+		return max;
+	}
+
+	// NOTE: pattern is 32 bytes of the value being filled, repeated, and n is a multiple of its size
+
+	inline void simd_fill_scalar(tt_byte* x, const tt_byte* pattern, tt_size n) noexcept {
+
+
+		tt_size i = 0;
+
+		for (; i + 32 <= n; i += 32)
+			std::memcpy(x + i, pattern, 32);
+
+		std::memcpy(x + i, pattern, n - i);
+	}
+
+	// NOTE: reverses the bytes of each of the n (not bytes!) Width byte elements of from, into to,
+	//		 which may be equal to from (but must not otherwise overlap it)
+
+	template<tt_size Width>
+	inline void simd_flip_scalar(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		TT_FOR(i, n) {
+
+
+			_tt::simd_uint_t<Width> _elem{};
+
+			std::memcpy(&_elem, from + i * Width, Width);
+
+			_elem = _tt::byteswap<Width>(_elem);
+
+			std::memcpy(to + i * Width, &_elem, Width);
+		}
+	}
+
+	// NOTE: without non-temporal stores, the streaming copies are just std::memcpy
+
+	inline void simd_stream_copy_scalar(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		std::memcpy(to, from, n);
+	}
+
+	// NOTE: searches for the first of the m (in bytes) bytes of set, in which each Width byte element is a
+	//		 member of the set, with single byte sets being searched for via a bitmap of the set
+
+	template<tt_size Width>
+	inline tt_size simd_find_any_scalar(const tt_byte* x, tt_size n, const tt_byte* set, tt_size m) noexcept {
+
+
+		if constexpr (Width == 1) {
+
+
+			tt_uint64 _table[4]{};
+
+			TT_FOR(j, m)
+				_table[set[j] >> 6] |= (tt_uint64)1 << (set[j] & 63);
+
+			TT_FOR(i, n)
+				if ((_table[x[i] >> 6] >> (x[i] & 63)) & 1)
+					return i;
+
+			return n;
+		}
+		else {
+
+
+			for (tt_size i = 0; i < n; i += Width)
+				for (tt_size j = 0; j < m; j += Width)
+					if (std::memcmp(x + i, set + j, Width) == 0)
+						return i;
+
+			return n;
+		}
+	}
+
+	// NOTE: searches for the first occurrence of the m (in bytes) bytes of y, with m being no greater than n
+
+	template<tt_size Width>
+	inline tt_size simd_search_scalar(const tt_byte* x, tt_size n, const tt_byte* y, tt_size m) noexcept {
+
+
+		for (tt_size i = 0; i + m <= n; i += Width)
+			if (std::memcmp(x + i, y, Width) == 0 && std::memcmp(x + i, y, m) == 0)
+				return i;
+
+		return n;
+	}
+
+	// NOTE: returns the bits of the element of x at byte index i, as the kernels below compare them
+
+	template<tt_size Width>
+	inline tt_uint32 simd_elem_bits(const tt_byte* x, tt_size i) noexcept {
+
+
+		_tt::simd_elem_t<Width> r{};
+
+		std::memcpy(&r, x + i, Width);
+
+		return (tt_uint32)r;
+	}
+
+	// NOTE: the bytes of the needle between its first and last elements, which are compared by the
+	//		 kernels below only once both its first and last elements match
+
+	template<tt_size Width>
+	inline tt_size simd_search_middle(tt_size m) noexcept {
+
+
+		return m > Width * 2 ? m - Width * 2 : 0;
+	}
+
+#if defined(_TT_SIMD_X86)
+
+	// SSE2 kernels
+
+	template<tt_size Width>
+	inline tt_uint32 simd_eq_mask_sse2(__m128i x, __m128i y) noexcept {
+
+
+		if constexpr (Width == 1)
+			return (tt_uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+		else if constexpr (Width == 2)
+			return (tt_uint32)_mm_movemask_epi8(_mm_cmpeq_epi16(x, y));
+		else
+			return (tt_uint32)_mm_movemask_epi8(_mm_cmpeq_epi32(x, y));
+	}
+
+	template<tt_size Width>
+	inline __m128i simd_splat_sse2(tt_uint32 v) noexcept {
+
+
+		if constexpr (Width == 1)
+			return _mm_set1_epi8((char)v);
+		else if constexpr (Width == 2)
+			return _mm_set1_epi16((short)v);
+		else
+			return _mm_set1_epi32((int)v);
+	}
+
+	inline tt_size simd_mismatch_sse2(const tt_byte* x, const tt_byte* y, tt_size n) noexcept {
+
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _mask = _tt::simd_eq_mask_sse2<1>(_mm_loadu_si128((const __m128i*)(x + i)), _mm_loadu_si128((const __m128i*)(y + i))) ^ 0xffffu;
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_mismatch_scalar(x + i, y + i, n - i);
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_find_sse2(const tt_byte* x, tt_uint32 v, tt_size n) noexcept {
+
+
+		const auto _v = _tt::simd_splat_sse2<Width>(v);
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _mask = _tt::simd_eq_mask_sse2<Width>(_mm_loadu_si128((const __m128i*)(x + i)), _v);
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_find_scalar<Width>(x + i, v, n - i);
+	}
+
+	template<tt_size Width>
+	_TT_NO_SANITIZE_ADDRESS inline tt_size simd_measure_sse2(const tt_byte* x, tt_uint32 v, tt_size max) noexcept {
+
+
+		const auto _v = _tt::simd_splat_sse2<Width>(v);
+
+		// NOTE: aligned loads never cross a page boundary, so reading whole vectors is safe
+
+		auto _block = (const tt_byte*)((tt_uintptr)x & ~(tt_uintptr)15);
+
+		auto _mask = _tt::simd_eq_mask_sse2<Width>(_mm_load_si128((const __m128i*)_block), _v) & (0xffffu << (tt_uint32)(x - _block));
+
+		while (!_mask) {
+
+
+			_block += 16;
+
+			if ((tt_size)(_block - x) / Width >= max)
+				return max;
+
+			_mask = _tt::simd_eq_mask_sse2<Width>(_mm_load_si128((const __m128i*)_block), _v);
+		}
+
+		const auto r = (tt_size)(_block + _tt::simd_ctz(_mask) - x) / Width;
+
+		return r < max ? r : max;
+	}
+
+	inline void simd_fill_sse2(tt_byte* x, const tt_byte* pattern, tt_size n) noexcept {
+
+
+		const auto _v = _mm_loadu_si128((const __m128i*)pattern);
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16)
+			_mm_storeu_si128((__m128i*)(x + i), _v);
+
+		std::memcpy(x + i, pattern, n - i);
+	}
+
+	// NOTE: SSE2 lacks a byte shuffle, so bytes are swapped within 16-bit words by shifting, and then
+	//		 the words are shuffled
+
+	template<tt_size Width>
+	inline __m128i simd_flip_vector_sse2(__m128i x) noexcept {
+
+
+		x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+
+		if constexpr (Width == 4)
+			x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xb1), 0xb1);
+		else if constexpr (Width == 8)
+			x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0x1b), 0x1b);
+
+		return x;
+	}
+
+	template<tt_size Width>
+	inline void simd_flip_sse2(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		const auto _bytes = n * Width;
+
+		tt_size i = 0;
+
+		for (; i + 16 <= _bytes; i += 16)
+			_mm_storeu_si128((__m128i*)(to + i), _tt::simd_flip_vector_sse2<Width>(_mm_loadu_si128((const __m128i*)(from + i))));
+
+		_tt::simd_flip_scalar<Width>(from + i, to + i, (_bytes - i) / Width);
+	}
+
+	// NOTE: the streaming copies below prefetch their source ahead of time, and store to their
+	//		 destination with non-temporal stores, which bypass the cache, and so must be aligned
+
+	inline void simd_stream_copy_sse2(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		auto _head = (tt_size)((16 - ((tt_uintptr)to & 15)) & 15);
+
+		if (_head > n)
+			_head = n;
+
+		std::memcpy(to, from, _head);
+
+		tt_size i = _head;
+
+		for (; i + 64 <= n; i += 64) {
+
+
+			_mm_prefetch((const char*)(from + i + _tt::SIMD_PREFETCH_DISTANCE), _MM_HINT_NTA);
+
+			const auto _a = _mm_loadu_si128((const __m128i*)(from + i));
+			const auto _b = _mm_loadu_si128((const __m128i*)(from + i + 16));
+			const auto _c = _mm_loadu_si128((const __m128i*)(from + i + 32));
+			const auto _d = _mm_loadu_si128((const __m128i*)(from + i + 48));
+
+			_mm_stream_si128((__m128i*)(to + i), _a);
+			_mm_stream_si128((__m128i*)(to + i + 16), _b);
+			_mm_stream_si128((__m128i*)(to + i + 32), _c);
+			_mm_stream_si128((__m128i*)(to + i + 48), _d);
+		}
+
+		_mm_sfence();
+
+		std::memcpy(to + i, from + i, n - i);
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_find_any_sse2(const tt_byte* x, tt_size n, const tt_byte* set, tt_size m) noexcept {
+
+
+		__m128i _set[_tt::SIMD_MAX_SET];
+
+		const tt_size _k = m / Width;
+
+		TT_FOR(j, _k)
+			_set[j] = _tt::simd_splat_sse2<Width>(_tt::simd_elem_bits<Width>(set, j * Width));
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _x = _mm_loadu_si128((const __m128i*)(x + i));
+
+			tt_uint32 _mask = 0;
+
+			TT_FOR(j, _k)
+				_mask |= _tt::simd_eq_mask_sse2<Width>(_x, _set[j]);
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_find_any_scalar<Width>(x + i, n - i, set, m);
+	}
+
+	// NOTE: this is the 'generic SIMD' substring search, which compares the first and last elements of the
+	//		 needle against those of each candidate position at once, and only compares the rest of the needle
+	//		 at candidates where both match, which (for needles which don't repeat a lot) is rarely
+
+	template<tt_size Width>
+	inline tt_size simd_search_sse2(const tt_byte* x, tt_size n, const tt_byte* y, tt_size m) noexcept {
+
+
+		const auto _first = _tt::simd_splat_sse2<Width>(_tt::simd_elem_bits<Width>(y, 0));
+		const auto _last = _tt::simd_splat_sse2<Width>(_tt::simd_elem_bits<Width>(y, m - Width));
+
+		const auto _middle = _tt::simd_search_middle<Width>(m);
+
+		tt_size i = 0;
+
+		for (; i + m - Width + 16 <= n; i += 16) {
+
+
+			auto _mask =
+				_tt::simd_eq_mask_sse2<Width>(_mm_loadu_si128((const __m128i*)(x + i)), _first) &
+				_tt::simd_eq_mask_sse2<Width>(_mm_loadu_si128((const __m128i*)(x + i + m - Width)), _last) &
+				_tt::simd_start_bits_x86<Width>;
+
+			while (_mask) {
+
+
+				const auto _at = i + _tt::simd_ctz(_mask);
+
+				if (std::memcmp(x + _at + Width, y + Width, _middle) == 0)
+					return _at;
+
+				_mask &= _mask - 1;
+			}
+		}
+
+		return i + _tt::simd_search_scalar<Width>(x + i, n - i, y, m);
+	}
+
+	// AVX2 kernels
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline tt_uint32 simd_eq_mask_avx2(__m256i x, __m256i y) noexcept {
+
+
+		if constexpr (Width == 1)
+			return (tt_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+		else if constexpr (Width == 2)
+			return (tt_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi16(x, y));
+		else
+			return (tt_uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi32(x, y));
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline __m256i simd_splat_avx2(tt_uint32 v) noexcept {
+
+
+		if constexpr (Width == 1)
+			return _mm256_set1_epi8((char)v);
+		else if constexpr (Width == 2)
+			return _mm256_set1_epi16((short)v);
+		else
+			return _mm256_set1_epi32((int)v);
+	}
+
+	_TT_TARGET_AVX2 inline tt_size simd_mismatch_avx2(const tt_byte* x, const tt_byte* y, tt_size n) noexcept {
+
+
+		tt_size i = 0;
+
+		for (; i + 32 <= n; i += 32) {
+
+
+			const auto _mask = ~_tt::simd_eq_mask_avx2<1>(_mm256_loadu_si256((const __m256i*)(x + i)), _mm256_loadu_si256((const __m256i*)(y + i)));
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_mismatch_sse2(x + i, y + i, n - i);
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline tt_size simd_find_avx2(const tt_byte* x, tt_uint32 v, tt_size n) noexcept {
+
+
+		const auto _v = _tt::simd_splat_avx2<Width>(v);
+
+		tt_size i = 0;
+
+		for (; i + 32 <= n; i += 32) {
+
+
+			const auto _mask = _tt::simd_eq_mask_avx2<Width>(_mm256_loadu_si256((const __m256i*)(x + i)), _v);
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_find_sse2<Width>(x + i, v, n - i);
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 _TT_NO_SANITIZE_ADDRESS inline tt_size simd_measure_avx2(const tt_byte* x, tt_uint32 v, tt_size max) noexcept {
+
+
+		const auto _v = _tt::simd_splat_avx2<Width>(v);
+
+		auto _block = (const tt_byte*)((tt_uintptr)x & ~(tt_uintptr)31);
+
+		auto _mask = _tt::simd_eq_mask_avx2<Width>(_mm256_load_si256((const __m256i*)_block), _v) & (0xffffffffu << (tt_uint32)(x - _block));
+
+		while (!_mask) {
+
+
+			_block += 32;
+
+			if ((tt_size)(_block - x) / Width >= max)
+				return max;
+
+			_mask = _tt::simd_eq_mask_avx2<Width>(_mm256_load_si256((const __m256i*)_block), _v);
+		}
+
+		const auto r = (tt_size)(_block + _tt::simd_ctz(_mask) - x) / Width;
+
+		return r < max ? r : max;
+	}
+
+	_TT_TARGET_AVX2 inline void simd_fill_avx2(tt_byte* x, const tt_byte* pattern, tt_size n) noexcept {
+
+
+		const auto _v = _mm256_loadu_si256((const __m256i*)pattern);
+
+		tt_size i = 0;
+
+		for (; i + 32 <= n; i += 32)
+			_mm256_storeu_si256((__m256i*)(x + i), _v);
+
+		std::memcpy(x + i, pattern, n - i);
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline __m256i simd_flip_mask_avx2() noexcept {
+
+
+		// NOTE: vpshufb shuffles within each 128-bit lane, so the mask repeats per lane
+
+		if constexpr (Width == 2)
+			return _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+		else if constexpr (Width == 4)
+			return _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		else
+			return _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline void simd_flip_avx2(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		const auto _mask = _tt::simd_flip_mask_avx2<Width>();
+
+		const auto _bytes = n * Width;
+
+		tt_size i = 0;
+
+		for (; i + 32 <= _bytes; i += 32)
+			_mm256_storeu_si256((__m256i*)(to + i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(from + i)), _mask));
+
+		_tt::simd_flip_sse2<Width>(from + i, to + i, (_bytes - i) / Width);
+	}
+
+	_TT_TARGET_AVX2 inline void simd_stream_copy_avx2(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		auto _head = (tt_size)((32 - ((tt_uintptr)to & 31)) & 31);
+
+		if (_head > n)
+			_head = n;
+
+		std::memcpy(to, from, _head);
+
+		tt_size i = _head;
+
+		for (; i + 64 <= n; i += 64) {
+
+
+			_mm_prefetch((const char*)(from + i + _tt::SIMD_PREFETCH_DISTANCE), _MM_HINT_NTA);
+
+			const auto _a = _mm256_loadu_si256((const __m256i*)(from + i));
+			const auto _b = _mm256_loadu_si256((const __m256i*)(from + i + 32));
+
+			_mm256_stream_si256((__m256i*)(to + i), _a);
+			_mm256_stream_si256((__m256i*)(to + i + 32), _b);
+		}
+
+		_mm_sfence();
+
+		std::memcpy(to + i, from + i, n - i);
+	}
+
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline tt_size simd_find_any_avx2(const tt_byte* x, tt_size n, const tt_byte* set, tt_size m) noexcept {
+
+
+		__m256i _set[_tt::SIMD_MAX_SET];
+
+		const tt_size _k = m / Width;
+
+		TT_FOR(j, _k)
+			_set[j] = _tt::simd_splat_avx2<Width>(_tt::simd_elem_bits<Width>(set, j * Width));
+
+		tt_size i = 0;
+
+		for (; i + 32 <= n; i += 32) {
+
+
+			const auto _x = _mm256_loadu_si256((const __m256i*)(x + i));
+
+			tt_uint32 _mask = 0;
+
+			TT_FOR(j, _k)
+				_mask |= _tt::simd_eq_mask_avx2<Width>(_x, _set[j]);
+
+			if (_mask)
+				return i + _tt::simd_ctz(_mask);
+		}
+
+		return i + _tt::simd_find_any_sse2<Width>(x + i, n - i, set, m);
+	}
+
+	template<tt_size Width>
+	_TT_TARGET_AVX2 inline tt_size simd_search_avx2(const tt_byte* x, tt_size n, const tt_byte* y, tt_size m) noexcept {
+
+
+		const auto _first = _tt::simd_splat_avx2<Width>(_tt::simd_elem_bits<Width>(y, 0));
+		const auto _last = _tt::simd_splat_avx2<Width>(_tt::simd_elem_bits<Width>(y, m - Width));
+
+		const auto _middle = _tt::simd_search_middle<Width>(m);
+
+		tt_size i = 0;
+
+		for (; i + m - Width + 32 <= n; i += 32) {
+
+
+			auto _mask =
+				_tt::simd_eq_mask_avx2<Width>(_mm256_loadu_si256((const __m256i*)(x + i)), _first) &
+				_tt::simd_eq_mask_avx2<Width>(_mm256_loadu_si256((const __m256i*)(x + i + m - Width)), _last) &
+				_tt::simd_start_bits_x86<Width>;
+
+			while (_mask) {
+
+
+				const auto _at = i + _tt::simd_ctz(_mask);
+
+				if (std::memcmp(x + _at + Width, y + Width, _middle) == 0)
+					return _at;
+
+				_mask &= _mask - 1;
+			}
+		}
+
+		return i + _tt::simd_search_sse2<Width>(x + i, n - i, y, m);
+	}
+
+#elif defined(_TT_SIMD_NEON)
+
+	// NEON kernels
+
+	// NOTE: NEON lacks a movemask, so comparison results are narrowed to 4 bits per byte instead
+
+	inline tt_uint64 simd_nibble_mask_neon(uint8x16_t x) noexcept {
+
+
+		return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(x), 4)), 0);
+	}
+
+	template<tt_size Width>
+	inline tt_uint64 simd_eq_mask_neon(uint8x16_t x, uint8x16_t y) noexcept {
+
+
+		if constexpr (Width == 1)
+			return _tt::simd_nibble_mask_neon(vceqq_u8(x, y));
+		else if constexpr (Width == 2)
+			return _tt::simd_nibble_mask_neon(vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(x), vreinterpretq_u16_u8(y))));
+		else
+			return _tt::simd_nibble_mask_neon(vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(x), vreinterpretq_u32_u8(y))));
+	}
+
+	template<tt_size Width>
+	inline uint8x16_t simd_splat_neon(tt_uint32 v) noexcept {
+
+
+		if constexpr (Width == 1)
+			return vdupq_n_u8((tt_uint8)v);
+		else if constexpr (Width == 2)
+			return vreinterpretq_u8_u16(vdupq_n_u16((tt_uint16)v));
+		else
+			return vreinterpretq_u8_u32(vdupq_n_u32(v));
+	}
+
+	inline tt_size simd_mismatch_neon(const tt_byte* x, const tt_byte* y, tt_size n) noexcept {
+
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _mask = ~_tt::simd_eq_mask_neon<1>(vld1q_u8(x + i), vld1q_u8(y + i));
+
+			if (_mask)
+				return i + _tt::simd_ctz64(_mask) / 4;
+		}
+
+		return i + _tt::simd_mismatch_scalar(x + i, y + i, n - i);
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_find_neon(const tt_byte* x, tt_uint32 v, tt_size n) noexcept {
+
+
+		const auto _v = _tt::simd_splat_neon<Width>(v);
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _mask = _tt::simd_eq_mask_neon<Width>(vld1q_u8(x + i), _v);
+
+			if (_mask)
+				return i + _tt::simd_ctz64(_mask) / 4;
+		}
+
+		return i + _tt::simd_find_scalar<Width>(x + i, v, n - i);
+	}
+
+	template<tt_size Width>
+	_TT_NO_SANITIZE_ADDRESS inline tt_size simd_measure_neon(const tt_byte* x, tt_uint32 v, tt_size max) noexcept {
+
+
+		const auto _v = _tt::simd_splat_neon<Width>(v);
+
+		auto _block = (const tt_byte*)((tt_uintptr)x & ~(tt_uintptr)15);
+
+		auto _mask = _tt::simd_eq_mask_neon<Width>(vld1q_u8(_block), _v) & (~(tt_uint64)0 << ((x - _block) * 4));
+
+		while (!_mask) {
+
+
+			_block += 16;
+
+			if ((tt_size)(_block - x) / Width >= max)
+				return max;
+
+			_mask = _tt::simd_eq_mask_neon<Width>(vld1q_u8(_block), _v);
+		}
+
+		const auto r = (tt_size)(_block + _tt::simd_ctz64(_mask) / 4 - x) / Width;
+
+		return r < max ? r : max;
+	}
+
+	inline void simd_fill_neon(tt_byte* x, const tt_byte* pattern, tt_size n) noexcept {
+
+
+		const auto _v = vld1q_u8(pattern);
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16)
+			vst1q_u8(x + i, _v);
+
+		std::memcpy(x + i, pattern, n - i);
+	}
+
+	template<tt_size Width>
+	inline void simd_flip_neon(const tt_byte* from, tt_byte* to, tt_size n) noexcept {
+
+
+		const auto _bytes = n * Width;
+
+		tt_size i = 0;
+
+		for (; i + 16 <= _bytes; i += 16) {
+
+
+			const auto _v = vld1q_u8(from + i);
+
+			if constexpr (Width == 2)
+				vst1q_u8(to + i, vrev16q_u8(_v));
+			else if constexpr (Width == 4)
+				vst1q_u8(to + i, vrev32q_u8(_v));
+			else
+				vst1q_u8(to + i, vrev64q_u8(_v));
+		}
+
+		_tt::simd_flip_scalar<Width>(from + i, to + i, (_bytes - i) / Width);
+	}
+
+
+	template<tt_size Width>
+	inline tt_size simd_find_any_neon(const tt_byte* x, tt_size n, const tt_byte* set, tt_size m) noexcept {
+
+
+		uint8x16_t _set[_tt::SIMD_MAX_SET];
+
+		const tt_size _k = m / Width;
+
+		TT_FOR(j, _k)
+			_set[j] = _tt::simd_splat_neon<Width>(_tt::simd_elem_bits<Width>(set, j * Width));
+
+		tt_size i = 0;
+
+		for (; i + 16 <= n; i += 16) {
+
+
+			const auto _x = vld1q_u8(x + i);
+
+			tt_uint64 _mask = 0;
+
+			TT_FOR(j, _k)
+				_mask |= _tt::simd_eq_mask_neon<Width>(_x, _set[j]);
+
+			if (_mask)
+				return i + _tt::simd_ctz64(_mask) / 4;
+		}
+
+		return i + _tt::simd_find_any_scalar<Width>(x + i, n - i, set, m);
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_search_neon(const tt_byte* x, tt_size n, const tt_byte* y, tt_size m) noexcept {
+
+
+		const auto _first = _tt::simd_splat_neon<Width>(_tt::simd_elem_bits<Width>(y, 0));
+		const auto _last = _tt::simd_splat_neon<Width>(_tt::simd_elem_bits<Width>(y, m - Width));
+
+		const auto _middle = _tt::simd_search_middle<Width>(m);
+
+		tt_size i = 0;
+
+		for (; i + m - Width + 16 <= n; i += 16) {
+
+
+			auto _mask =
+				_tt::simd_eq_mask_neon<Width>(vld1q_u8(x + i), _first) &
+				_tt::simd_eq_mask_neon<Width>(vld1q_u8(x + i + m - Width), _last) &
+				_tt::simd_start_bits_neon<Width>;
+
+			while (_mask) {
+
+
+				const auto _at = i + _tt::simd_ctz64(_mask) / 4;
+
+				if (std::memcmp(x + _at + Width, y + Width, _middle) == 0)
+					return _at;
+
+				_mask &= _mask - 1;
+			}
+		}
+
+		return i + _tt::simd_search_scalar<Width>(x + i, n - i, y, m);
+	}
+
+#endif
+
+
+	inline tt::simd_level detect_simd_level() noexcept {
+
+
+#if defined(_TT_SIMD_X86)
+		// NOTE: AVX2 requires both CPU support (CPUID leaf 7) and OS support for saving YMM registers (OSXSAVE and XCR0)
+
+		tt_uint32 _ecx1 = 0, _ebx7 = 0;
+
+#if defined(TT_COMPILER_IS_MSVC)
+		int _regs[4]{};
+
+		__cpuid(_regs, 0);
+
+		const auto _max_leaf = _regs[0];
+
+		__cpuid(_regs, 1);
+
+		_ecx1 = (tt_uint32)_regs[2];
+
+		if (_max_leaf >= 7) {
+
+
+			__cpuidex(_regs, 7, 0);
+
+			_ebx7 = (tt_uint32)_regs[1];
+		}
+#else
+		unsigned _eax = 0, _ebx = 0, _ecx = 0, _edx = 0;
+
+		if (__get_cpuid(1, &_eax, &_ebx, &_ecx, &_edx))
+			_ecx1 = _ecx;
+
+		if (__get_cpuid_count(7, 0, &_eax, &_ebx, &_ecx, &_edx))
+			_ebx7 = _ebx;
+#endif
+
+		const tt_bool _osxsave = (_ecx1 >> 27) & 1;
+		const tt_bool _avx = (_ecx1 >> 28) & 1;
+		const tt_bool _avx2 = (_ebx7 >> 5) & 1;
+
+		if (_osxsave && _avx && _avx2) {
+
+
+#if defined(TT_COMPILER_IS_MSVC)
+			const auto _xcr0 = (tt_uint64)_xgetbv(0);
+#else
+			tt_uint32 _lo = 0, _hi = 0;
+
+			__asm__ volatile ("xgetbv" : "=a"(_lo), "=d"(_hi) : "c"(0));
+
+			const auto _xcr0 = ((tt_uint64)_hi << 32) | _lo;
+#endif
+
+			if ((_xcr0 & 0x6) == 0x6)
+				return tt::simd_level::AVX2;
+		}
+
+		return tt::simd_level::SSE2;
+#elif defined(_TT_SIMD_NEON)
+		return tt::simd_level::NEON;
+#else
+		return tt::simd_level::NONE;
+#endif
+	}
+
+
+	// dispatchers
+
+	inline tt_size simd_mismatch(const void* x, const void* y, tt_size n) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+		const auto _y = (const tt_byte*)y;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	return _tt::simd_mismatch_avx2(_x, _y, n);
+		case tt::simd_level::SSE2:	return _tt::simd_mismatch_sse2(_x, _y, n);
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	return _tt::simd_mismatch_neon(_x, _y, n);
+#endif
+		default:					return _tt::simd_mismatch_scalar(_x, _y, n);
+		}
+	}
+
+	template<tt_size Width>
+	inline tt_size simd_find(const void* x, tt_uint32 v, tt_size n) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	return _tt::simd_find_avx2<Width>(_x, v, n);
+		case tt::simd_level::SSE2:	return _tt::simd_find_sse2<Width>(_x, v, n);
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	return _tt::simd_find_neon<Width>(_x, v, n);
+#endif
+		default:					return _tt::simd_find_scalar<Width>(_x, v, n);
+		}
+	}
+
+	// NOTE: presumes x is aligned to Width
+
+	template<tt_size Width>
+	inline tt_size simd_measure(const void* x, tt_uint32 v, tt_size max) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	return _tt::simd_measure_avx2<Width>(_x, v, max);
+		case tt::simd_level::SSE2:	return _tt::simd_measure_sse2<Width>(_x, v, max);
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	return _tt::simd_measure_neon<Width>(_x, v, max);
+#endif
+		default:					return _tt::simd_measure_scalar<Width>(_x, v, max);
+		}
+	}
+
+	inline void simd_fill(void* x, const void* pattern, tt_size n) noexcept {
+
+
+		const auto _x = (tt_byte*)x;
+		const auto _pattern = (const tt_byte*)pattern;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	_tt::simd_fill_avx2(_x, _pattern, n); break;
+		case tt::simd_level::SSE2:	_tt::simd_fill_sse2(_x, _pattern, n); break;
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	_tt::simd_fill_neon(_x, _pattern, n); break;
+#endif
+		default:					_tt::simd_fill_scalar(_x, _pattern, n); break;
+		}
+	}
+
+	// NOTE: n is measured in elements, and from may equal to, but must not otherwise overlap it
+
+	template<tt_size Width>
+	inline void simd_flip(const void* from, void* to, tt_size n) noexcept {
+
+
+		static_assert(Width == 2 || Width == 4 || Width == 8);
+
+		const auto _from = (const tt_byte*)from;
+		const auto _to = (tt_byte*)to;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	_tt::simd_flip_avx2<Width>(_from, _to, n); break;
+		case tt::simd_level::SSE2:	_tt::simd_flip_sse2<Width>(_from, _to, n); break;
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	_tt::simd_flip_neon<Width>(_from, _to, n); break;
+#endif
+		default:					_tt::simd_flip_scalar<Width>(_from, _to, n); break;
+		}
+	}
+
+	// NOTE: n is measured in bytes, and from and to must not overlap
+
+	inline void simd_stream_copy(const void* from, void* to, tt_size n) noexcept {
+
+
+		const auto _from = (const tt_byte*)from;
+		const auto _to = (tt_byte*)to;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	_tt::simd_stream_copy_avx2(_from, _to, n); break;
+		case tt::simd_level::SSE2:	_tt::simd_stream_copy_sse2(_from, _to, n); break;
+#endif
+		default:					_tt::simd_stream_copy_scalar(_from, _to, n); break;
+		}
+	}
+
+	// NOTE: n and m are measured in bytes, with m being a multiple of Width, and no greater than n
+
+	template<tt_size Width>
+	inline tt_size simd_search(const void* x, tt_size n, const void* y, tt_size m) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+		const auto _y = (const tt_byte*)y;
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	return _tt::simd_search_avx2<Width>(_x, n, _y, m);
+		case tt::simd_level::SSE2:	return _tt::simd_search_sse2<Width>(_x, n, _y, m);
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	return _tt::simd_search_neon<Width>(_x, n, _y, m);
+#endif
+		default:					return _tt::simd_search_scalar<Width>(_x, n, _y, m);
+		}
+	}
+
+	// NOTE: n and m are measured in bytes, with m being a multiple of Width
+
+	template<tt_size Width>
+	inline tt_size simd_find_any(const void* x, tt_size n, const void* set, tt_size m) noexcept {
+
+
+		const auto _x = (const tt_byte*)x;
+		const auto _set = (const tt_byte*)set;
+
+		if (m / Width > _tt::SIMD_MAX_SET)
+			return _tt::simd_find_any_scalar<Width>(_x, n, _set, m);
+
+		switch (tt::current_simd_level()) {
+#if defined(_TT_SIMD_X86)
+		case tt::simd_level::AVX2:	return _tt::simd_find_any_avx2<Width>(_x, n, _set, m);
+		case tt::simd_level::SSE2:	return _tt::simd_find_any_sse2<Width>(_x, n, _set, m);
+#elif defined(_TT_SIMD_NEON)
+		case tt::simd_level::NEON:	return _tt::simd_find_any_neon<Width>(_x, n, _set, m);
+#endif
+		default:					return _tt::simd_find_any_scalar<Width>(_x, n, _set, m);
+		}
+	}
+}
+
+namespace tt {
+
+
+	inline tt::simd_level current_simd_level() noexcept {
+
+
+		static const tt::simd_level _level = _tt::detect_simd_level();
+
+		return _level;
+	}
+}
@@ -11,6 +11,7 @@
 
 #include "numeric_limits.h"
 #include "math_util.h"
+#include "memory_simd.h"
 
 
 namespace tt {
@@ -20,6 +21,7 @@ namespace tt {
 	// Measuring stops prematurely if max_length is reached, at which point max_length will be returned.
 	// Returns zero if x is nullptr.
 	// On 64-bit systems the default max_length is functionally infinite for all intents and purposes.
+	// At runtime, 1, 2 and 4 byte characters are scanned using SIMD kernels.
 	template<typename Char>
 	constexpr tt_size measure_cstr(const Char* const x, tt_size max_length = tt::max_size, Char null_terminator = (Char)0) noexcept {
 
@@ -27,6 +29,13 @@ namespace tt {
 		if (!(x))
 			return 0;
 
+		if constexpr (_tt::simd_width_supported<Char>) {
+
+
+			if (!TT_IS_CONSTANT_EVALUATED() && (tt_uintptr)x % sizeof(Char) == 0)
+				return _tt::simd_measure<sizeof(Char)>(x, _tt::simd_value_bits(null_terminator), max_length);
+		}
+
 		TT_FOR(i, max_length)
 			if (x[i] == null_terminator)
 				return i;
@@ -45,7 +54,19 @@ namespace tt {
 		static_assert(sizeof(Value) > 0);
 		static_assert((sizeof(Value) == 1) || tt::is_even(sizeof(Value)));
 
-		if constexpr (sizeof(Value) > 1) {
+		if constexpr (sizeof(Value) == 2 || sizeof(Value) == 4 || sizeof(Value) == 8) {
+
+
+			_tt::simd_uint_t<sizeof(Value)> _bits{};
+
+			std::memcpy(&_bits, &x, sizeof(Value));
+
+			_bits = _tt::byteswap<sizeof(Value)>(_bits);
+
+			std::memcpy(&x, &_bits, sizeof(Value));
+		}
+
+		else if constexpr (sizeof(Value) > 1) {
 
 
 			tt_byte* xx = (tt_byte*)&x;
@@ -57,6 +78,48 @@ namespace tt {
 		return x;
 	}
 
+	// Copies the n values of array from into array to, reversing the bytes of each.
+	// The arrays may be the same array, but must not otherwise overlap.
+	// If from or to are nullptr, or n is zero, the function fails quietly.
+	// Arrays of 2, 4 and 8 byte values are flipped using bswap or SIMD kernels.
+	// This presumes that Value is trivially copyable.
+	template<typename Value>
+	inline void flip_bytes_copy_n(const Value* const from, Value* const to, tt_size n) noexcept {
+
+
+		static_assert(std::is_trivially_copyable_v<Value>);
+		static_assert(sizeof(Value) > 0);
+		static_assert((sizeof(Value) == 1) || tt::is_even(sizeof(Value)));
+
+		if (!((from) && (to) && (n > 0)))
+			return;
+
+		if constexpr (sizeof(Value) == 1) {
+
+
+			if (from != to)
+				std::memcpy((void*)to, (const void*)from, n);
+		}
+
+		else if constexpr (sizeof(Value) == 2 || sizeof(Value) == 4 || sizeof(Value) == 8)
+			_tt::simd_flip<sizeof(Value)>(from, to, n);
+
+		else
+			TT_FOR(i, n)
+				to[i] = tt::flip_bytes(from[i]);
+	}
+
+	// Reverses the bytes of each of the n values of array x, in place.
+	// If x is nullptr, or n is zero, the function fails quietly.
+	// Arrays of 2, 4 and 8 byte values are flipped using bswap or SIMD kernels.
+	// This presumes that Value is trivially copyable.
+	template<typename Value>
+	inline void flip_bytes_n(Value* const x, tt_size n) noexcept {
+
+
+		tt::flip_bytes_copy_n<Value>(x, x, n);
+	}
+
 
 	// Compares the elements of arrays x and y of size n for equality, returning the number of matches found.
 	// If x or y is nullptr, or n is zero, zero will be returned.
@@ -76,16 +139,135 @@ namespace tt {
 		return r;
 	}
 
+	// Returns the index of the first element at which arrays x and y of size n differ, or n if they do not differ.
+	// If x or y is nullptr, or n is zero, zero will be returned.
+	// At runtime, arrays of scalar types whose values are equal only if their bytes are (ie. integers, but not floats) are compared using SIMD kernels.
+	template<typename Value>
+	constexpr tt_size mismatch_arrays(const Value* const x, const Value* const y, tt_size n) noexcept {
+
+
+		if (!((x) && (y) && (n > 0)))
+			return 0;
+
+		if constexpr (_tt::simd_bytewise_comparable<Value>) {
+
+
+			if (!TT_IS_CONSTANT_EVALUATED() && n * sizeof(Value) >= _tt::SIMD_MIN_BYTES)
+				return _tt::simd_mismatch(x, y, n * sizeof(Value)) / sizeof(Value);
+		}
+
+		TT_FOR(i, n)
+			if (!(x[i] == y[i]))
+				return i;
+
+		return n;
+	}
+
 	// Returns if the contents of arrays x and y are exactly equal.
-	// This is performed via "count_equal_arrays(x, y, n) == n", keep this in mind regarding x and y being nullptr.
+	// This stops at the first element which differs, via tt::mismatch_arrays.
+	// If x or y is nullptr, the arrays are only considered equal if n is zero.
 	template<typename Value>
 	constexpr tt_bool equal_arrays(const Value* const x, const Value* const y, tt_size n) noexcept {
 
 
-		return count_equal_arrays(x, y, n) == n;
+		return n == 0 || tt::mismatch_arrays(x, y, n) == n;
+	}
+
+	// Returns the index of the first element of array x of size n equal to v, or n if there is none.
+	// If x is nullptr, or n is zero, zero will be returned.
+	// At runtime, arrays of 1, 2 and 4 byte scalar types are searched using SIMD kernels.
+	template<typename Value>
+	constexpr tt_size find_in_array(const Value* const x, tt_size n, const Value& v) noexcept {
+
+
+		if (!((x) && (n > 0)))
+			return 0;
+
+		if constexpr (_tt::simd_width_supported<Value>) {
+
+
+			if (!TT_IS_CONSTANT_EVALUATED() && n * sizeof(Value) >= _tt::SIMD_MIN_BYTES)
+				return _tt::simd_find<sizeof(Value)>(x, _tt::simd_value_bits(v), n * sizeof(Value)) / sizeof(Value);
+		}
+
+		TT_FOR(i, n)
+			if (x[i] == v)
+				return i;
+
+		return n;
 	}
 
 
+	// Returns the index of the first element of array x of size n equal to any element of array set of size m, or n if there is none.
+	// If x is nullptr, or n is zero, zero will be returned.
+	// At runtime, arrays of 1, 2 and 4 byte scalar types are searched using SIMD kernels, with sets of many elements being searched for via a bitmap (for 1 byte types) or scalar loop.
+	template<typename Value>
+	constexpr tt_size find_any_in_array(const Value* const x, tt_size n, const Value* const set, tt_size m) noexcept {
+
+
+		if (!((x) && (n > 0)))
+			return 0;
+
+		if (!((set) && (m > 0)))
+			return n;
+
+		if constexpr (_tt::simd_width_supported<Value>) {
+
+
+			if (!TT_IS_CONSTANT_EVALUATED() && n * sizeof(Value) >= _tt::SIMD_MIN_BYTES)
+				return _tt::simd_find_any<sizeof(Value)>(x, n * sizeof(Value), set, m * sizeof(Value)) / sizeof(Value);
+		}
+
+		TT_FOR(i, n)
+			TT_FOR(j, m)
+				if (x[i] == set[j])
+					return i;
+
+		return n;
+	}
+
+	// Returns the index of the first occurrence of array y of size m within array x of size n, or n if there is none.
+	// If m is zero, zero will be returned, and if m is greater than n, n will be returned.
+	// If x is nullptr, or n is zero, zero will be returned.
+	// At runtime, arrays of 1, 2 and 4 byte scalar types are searched using SIMD kernels.
+	template<typename Value>
+	constexpr tt_size search_array(const Value* const x, tt_size n, const Value* const y, tt_size m) noexcept {
+
+
+		if (!((x) && (n > 0)))
+			return 0;
+
+		if (!((y) && (m > 0)))
+			return 0;
+
+		if (m > n)
+			return n;
+
+		if (m == 1)
+			return tt::find_in_array(x, n, *y);
+
+		if constexpr (_tt::simd_width_supported<Value>) {
+
+
+			if (!TT_IS_CONSTANT_EVALUATED() && n * sizeof(Value) >= _tt::SIMD_MIN_BYTES)
+				return _tt::simd_search<sizeof(Value)>(x, n * sizeof(Value), y, m * sizeof(Value)) / sizeof(Value);
+		}
+
+		for (tt_size i = 0; i + m <= n; ++i) {
+
+
+			tt_size j = 0;
+
+			while (j < m && x[i + j] == y[j])
+				++j;
+
+			if (j == m)
+				return i;
+		}
+
+		return n;
+	}
+
 	// A version of tt::copy_block which does not statically assert that Value must be trivially-copyable.
 	// If x or y is nullptr, or n is zero, the function fails quietly.
 	template<typename Value>
@@ -131,15 +313,130 @@ namespace tt {
 	}
 
 
+	// The number of bytes at or above which tt::copy_block_streaming and tt::copy_block_overlap_streaming bypass the cache.
+	// Below this, the destination is presumed likely to be used soon, and so is better off in the cache.
+	constexpr tt_size streaming_copy_threshold = 4 * 1024 * 1024;
+
+	// A version of tt::copy_block which, when copying at least tt::streaming_copy_threshold bytes, uses non-temporal stores and software prefetching.
+	// This avoids large copies evicting the rest of the cache, at the cost of the destination not being cached afterwards.
+	// Where non-temporal stores are unavailable, this is equivalent to tt::copy_block.
+	// If x or y is nullptr, or n is zero, the function fails quietly.
+	// Type Value must be trivially-copyable for this to work.
+	template<typename Value>
+	inline void copy_block_streaming(const Value* const from, Value* const to, tt_size n) {
+
+
+		static_assert(std::is_trivially_copyable_v<Value>, "copy_block_streaming Value must be trivially-copyable!");
+
+		if (n * sizeof(Value) < tt::streaming_copy_threshold)
+			tt::copy_block(from, to, n);
+
+		else if ((from) && (to))
+			_tt::simd_stream_copy(from, to, n * sizeof(Value));
+	}
+
+	// A version of tt::copy_block_overlap which, when copying at least tt::streaming_copy_threshold bytes, uses non-temporal stores and software prefetching.
+	// Overlapping regions are copied in non-overlapping blocks, ordered such that no source byte is overwritten before being copied, unless the regions are too close for this, in which case std::memmove is used.
+	// If x or y is nullptr, or n is zero, the function fails quietly.
+	// Type Value must be trivially-copyable for this to work.
+	template<typename Value>
+	inline void copy_block_overlap_streaming(const Value* const from, Value* const to, tt_size n) {
+
+
+		static_assert(std::is_trivially_copyable_v<Value>, "copy_block_overlap_streaming Value must be trivially-copyable!");
+
+		constexpr tt_size _block = 256 * 1024;
+
+		const auto _bytes = n * sizeof(Value);
+
+		if (_bytes < tt::streaming_copy_threshold || !((from) && (to))) {
+
+
+			tt::copy_block_overlap(from, to, n);
+
+			return;
+		}
+
+		const auto _from = (const tt_byte*)from;
+		const auto _to = (tt_byte*)to;
+
+		const auto _distance = (tt_size)(_from < _to ? _to - _from : _from - _to);
+
+		if (_distance >= _bytes)
+			_tt::simd_stream_copy(_from, _to, _bytes);
+
+		else if (_distance < _block)
+			tt::copy_block_overlap(from, to, n);
+
+		// copying forward, the blocks must be copied back-to-front, and vice versa
+
+		else if (_from < _to) {
+
+
+			for (tt_size i = _bytes; i > 0;) {
+
+
+				const auto _n = i < _distance ? i : _distance;
+
+				i -= _n;
+
+				_tt::simd_stream_copy(_from + i, _to + i, _n);
+			}
+		}
+
+		else {
+
+
+			for (tt_size i = 0; i < _bytes;) {
+
+
+				const auto _n = _bytes - i < _distance ? _bytes - i : _distance;
+
+				_tt::simd_stream_copy(_from + i, _to + i, _n);
+
+				i += _n;
+			}
+		}
+	}
+
+
 	// Sets the elements of array x of length n to v.
 	// If x is nullptr, or n is zero, the function fails quietly.
+	// Arrays of trivially-copyable types whose size divides 32 are filled using std::memset or SIMD kernels.
 	template<typename Value> 
 	inline void fill_array(Value* const x, tt_size n, const Value& v) {
 
 
-		if (x)
-			TT_FOR(i, n)
-				x[i] = v;
+		if (!(x))
+			return;
+
+		if constexpr (std::is_trivially_copyable_v<Value> && sizeof(Value) == 1) {
+
+
+			std::memset((void*)x, (int)_tt::simd_value_bits(v), n);
+
+			return;
+		}
+
+		else if constexpr (std::is_trivially_copyable_v<Value> && 32 % sizeof(Value) == 0) {
+
+
+			if (n * sizeof(Value) >= _tt::SIMD_MIN_BYTES) {
+
+
+				tt_byte _pattern[32];
+
+				TT_FOR(i, 32 / sizeof(Value))
+					std::memcpy(_pattern + i * sizeof(Value), &v, sizeof(Value));
+
+				_tt::simd_fill(x, _pattern, n * sizeof(Value));
+
+				return;
+			}
+		}
+
+		TT_FOR(i, n)
+			x[i] = v;
 	}
 
 	// Adding this little compile-time optimization to use std::memmove when possible,
@@ -0,0 +1,511 @@
+
+
+#pragma once
+
+
+// A class implementing a fixed-size object pool, or 'slab allocator', for objects of a single type.
+
+// Objects are carved out of large 'slabs' of memory, and once released their memory is recycled
+// via a freelist, rather than being returned to the heap. Slabs are only released once the pool
+// itself is destroyed.
+
+// Pools may optionally maintain thread-local caches of free objects, which allow allocation and
+// release to occur without locking. Objects may be released on a different thread than the one
+// which allocated them, with caches returning free objects to the pool's shared 'depot' in batches
+// once they grow too large.
+
+// Pools integrate with the tt::deleter system via tt::object_pool_deleter, allowing pooled objects
+// to be released via tt::invoke_deleter and tt::packaged_deletion.
+
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "math_util.h"
+#include "allocation.h"
+#include "deletion.h"
+#include "placement_construction.h"
+
+
+namespace _tt {
+
+
+	// NOTE: free objects in a pool have their memory reused to store the freelist link
+
+	struct object_pool_node final {
+
+		object_pool_node* next;
+	};
+
+
+	// NOTE: this is the shared state of a tt::object_pool, which owns its slabs, and holds the
+	//		 freelist of objects which aren't in any thread-local cache
+
+	struct object_pool_depot final {
+
+		std::mutex						mtx				= {};
+		object_pool_node*				free_list		= nullptr;
+		tt_size							free_count		= 0;
+		std::vector<tt_byte*>			slab_list		= {};
+		tt_size							slab_size		= 0;
+		tt_size							item_size		= 0;
+		tt_size							item_alignment	= 0;
+		tt_atomic_size					live			= 0;
+		tt_uint64						id				= 0;
+
+		inline ~object_pool_depot() noexcept {
+
+
+			for (auto& I : slab_list)
+				tt::aligned_dealloc_uninit(I);
+		}
+
+		// NOTE: the *_unsafe methods below presume that mtx is locked
+
+		inline void add_slab_unsafe() {
+
+
+			auto _slab = tt::aligned_alloc_uninit<tt_byte>(slab_size * item_size, item_alignment);
+
+			if (!_slab)
+				throw std::bad_alloc();
+
+			slab_list.push_back(_slab);
+
+			// NOTE: link in reverse so the freelist hands objects out in address order
+
+			for (tt_size i = slab_size; i > 0; --i) {
+
+
+				auto _node = (object_pool_node*)(_slab + (i - 1) * item_size);
+
+				_node->next = free_list;
+
+				free_list = _node;
+			}
+
+			free_count += slab_size;
+		}
+
+		// NOTE: pops up to n nodes from the depot, adding slabs as needed, returning the number popped
+
+		inline tt_size take_unsafe(object_pool_node*& head, tt_size n) {
+
+
+			if (free_count == 0)
+				add_slab_unsafe();
+
+			tt_size r = 0;
+
+			while (r < n && free_list) {
+
+
+				auto _node = free_list;
+
+				free_list = _node->next;
+
+				_node->next = head;
+
+				head = _node;
+
+				++r;
+			}
+
+			free_count -= r;
+
+			return r;
+		}
+
+		// NOTE: returns a chain of n nodes, from first to last, to the depot
+
+		inline void give_unsafe(object_pool_node* first, object_pool_node* last, tt_size n) noexcept {
+
+
+			tt_assert(first && last);
+
+			last->next = free_list;
+
+			free_list = first;
+
+			free_count += n;
+		}
+	};
+
+
+	// NOTE: a thread-local cache of free objects for a single pool, which only holds a weak reference
+	//		 to the pool's depot, so that it can safely outlive the pool
+
+	struct object_pool_cache final {
+
+		std::weak_ptr<object_pool_depot>	owner	= {};
+		object_pool_node*					head	= nullptr;
+		tt_size								count	= 0;
+
+		object_pool_cache() = default;
+		object_pool_cache(const object_pool_cache&) = delete;
+
+		inline ~object_pool_cache() noexcept {
+
+
+			// NOTE: return our nodes to the depot if the pool is still alive, otherwise its
+			//		 slabs are already gone and so are our nodes
+
+			if (head)
+				if (auto _depot = owner.lock()) {
+
+
+					auto _last = head;
+
+					while (_last->next)
+						_last = _last->next;
+
+					std::scoped_lock lk(_depot->mtx);
+
+					_depot->give_unsafe(head, _last, count);
+				}
+		}
+	};
+
+	inline tt_uint64 object_pool_next_id() noexcept {
+
+
+		static tt_atomic_uint64 _next_id = 1;
+
+		return _next_id++;
+	}
+
+	// NOTE: returns the calling thread's cache for depot, creating it if needed
+
+	inline object_pool_cache& object_pool_thread_cache(const std::shared_ptr<object_pool_depot>& depot) {
+
+
+		// NOTE: caches are keyed by the depot's unique id, rather than its address, as addresses
+		//		 may be reused by later pools, while ids are never reused
+
+		thread_local std::unordered_map<tt_uint64, object_pool_cache> _caches{};
+
+		thread_local tt_uint64 _last_id = 0;
+		thread_local object_pool_cache* _last_cache = nullptr;
+
+		if (_last_id == depot->id)
+			return *_last_cache;
+
+		// NOTE: when adding a new cache, sweep away those of pools which have since been destroyed
+
+		if (_caches.find(depot->id) == _caches.end()) {
+
+
+			for (auto it = _caches.begin(); it != _caches.end();) {
+
+
+				if (it->second.owner.expired())
+					it = _caches.erase(it);
+				else
+					++it;
+			}
+		}
+
+		auto& r = _caches[depot->id];
+
+		if (r.owner.expired())
+			r.owner = depot;
+
+		_last_id = depot->id;
+		_last_cache = &r;
+
+		return r;
+	}
+}
+
+namespace tt {
+
+
+	// A class implementing a fixed-size object pool, or 'slab allocator', for objects of type Value.
+	// Pools are thread-safe.
+	// Pools are neither copyable nor movable, as the deleter infos of tt::object_pool_deleter refer to them by address.
+	// Objects still alive when the pool is destroyed are not destroyed by it, and their memory is released.
+	template<typename Value>
+	class object_pool final {
+	public:
+
+		using value_t = typename Value;
+
+		using this_t = tt::object_pool<value_t>;
+
+		// The default number of objects in each slab of a pool.
+		static constexpr tt_size DEFAULT_SLAB_SIZE = 256;
+
+
+		// Initializes a pool which allocates slabs of slab_size objects.
+		// If thread_cache_size is non-zero, each thread using the pool keeps a cache of up to thread_cache_size free objects, which it can allocate from and release to without locking.
+		// If thread_cache_size is zero, every allocation and release locks the pool.
+		inline explicit object_pool(tt_size slab_size = DEFAULT_SLAB_SIZE, tt_size thread_cache_size = 0);
+
+		object_pool(const this_t&) = delete;
+		object_pool(this_t&&) = delete;
+
+		~object_pool() noexcept = default;
+
+		this_t& operator=(const this_t&) = delete;
+		this_t& operator=(this_t&&) = delete;
+
+
+		// Returns the number of objects in each slab of the pool.
+		inline tt_size slab_size() const noexcept { return _depot->slab_size; }
+
+		// Returns the maximum number of free objects each thread-local cache of the pool may hold, or zero if caching is disabled.
+		constexpr tt_size thread_cache_size() const noexcept { return _thread_cache_size; }
+
+		// Returns the number of objects currently allocated from the pool.
+		inline tt_size live() const noexcept { return _depot->live; }
+
+		// Returns the number of slabs allocated by the pool.
+		inline tt_size slabs() const;
+
+		// Returns the number of objects the pool's slabs can hold in total.
+		inline tt_size capacity() const { return slabs() * slab_size(); }
+
+
+		// Allocates uninitialized memory for a single Value from the pool.
+		// Throws std::bad_alloc if a new slab is needed but cannot be allocated.
+		inline value_t* allocate();
+
+		// Returns the memory at x, allocated via this pool's allocate, to the pool.
+		// The Value at x is not destroyed.
+		// If x is nullptr, the function fails quietly.
+		inline void deallocate(value_t* x) noexcept;
+
+		// Allocates and constructs a Value from the pool, passing args to its constructor.
+		// If the constructor throws, the memory is returned to the pool before rethrowing.
+		template<typename... Args>
+		inline value_t* make(Args&&... args);
+
+		// Destroys the Value at x, then returns its memory to the pool.
+		// If x is nullptr, the function fails quietly.
+		inline void destroy(value_t* x) noexcept;
+
+
+		// Returns the deleter info with which tt::object_pool_deleter releases objects to this pool.
+		inline tt::deleter_info get_deleter_info() const noexcept;
+
+		// Returns a packaged deletion which, when invoked, destroys x and returns it to this pool.
+		inline tt::packaged_deletion make_deletion(value_t* x) const noexcept;
+
+
+	private:
+
+		std::shared_ptr<_tt::object_pool_depot>	_depot;
+		tt_size									_thread_cache_size;
+	};
+
+
+	// The deleter associated with tt::object_pool.
+	// The deleter info is interpreted as a pointer to the tt::object_pool<Value> which x is to be returned to.
+	template<typename Value>
+	inline void object_pool_deleter(void* x, tt::deleter_info info) noexcept {
+
+
+		tt_assert(info.ptr_value);
+
+		((tt::object_pool<Value>*)info.ptr_value)->destroy((Value*)x);
+	}
+
+
+	template<typename Value>
+	inline tt::object_pool<Value>::object_pool(tt_size slab_size, tt_size thread_cache_size)
+		: _depot(std::make_shared<_tt::object_pool_depot>()),
+		_thread_cache_size(thread_cache_size) {
+
+
+		constexpr tt_size _alignment = tt::max(alignof(value_t), alignof(_tt::object_pool_node));
+
+		_depot->slab_size = slab_size > 0 ? slab_size : DEFAULT_SLAB_SIZE;
+		_depot->item_alignment = _alignment;
+		_depot->item_size = tt::aligned_size<tt_size>(tt::max(sizeof(value_t), sizeof(_tt::object_pool_node)), _alignment);
+		_depot->id = _tt::object_pool_next_id();
+	}
+
+	template<typename Value>
+	inline tt_size tt::object_pool<Value>::slabs() const {
+
+
+		std::scoped_lock lk(_depot->mtx);
+
+		return _depot->slab_list.size();
+	}
+
+	template<typename Value>
+	inline typename object_pool<Value>::value_t* tt::object_pool<Value>::allocate() {
+
+
+		tt_assert(_depot);
+
+		_tt::object_pool_node* _node = nullptr;
+
+		if (_thread_cache_size > 0) {
+
+
+			auto& _cache = _tt::object_pool_thread_cache(_depot);
+
+			// NOTE: refill half the cache at once, so alternating allocate/deallocate calls
+			//		 at the boundary don't bounce nodes back and forth with the depot
+
+			if (!_cache.head) {
+
+
+				std::scoped_lock lk(_depot->mtx);
+
+				_cache.count += _depot->take_unsafe(_cache.head, tt::max<tt_size>(_thread_cache_size / 2, 1));
+			}
+
+			_node = _cache.head;
+
+			_cache.head = _node->next;
+
+			--(_cache.count);
+		}
+
+		else {
+
+
+			std::scoped_lock lk(_depot->mtx);
+
+			_depot->take_unsafe(_node, 1);
+		}
+
+		tt_assert(_node);
+
+		++(_depot->live);
+
+		return (value_t*)_node;
+	}
+
+	template<typename Value>
+	inline void tt::object_pool<Value>::deallocate(value_t* x) noexcept {
+
+
+		tt_assert(_depot);
+
+		if (!x)
+			return;
+
+		--(_depot->live);
+
+		auto _node = (_tt::object_pool_node*)x;
+
+		if (_thread_cache_size > 0) {
+
+
+			// NOTE: if allocating the cache itself fails, fall through to returning x to the depot directly
+
+			_tt::object_pool_cache* _cache = nullptr;
+
+			try {
+
+
+				_cache = &_tt::object_pool_thread_cache(_depot);
+			}
+
+			catch (...) {}
+
+			if (_cache) {
+
+
+				_node->next = _cache->head;
+
+				_cache->head = _node;
+
+				++(_cache->count);
+
+				// NOTE: once the cache overflows, return half of it to the depot in a single batch,
+				//		 which is also how objects released on other threads find their way home
+
+				if (_cache->count > _thread_cache_size) {
+
+
+					const auto _keep = _thread_cache_size / 2;
+					const auto _give = _cache->count - _keep;
+
+					auto _first = _cache->head;
+					auto _last = _first;
+
+					for (tt_size i = 1; i < _give; ++i)
+						_last = _last->next;
+
+					_cache->head = _last->next;
+					_cache->count = _keep;
+
+					std::scoped_lock lk(_depot->mtx);
+
+					_depot->give_unsafe(_first, _last, _give);
+				}
+
+				return;
+			}
+		}
+
+		std::scoped_lock lk(_depot->mtx);
+
+		_depot->give_unsafe(_node, _node, 1);
+	}
+
+	template<typename Value>
+	template<typename... Args>
+	inline typename object_pool<Value>::value_t* tt::object_pool<Value>::make(Args&&... args) {
+
+
+		auto r = allocate();
+
+		try {
+
+
+			tt::construct_at(r, TT_FMOVE_N(Args, args));
+		}
+
+		catch (...) {
+
+
+			deallocate(r);
+
+			TT_RETHROW;
+		}
+
+		return r;
+	}
+
+	template<typename Value>
+	inline void tt::object_pool<Value>::destroy(value_t* x) noexcept {
+
+
+		if (!x)
+			return;
+
+		tt::destroy_at(x);
+
+		deallocate(x);
+	}
+
+	template<typename Value>
+	inline tt::deleter_info tt::object_pool<Value>::get_deleter_info() const noexcept {
+
+
+		tt::deleter_info r{};
+
+		r.ptr_value = (void*)this;
+
+		return r;
+	}
+
+	template<typename Value>
+	inline tt::packaged_deletion tt::object_pool<Value>::make_deletion(value_t* x) const noexcept {
+
+
+		return tt::packaged_deletion::make(tt::object_pool_deleter<value_t>, x, get_deleter_info());
+	}
+}
@@ -0,0 +1,395 @@
+
+
+#pragma once
+
+
+// A header file defining the page-granular memory allocation functions of the Tirous Toolbox library.
+
+// These allocate whole pages directly from the operating system, via mmap (or VirtualAlloc on Windows),
+// and so are kept apart from the rest of allocation.h.
+
+// On Windows, the few functions used are declared here, rather than including <Windows.h>, such that
+// headers which page allocate (ie. aligned_allocator.h) don't impose <Windows.h> upon their users.
+
+
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "aliases.h"
+#include "compiler_detect.h"
+#include "macros.h"
+
+#include "allocation.h"
+
+
+#if defined(_WIN32)
+namespace _tt {
+
+
+#if defined(_WIN64)
+	using win_size_t = unsigned __int64;
+#else
+	using win_size_t = unsigned long;
+#endif
+
+	constexpr unsigned long WIN_MEM_COMMIT = 0x00001000;
+	constexpr unsigned long WIN_MEM_RESERVE = 0x00002000;
+	constexpr unsigned long WIN_MEM_RELEASE = 0x00008000;
+	constexpr unsigned long WIN_MEM_LARGE_PAGES = 0x20000000;
+	constexpr unsigned long WIN_PAGE_READWRITE = 0x04;
+}
+
+// NOTE: these must match their declarations in <Windows.h> exactly, such that both may be included
+
+extern "C" {
+	__declspec(dllimport) void* __stdcall VirtualAlloc(void* lpAddress, _tt::win_size_t dwSize, unsigned long flAllocationType, unsigned long flProtect);
+	__declspec(dllimport) int __stdcall VirtualFree(void* lpAddress, _tt::win_size_t dwSize, unsigned long dwFreeType);
+	__declspec(dllimport) _tt::win_size_t __stdcall GetLargePageMinimum(void);
+}
+#endif
+
+namespace tt {
+
+
+	// A struct of options used to configure page-granular allocation.
+	struct page_alloc_options final {
+
+		// If the allocation should request transparent huge pages, via madvise(MADV_HUGEPAGE).
+		// This is only a hint, and is ignored on platforms without transparent huge pages.
+		tt_bool transparent_huge_pages = false;
+
+		// If the allocation should request explicit huge pages, via MAP_HUGETLB (or MEM_LARGE_PAGES on Windows.)
+		// If explicit huge pages are unavailable, regular pages are used instead, with transparent huge pages requested.
+		tt_bool explicit_huge_pages = false;
+
+		// If the allocation should be pre-faulted, via MAP_POPULATE, rather than faulted in lazily on first access.
+		tt_bool populate = false;
+
+
+		// Returns if the allocation should be huge page backed.
+		constexpr tt_bool huge() const noexcept { return transparent_huge_pages || explicit_huge_pages; }
+
+		// Returns if this and the given options are equal.
+		constexpr tt_bool equal(const page_alloc_options& other) const noexcept {
+
+
+			return 
+				transparent_huge_pages == other.transparent_huge_pages && 
+				explicit_huge_pages == other.explicit_huge_pages && 
+				populate == other.populate;
+		}
+
+		constexpr tt_bool operator==(const page_alloc_options& rhs) const noexcept { return equal(rhs); }
+		constexpr tt_bool operator!=(const page_alloc_options& rhs) const noexcept { return !equal(rhs); }
+	};
+
+	// Returns the size, in bytes, of a regular page of memory.
+	inline tt_size page_size() noexcept {
+
+
+		static const tt_size _result = []() -> tt_size {
+
+
+#if defined(_WIN32)
+			// NOTE: all Windows platforms use 4KiB pages
+
+			return 4096;
+#elif defined(__unix__) || defined(__APPLE__)
+			const auto _n = sysconf(_SC_PAGESIZE);
+
+			return _n > 0 ? (tt_size)_n : 4096;
+#else
+			return 4096;
+#endif
+		}();
+
+		return _result;
+	}
+
+	// Returns the size, in bytes, of a huge page of memory.
+	inline tt_size huge_page_size() noexcept {
+
+
+		static const tt_size _result = []() -> tt_size {
+
+
+#if defined(_WIN32)
+			const auto _n = GetLargePageMinimum();
+
+			return _n > 0 ? (tt_size)_n : (tt_size)2 * 1024 * 1024;
+#else
+			return (tt_size)2 * 1024 * 1024;
+#endif
+		}();
+
+		return _result;
+	}
+
+	// Returns the number of bytes actually reserved when page allocating n bytes with the given options.
+	// This is n rounded up to a multiple of the page size, or of the huge page size if huge pages are requested.
+	inline tt_size page_alloc_size(tt_size n, const tt::page_alloc_options& options = {}) noexcept {
+
+
+		const auto _granularity = options.huge() ? huge_page_size() : page_size();
+
+		return (n + _granularity - 1) / _granularity * _granularity;
+	}
+}
+
+namespace _tt {
+
+
+	// NOTE: on platforms without page allocation, fall back to page-aligned heap allocation
+
+	inline void* page_alloc_fallback(tt_size bytes) noexcept {
+
+
+		auto r = tt::aligned_alloc_uninit<tt_byte>(bytes, tt::page_size());
+
+		if (r)
+			std::memset(r, 0, bytes);
+
+		return r;
+	}
+
+	inline void page_prefault(void* x, tt_size bytes) noexcept {
+
+
+		const auto _step = tt::page_size();
+
+		for (tt_size i = 0; i < bytes; i += _step)
+			((volatile tt_byte*)x)[i] = 0;
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	// NOTE: maps bytes (a multiple of alignment) aligned to alignment, by over-mapping then trimming
+
+	inline void* page_mmap_aligned(tt_size bytes, tt_size alignment, int flags) noexcept {
+
+
+		const auto _mapped = bytes + (alignment > tt::page_size() ? alignment : 0);
+
+		auto _base = mmap(nullptr, _mapped, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+		if (_base == MAP_FAILED)
+			return nullptr;
+
+		if (_mapped == bytes)
+			return _base;
+
+		const auto _begin = (tt_uintptr)_base;
+		const auto _aligned = (_begin + alignment - 1) / alignment * alignment;
+		const auto _end = _begin + _mapped;
+
+		if (_aligned > _begin)
+			munmap(_base, _aligned - _begin);
+
+		if (_end > _aligned + bytes)
+			munmap((void*)(_aligned + bytes), _end - (_aligned + bytes));
+
+		return (void*)_aligned;
+	}
+#endif
+
+	inline void* page_alloc(tt_size bytes, const tt::page_alloc_options& options) noexcept {
+
+
+#if defined(_WIN32)
+		void* r = nullptr;
+
+		// NOTE: MEM_LARGE_PAGES requires the SeLockMemoryPrivilege, and so may well fail
+
+		if (options.explicit_huge_pages)
+			r = VirtualAlloc(nullptr, bytes, _tt::WIN_MEM_RESERVE | _tt::WIN_MEM_COMMIT | _tt::WIN_MEM_LARGE_PAGES, _tt::WIN_PAGE_READWRITE);
+
+		if (r)
+			return r;
+
+		r = VirtualAlloc(nullptr, bytes, _tt::WIN_MEM_RESERVE | _tt::WIN_MEM_COMMIT, _tt::WIN_PAGE_READWRITE);
+
+		if (r && options.populate)
+			page_prefault(r, bytes);
+
+		return r;
+#elif defined(__unix__) || defined(__APPLE__)
+		int _flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_POPULATE)
+		if (options.populate)
+			_flags |= MAP_POPULATE;
+#endif
+
+#if defined(MAP_HUGETLB)
+		if (options.explicit_huge_pages) {
+
+
+			auto _huge = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, _flags | MAP_HUGETLB, -1, 0);
+
+			if (_huge != MAP_FAILED)
+				return _huge;
+		}
+#endif
+
+		// NOTE: align huge page requests to the huge page size, as transparent huge pages can only
+		//		 back huge page aligned regions
+
+		auto r = page_mmap_aligned(bytes, options.huge() ? tt::huge_page_size() : tt::page_size(), _flags);
+
+		if (!r)
+			return nullptr;
+
+#if defined(MADV_HUGEPAGE)
+		if (options.huge())
+			madvise(r, bytes, MADV_HUGEPAGE);
+#endif
+
+#if !defined(MAP_POPULATE)
+		if (options.populate)
+			page_prefault(r, bytes);
+#endif
+
+		return r;
+#else
+		auto r = page_alloc_fallback(bytes);
+
+		if (r && options.populate)
+			page_prefault(r, bytes);
+
+		return r;
+#endif
+	}
+
+	inline void page_dealloc(void* x, tt_size bytes) noexcept {
+
+
+#if defined(_WIN32)
+		VirtualFree(x, 0, _tt::WIN_MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+		munmap(x, bytes);
+#else
+		tt::aligned_dealloc_uninit(x);
+#endif
+	}
+}
+
+namespace tt {
+
+
+	// A version of tt::alloc_uninit which allocates whole pages of memory directly from the operating system, via mmap (or VirtualAlloc on Windows.)
+	// The memory returned is zero-initialized, and is aligned to at least the page size (or the huge page size, if huge pages are used.)
+	// Huge page backing and pre-faulting may be requested via options, with regular pages being used if huge pages are unavailable.
+	// If n is zero, or the allocation fails, nullptr is returned.
+	// Allocations made using this should be released using tt::page_dealloc_uninit, passing the same n and options.
+	template<typename Value>
+	inline Value* page_alloc_uninit(tt_size n, const tt::page_alloc_options& options = {}) noexcept {
+
+
+		if (n == 0)
+			return nullptr;
+
+		return (Value*)_tt::page_alloc(page_alloc_size(n * sizeof(Value), options), options);
+	}
+
+	// Deallocates arrays of uninitialized memory allocated using tt::page_alloc_uninit.
+	// The n and options passed must be those passed to tt::page_alloc_uninit.
+	// If x is nullptr, the function fails quietly.
+	template<typename Value>
+	inline void page_dealloc_uninit(Value* x, tt_size n, const tt::page_alloc_options& options = {}) noexcept {
+
+
+		if (x)
+			_tt::page_dealloc((void*)x, page_alloc_size(n * sizeof(Value), options));
+	}
+
+	// Attempts to resize page allocation x of old_n values (allocated via tt::page_alloc_uninit) to new_n values, without copying its contents.
+	// The allocation may be moved, via mremap, with its contents up to the smaller of old_n and new_n preserved, and its new address returned.
+	// If huge pages are requested, the allocation is only moved to another huge page aligned address, so as to keep its huge page backing.
+	// If this isn't possible (ie. the platform lacks mremap), nullptr is returned, and x is left unchanged.
+	// If x is nullptr, or old_n or new_n is zero, nullptr is returned.
+	// The options passed must be those passed to tt::page_alloc_uninit, and are used for any new pages.
+	template<typename Value>
+	inline Value* page_realloc_uninit(Value* x, tt_size old_n, tt_size new_n, const tt::page_alloc_options& options = {}) noexcept {
+
+
+		if (!(x) || old_n == 0 || new_n == 0)
+			return nullptr;
+
+		const auto _old_bytes = page_alloc_size(old_n * sizeof(Value), options);
+		const auto _new_bytes = page_alloc_size(new_n * sizeof(Value), options);
+
+		if (_old_bytes == _new_bytes)
+			return x;
+
+#if defined(MREMAP_MAYMOVE)
+		void* r = MAP_FAILED;
+
+		if (options.huge()) {
+
+
+			// NOTE: mremap may move the mapping to an address which is only page aligned, losing its transparent
+			//		 huge page backing, so failing an in-place resize, it's moved onto a huge page aligned mapping
+			//		 reserved in advance, or not at all
+
+			r = mremap((void*)x, _old_bytes, _new_bytes, 0);
+
+#if defined(MREMAP_FIXED)
+			if (r == MAP_FAILED) {
+
+
+				auto _dest = _tt::page_mmap_aligned(_new_bytes, huge_page_size(), MAP_PRIVATE | MAP_ANONYMOUS);
+
+				if (!_dest)
+					return nullptr;
+
+				r = mremap((void*)x, _old_bytes, _new_bytes, MREMAP_MAYMOVE | MREMAP_FIXED, _dest);
+
+				if (r == MAP_FAILED)
+					munmap(_dest, _new_bytes);
+			}
+#endif
+		}
+		else
+			r = mremap((void*)x, _old_bytes, _new_bytes, MREMAP_MAYMOVE);
+
+		if (r == MAP_FAILED)
+			return nullptr;
+
+#if defined(MADV_HUGEPAGE)
+		if (options.huge())
+			madvise(r, _new_bytes, MADV_HUGEPAGE);
+#endif
+
+		return (Value*)r;
+#else
+		return nullptr;
+#endif
+	}
+
+	// Attempts to resize page allocation x of old_n values (allocated via tt::page_alloc_uninit) to new_n values, in place.
+	// Returns if this succeeded, in which case x must thereafter be deallocated as an allocation of new_n values.
+	// If x is nullptr, or old_n or new_n is zero, false is returned.
+	// The options passed must be those passed to tt::page_alloc_uninit.
+	template<typename Value>
+	inline tt_bool page_try_expand_uninit(Value* x, tt_size old_n, tt_size new_n, const tt::page_alloc_options& options = {}) noexcept {
+
+
+		if (!(x) || old_n == 0 || new_n == 0)
+			return false;
+
+		const auto _old_bytes = page_alloc_size(old_n * sizeof(Value), options);
+		const auto _new_bytes = page_alloc_size(new_n * sizeof(Value), options);
+
+		if (_old_bytes == _new_bytes)
+			return true;
+
+#if defined(MREMAP_MAYMOVE)
+		return mremap((void*)x, _old_bytes, _new_bytes, 0) != MAP_FAILED;
+#else
+		return false;
+#endif
+	}
+}
@@ -0,0 +1,178 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's page-granular memory allocator implementation.
+
+// This allocator allocates whole pages directly from the operating system, optionally huge page
+// backed and/or pre-faulted, and may be used in place of tt::aligned_allocator (ie. by tt::chunk)
+// for large buffers, such as lookup tables, which suffer from TLB misses.
+
+
+#include <type_traits>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "allocation.h"
+#include "page_allocation.h"
+#include "placement_construction.h"
+
+#include "forward_declarations.h"
+
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's page-granular memory allocator implementation.
+	// Allocations are aligned to at least the page size, and so satisfy any alignment up to 4096 bytes.
+	// As each allocation occupies at least one whole page, this allocator is intended for large buffers.
+	// NOTE: this is not final, as some standard library containers derive from their allocators.
+	template<typename Value>
+	struct page_allocator {
+
+		using value_t = typename Value;
+
+		static_assert(alignof(value_t) <= 4096, "tt::page_allocator cannot satisfy alignments greater than 4096 bytes!");
+
+		// defining this for rebind
+
+		template<typename U>
+		using page_allocator_t = tt::page_allocator<U>;
+
+		using this_t = page_allocator_t<value_t>;
+
+		using pointer = value_t*;
+		using const_pointer = const value_t*;
+		using void_pointer = void*;
+		using const_void_pointer = const void*;
+
+		using value_type = value_t;
+
+		using size_type = tt_size;
+		using difference_type = std::ptrdiff_t;
+
+		using is_always_equal = std::false_type;
+
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		template<typename U>
+		struct rebind final { using other = page_allocator_t<U>; };
+
+		// If two instances of this allocator type will be definition equal to one another when compared.
+		static constexpr tt_bool IS_ALWAYS_EQUAL = std::is_same_v<is_always_equal, std::true_type>;
+
+		// If container copy-assignment should propagate the state of the allocator.
+		static constexpr tt_bool PROPAGATE_ON_CONTAINER_COPY_ASSIGNMENT = std::is_same_v<propagate_on_container_copy_assignment, std::true_type>;
+
+		// If container move-assignment should propagate the state of the allocator.
+		static constexpr tt_bool PROPAGATE_ON_CONTAINER_MOVE_ASSIGNMENT = std::is_same_v<propagate_on_container_move_assignment, std::true_type>;
+
+		// If container swapping should propagate the state of the allocator.
+		static constexpr tt_bool PROPAGATE_ON_CONTAINER_SWAP = std::is_same_v<propagate_on_container_swap, std::true_type>;
+
+		// The maximum array size which may be allocated by the allocator.
+		static constexpr size_type MAX_SIZE = tt::max_of<size_type>;
+
+		// The options used by the allocator when allocating pages.
+		tt::page_alloc_options options = {};
+
+		// Default initializes a page allocator, which uses regular pages.
+		inline page_allocator() noexcept = default;
+
+		// Initializes a page allocator which uses the given options.
+		inline page_allocator(const tt::page_alloc_options& options) noexcept
+			: options(options) {}
+
+		// Initializes an allocator of a different underlying type.
+		template<typename Other>
+		inline page_allocator(const page_allocator_t<Other>& other) noexcept
+			: options(other.options) {}
+
+		// Copy-initializes a page allocator.
+		inline page_allocator(const this_t& other) noexcept
+			: options(other.options) {}
+
+		// Move-initializes a page allocator.
+		inline page_allocator(this_t&& other) noexcept
+			: options(other.options) {}
+
+		inline ~page_allocator() noexcept = default;
+
+		inline this_t& operator=(const this_t& rhs) noexcept { options = rhs.options; TT_RETURN_THIS; }
+		inline this_t& operator=(this_t&& rhs) noexcept { options = rhs.options; TT_RETURN_THIS; }
+
+		// Returns the maximum array size allocatable by this allocator.
+		constexpr size_type max_size() const noexcept { return MAX_SIZE; }
+
+		// Returns a version of this allocator that should be used when copy-constructing the allocator's owner.
+		constexpr this_t select_on_container_copy_construction() const noexcept { return this_t(*this); }
+
+		// Returns if this and the given page allocator are equal.
+		// Page allocators are equal if their options are equal, as the options determine how memory is released.
+		constexpr tt_bool equal(const this_t& other) const noexcept { return options.equal(other.options); }
+
+		inline tt_bool operator==(const this_t& rhs) const noexcept { return equal(rhs); }
+		inline tt_bool operator!=(const this_t& rhs) const noexcept { return !equal(rhs); }
+
+		// Invokes the allocator to allocator a block of n values, returning a pointer to this block.
+		// This wraps tt::page_alloc_uninit, and returns nullptr if allocation fails.
+		inline pointer allocate(size_type n) {
+
+
+			return tt::page_alloc_uninit<value_type>(n, options);
+		}
+
+		// Invokes the allocator to deallocate a block at address p of n values previous allocated by the allocator.
+		// This wraps tt::page_dealloc_uninit and will not throw.
+		inline void deallocate(pointer p, size_type n) noexcept {
+
+
+			if (p)
+				tt::page_dealloc_uninit<value_type>(p, n, options);
+		}
+
+		// Invokes the allocator to resize block p of old_n values to new_n values without copying, possibly moving it.
+		// Returns the resized block, or nullptr (leaving p untouched) if this isn't possible.
+		// This wraps tt::page_realloc_uninit and will not throw.
+		inline pointer reallocate(pointer p, size_type old_n, size_type new_n) noexcept {
+
+
+			return tt::page_realloc_uninit<value_type>(p, old_n, new_n, options);
+		}
+
+		// Invokes the allocator to resize block p of old_n values to new_n values in place, returning if this succeeded.
+		// This wraps tt::page_try_expand_uninit and will not throw.
+		inline tt_bool try_expand(pointer p, size_type old_n, size_type new_n) noexcept {
+
+
+			return tt::page_try_expand_uninit<value_type>(p, old_n, new_n, options);
+		}
+
+		// Invokes the allocator to placement-construct an object of type U at address p, passing args to its constructor.
+		// This wraps tt::construct_at and may throw accordingly.
+		template<typename U, typename... Args>
+		inline void construct(U* p, Args&&... args) {
+
+
+			tt::construct_at(p, TT_FMOVE_N(Args, args));
+		}
+
+		// Invokes the allocator to placement-destroy an object of type U at address p.
+		// This wraps tt::destroy_at and will not throw.
+		template<typename U>
+		inline void destroy(U* p) noexcept {
+
+
+			tt::destroy_at(p);
+		}
+	};
+
+	// A chunk whose heap memory is allocated in whole pages, via tt::page_allocator.
+	template<tt_size Alignment>
+	using page_chunk = tt::chunk<Alignment, tt::page_allocator<tt::chunk_unit<Alignment>>>;
+}
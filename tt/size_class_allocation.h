@@ -0,0 +1,809 @@
+
+
+#pragma once
+
+
+// A header file defining the Tirous Toolbox library's thread-caching size-class memory allocator.
+
+// Small allocations (up to a page in size and alignment) are rounded up to one of a fixed set of
+// 'size classes', and served from 'spans' of memory dedicated to that class. Each thread keeps a
+// cache of free blocks for each class, allowing most allocations and deallocations to occur without
+// any locking, with caches trading blocks with a central, per-class, freelist in batches.
+
+// Larger allocations are passed through to the system allocator.
+
+// Span memory is never returned to the system, but is reused by later allocations of its class.
+
+// Defining TT_CONFIG_SIZE_CLASS_ALLOC routes tt::alloc_uninit, tt::aligned_alloc_uninit (and thus
+// tt::aligned_allocator) through this allocator. Otherwise, it may still be used explicitly.
+
+
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#include "aliases.h"
+#include "compiler_detect.h"
+#include "macros.h"
+#include "debug.h"
+
+
+namespace tt {
+
+
+	// A struct describing the state of a single size class of the size-class allocator.
+	struct size_class_info final {
+
+		// The size, in bytes, of blocks of the size class.
+		tt_size size = 0;
+
+		// The alignment, in bytes, guaranteed by blocks of the size class.
+		tt_size alignment = 0;
+
+		// The number of bytes of blocks of the size class currently allocated.
+		tt_size bytes_in_use = 0;
+
+		// The number of bytes of span memory dedicated to the size class.
+		tt_size bytes_reserved = 0;
+	};
+
+	// A struct describing the state of the size-class allocator.
+	// Statistics are gathered from thread-local caches lazily, and so may lag behind by up to a batch of blocks per thread and size class.
+	struct size_class_allocator_stats final {
+
+		// The state of each size class.
+		std::vector<tt::size_class_info> classes = {};
+
+		// The number of bytes of allocations too large for any size class currently allocated.
+		tt_size large_bytes_in_use = 0;
+
+		// The number of allocations too large for any size class currently allocated.
+		tt_size large_allocations = 0;
+
+		// The number of allocations served by a thread-local cache.
+		tt_uint64 cache_hits = 0;
+
+		// The number of allocations which had to refill a thread-local cache.
+		tt_uint64 cache_misses = 0;
+
+		// Returns the fraction of allocations served by a thread-local cache, or zero if there have been none.
+		inline tt_double cache_hit_rate() const noexcept {
+
+
+			const auto _total = cache_hits + cache_misses;
+
+			return _total > 0 ? (tt_double)cache_hits / (tt_double)_total : 0.0;
+		}
+
+		// Returns the total number of bytes of size class blocks currently allocated.
+		inline tt_size bytes_in_use() const noexcept {
+
+
+			tt_size r = 0;
+
+			for (const auto& I : classes)
+				r += I.bytes_in_use;
+
+			return r;
+		}
+
+		// Returns the total number of bytes of span memory dedicated to size classes.
+		inline tt_size bytes_reserved() const noexcept {
+
+
+			tt_size r = 0;
+
+			for (const auto& I : classes)
+				r += I.bytes_reserved;
+
+			return r;
+		}
+
+		// Returns the fraction of span memory not currently allocated, or zero if there is no span memory.
+		inline tt_double fragmentation() const noexcept {
+
+
+			const auto _reserved = bytes_reserved();
+
+			return _reserved > 0 ? 1.0 - (tt_double)bytes_in_use() / (tt_double)_reserved : 0.0;
+		}
+	};
+
+
+	// Allocates n bytes of uninitialized memory, aligned to alignment, via the size-class allocator.
+	// The alignment must be a power of two.
+	// If n or alignment is zero, or the allocation fails, nullptr is returned.
+	// Allocations made using this should be released using tt::size_class_dealloc.
+	inline void* size_class_alloc(tt_size n, tt_size alignment = alignof(std::max_align_t)) noexcept;
+
+	// Deallocates memory allocated using tt::size_class_alloc.
+	// If x is nullptr, the function fails quietly.
+	inline void size_class_dealloc(void* x) noexcept;
+
+	// Returns the usable size, in bytes, of memory allocated using tt::size_class_alloc.
+	// If x is nullptr, zero is returned.
+	inline tt_size size_class_usable_size(const void* x) noexcept;
+
+	// Returns all blocks in the calling thread's cache to the central freelists, and publishes its statistics.
+	inline void size_class_flush_thread_cache() noexcept;
+
+	// Returns the current statistics of the size-class allocator.
+	inline tt::size_class_allocator_stats size_class_stats();
+}
+
+namespace _tt {
+
+
+	// NOTE: spans are SC_SPAN_SIZE bytes, aligned to SC_SPAN_SIZE, and are carved from 'groups'
+	//		 of SC_SPANS_PER_GROUP spans, so as to amortize the cost of aligned system allocation
+
+	constexpr tt_size SC_SPAN_SHIFT = 16;
+	constexpr tt_size SC_SPAN_SIZE = tt_size(1) << SC_SPAN_SHIFT;
+	constexpr tt_size SC_SPANS_PER_GROUP = 16;
+
+	constexpr tt_size SC_PAGE_SIZE = 4096;
+
+	constexpr tt_size SC_CLASS_SIZES[] = {
+		16, 32, 48, 64, 80, 96, 112, 128,
+		160, 192, 224, 256, 320, 384, 448, 512,
+		640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+		2560, 3072, 3584, 4096,
+	};
+
+	constexpr tt_size SC_CLASSES = sizeof(SC_CLASS_SIZES) / sizeof(SC_CLASS_SIZES[0]);
+
+	// NOTE: blocks of a class are packed back-to-back from the (span aligned) start of a span, so
+	//		 their alignment is the largest power of two dividing the class size
+
+	constexpr tt_size sc_class_alignment(tt_size cls) noexcept {
+
+
+		const auto _size = SC_CLASS_SIZES[cls];
+
+		const auto _low = _size & (~_size + 1);
+
+		return _low < SC_PAGE_SIZE ? _low : SC_PAGE_SIZE;
+	}
+
+	constexpr tt_size sc_class_cache_capacity(tt_size cls) noexcept {
+
+
+		const auto _n = (tt_size)32768 / SC_CLASS_SIZES[cls];
+
+		return _n < 8 ? 8 : (_n > 256 ? 256 : _n);
+	}
+
+	// NOTE: returns the index of the smallest class fitting n bytes aligned to alignment, or SC_CLASSES if none
+
+	inline tt_size sc_class_of(tt_size n, tt_size alignment) noexcept {
+
+
+		// NOTE: n is checked before being rounded up, as rounding a huge n would wrap around
+
+		if (alignment > SC_PAGE_SIZE || n > SC_CLASS_SIZES[SC_CLASSES - 1])
+			return SC_CLASSES;
+
+		n = (n + alignment - 1) & ~(alignment - 1);
+
+		auto cls = (tt_size)(std::lower_bound(std::begin(SC_CLASS_SIZES), std::end(SC_CLASS_SIZES), n) - std::begin(SC_CLASS_SIZES));
+
+		while (cls < SC_CLASSES && sc_class_alignment(cls) < alignment)
+			++cls;
+
+		return cls;
+	}
+
+
+	inline void* sc_system_aligned_alloc(tt_size n, tt_size alignment) noexcept {
+
+
+#if defined(TT_COMPILER_IS_MSVC)
+		return _aligned_malloc(n, alignment);
+#else
+		return std::aligned_alloc(alignment, (n + alignment - 1) & ~(alignment - 1));
+#endif
+	}
+
+	inline void sc_system_aligned_free(void* x) noexcept {
+
+
+#if defined(TT_COMPILER_IS_MSVC)
+		_aligned_free(x);
+#else
+		std::free(x);
+#endif
+	}
+
+
+	// NOTE: the page map records, for each span-sized region of the address space, the class (plus one)
+	//		 of the span there, or zero if the region isn't one of our spans
+	//
+	//		 it's a two-level radix tree over the top 48 bits of the address space, which is lazily
+	//		 populated, and never shrinks; its leaves are only ever written under the span mutex, but
+	//		 may be read at any time without locking
+
+	constexpr tt_size SC_MAP_LEAF_BITS = 16;
+	constexpr tt_size SC_MAP_LEAF_SIZE = tt_size(1) << SC_MAP_LEAF_BITS;
+	constexpr tt_size SC_MAP_ROOT_SIZE = tt_size(1) << 16;
+
+	struct sc_map_leaf final {
+
+		tt_atomic_uint8 entries[SC_MAP_LEAF_SIZE];
+	};
+
+	struct sc_free_node final {
+
+		sc_free_node* next;
+	};
+
+	struct sc_central_class final {
+
+		std::mutex				mtx				= {};
+		sc_free_node*			free_list		= nullptr;
+		tt_size					free_count		= 0;
+		tt_atomic_size			bytes_reserved	= 0;
+		tt_atomic_ssize			bytes_in_use	= 0;
+	};
+
+	struct sc_central final {
+
+		sc_central_class				classes[SC_CLASSES]		= {};
+
+		std::mutex						span_mtx				= {};
+		tt_byte*						group_cursor			= nullptr;
+		tt_size							group_remaining			= 0;
+		std::atomic<sc_map_leaf*>		map_root[SC_MAP_ROOT_SIZE]	= {};
+
+		tt_atomic_size					large_bytes_in_use		= 0;
+		tt_atomic_size					large_allocations		= 0;
+		tt_atomic_uint64				cache_hits				= 0;
+		tt_atomic_uint64				cache_misses			= 0;
+
+
+		inline tt_size lookup(const void* x) const noexcept {
+
+
+			const auto _key = (tt_uintptr)x >> SC_SPAN_SHIFT;
+
+			const auto _root = (tt_size)(_key >> SC_MAP_LEAF_BITS);
+
+			if (_root >= SC_MAP_ROOT_SIZE)
+				return 0;
+
+			const auto _leaf = map_root[_root].load(std::memory_order_acquire);
+
+			if (!_leaf)
+				return 0;
+
+			return _leaf->entries[_key & (SC_MAP_LEAF_SIZE - 1)].load(std::memory_order_relaxed);
+		}
+
+		// NOTE: the *_unsafe methods below presume that span_mtx is locked
+
+		inline tt_bool register_span_unsafe(tt_byte* span, tt_size cls) noexcept {
+
+
+			const auto _key = (tt_uintptr)span >> SC_SPAN_SHIFT;
+
+			const auto _root = (tt_size)(_key >> SC_MAP_LEAF_BITS);
+
+			// NOTE: addresses beyond the top 48 bits can't be mapped, in which case the span is
+			//		 simply never used
+
+			if (_root >= SC_MAP_ROOT_SIZE)
+				return false;
+
+			auto _leaf = map_root[_root].load(std::memory_order_relaxed);
+
+			if (!_leaf) {
+
+
+				_leaf = (sc_map_leaf*)std::calloc(1, sizeof(sc_map_leaf));
+
+				if (!_leaf)
+					return false;
+
+				map_root[_root].store(_leaf, std::memory_order_release);
+			}
+
+			_leaf->entries[_key & (SC_MAP_LEAF_SIZE - 1)].store((tt_uint8)(cls + 1), std::memory_order_relaxed);
+
+			return true;
+		}
+
+		inline tt_byte* take_span_unsafe() noexcept {
+
+
+			if (group_remaining == 0) {
+
+
+				group_cursor = (tt_byte*)sc_system_aligned_alloc(SC_SPAN_SIZE * SC_SPANS_PER_GROUP, SC_SPAN_SIZE);
+
+				if (!group_cursor)
+					return nullptr;
+
+				group_remaining = SC_SPANS_PER_GROUP;
+			}
+
+			auto r = group_cursor;
+
+			group_cursor += SC_SPAN_SIZE;
+
+			--group_remaining;
+
+			return r;
+		}
+
+		// NOTE: returns the span most recently taken via take_span_unsafe, freeing its group if it's the
+		//		 group's only span taken, and otherwise putting it back to be taken again
+
+		inline void return_span_unsafe(tt_byte* span) noexcept {
+
+
+			tt_assert(span + SC_SPAN_SIZE == group_cursor);
+
+			if (group_remaining == SC_SPANS_PER_GROUP - 1) {
+
+
+				sc_system_aligned_free(span);
+
+				group_cursor = nullptr;
+				group_remaining = 0;
+
+				return;
+			}
+
+			group_cursor = span;
+
+			++group_remaining;
+		}
+
+		// NOTE: presumes classes[cls].mtx is locked, and that the class's freelist is empty
+
+		inline tt_bool grow_class_unsafe(tt_size cls) noexcept {
+
+
+			tt_byte* _span = nullptr;
+
+			{
+				std::scoped_lock lk(span_mtx);
+
+				_span = take_span_unsafe();
+
+				if (!_span)
+					return false;
+
+				if (!register_span_unsafe(_span, cls)) {
+
+
+					return_span_unsafe(_span);
+
+					return false;
+				}
+			}
+
+			auto& _class = classes[cls];
+
+			const auto _size = SC_CLASS_SIZES[cls];
+			const auto _count = SC_SPAN_SIZE / _size;
+
+			for (tt_size i = _count; i > 0; --i) {
+
+
+				auto _node = (sc_free_node*)(_span + (i - 1) * _size);
+
+				_node->next = _class.free_list;
+
+				_class.free_list = _node;
+			}
+
+			_class.free_count += _count;
+			_class.bytes_reserved += SC_SPAN_SIZE;
+
+			return true;
+		}
+
+		// NOTE: pops up to n blocks of class cls onto head, returning the number popped
+
+		inline tt_size take(tt_size cls, sc_free_node*& head, tt_size n) noexcept {
+
+
+			auto& _class = classes[cls];
+
+			std::scoped_lock lk(_class.mtx);
+
+			if (_class.free_count == 0 && !grow_class_unsafe(cls))
+				return 0;
+
+			tt_size r = 0;
+
+			while (r < n && _class.free_list) {
+
+
+				auto _node = _class.free_list;
+
+				_class.free_list = _node->next;
+
+				_node->next = head;
+
+				head = _node;
+
+				++r;
+			}
+
+			_class.free_count -= r;
+
+			return r;
+		}
+
+		// NOTE: returns a chain of n blocks of class cls, from first to last
+
+		inline void give(tt_size cls, sc_free_node* first, sc_free_node* last, tt_size n) noexcept {
+
+
+			auto& _class = classes[cls];
+
+			std::scoped_lock lk(_class.mtx);
+
+			last->next = _class.free_list;
+
+			_class.free_list = first;
+
+			_class.free_count += n;
+		}
+	};
+
+	// NOTE: the central state is deliberately leaked, so that it outlives every thread-local cache,
+	//		 and every static object which might still deallocate during program shutdown
+
+	inline sc_central& sc_get_central() noexcept {
+
+
+		static sc_central* _central = new sc_central();
+
+		return *_central;
+	}
+
+
+	struct sc_class_cache final {
+
+		sc_free_node*	head			= nullptr;
+		tt_size			count			= 0;
+		tt_ssize		in_use_delta	= 0;
+	};
+
+	// NOTE: this is trivially destructible, so that it remains usable (in its 'dead' state) even
+	//		 after the thread's sc_thread_guard has been destroyed
+
+	struct sc_thread_cache final {
+
+		enum : tt_byte { FRESH, ACTIVE, DEAD };
+
+		tt_byte				state			= FRESH;
+		sc_class_cache		classes[SC_CLASSES]	= {};
+		tt_uint64			hits			= 0;
+		tt_uint64			misses			= 0;
+	};
+
+	inline sc_thread_cache& sc_get_thread_cache() noexcept {
+
+
+		thread_local sc_thread_cache _cache{};
+
+		return _cache;
+	}
+
+	inline void sc_flush_class(sc_thread_cache& cache, tt_size cls, tt_size keep) noexcept {
+
+
+		auto& _central = sc_get_central();
+		auto& _class = cache.classes[cls];
+
+		if (_class.count > keep) {
+
+
+			const auto _give = _class.count - keep;
+
+			auto _first = _class.head;
+			auto _last = _first;
+
+			for (tt_size i = 1; i < _give; ++i)
+				_last = _last->next;
+
+			_class.head = _last->next;
+			_class.count = keep;
+
+			_central.give(cls, _first, _last, _give);
+		}
+
+		_central.classes[cls].bytes_in_use += _class.in_use_delta;
+
+		_class.in_use_delta = 0;
+	}
+
+	inline void sc_flush_thread_cache(sc_thread_cache& cache) noexcept {
+
+
+		auto& _central = sc_get_central();
+
+		TT_FOR(i, SC_CLASSES)
+			sc_flush_class(cache, i, 0);
+
+		_central.cache_hits += cache.hits;
+		_central.cache_misses += cache.misses;
+
+		cache.hits = 0;
+		cache.misses = 0;
+	}
+
+	struct sc_thread_guard final {
+
+		inline ~sc_thread_guard() noexcept {
+
+
+			auto& _cache = sc_get_thread_cache();
+
+			sc_flush_thread_cache(_cache);
+
+			_cache.state = sc_thread_cache::DEAD;
+		}
+	};
+
+	// NOTE: returns the calling thread's cache, or nullptr if the thread is shutting down and its
+	//		 cache has already been flushed, in which case the central freelists are used directly
+
+	inline sc_thread_cache* sc_get_active_thread_cache() noexcept {
+
+
+		auto& _cache = sc_get_thread_cache();
+
+		if (_cache.state == sc_thread_cache::ACTIVE)
+			return &_cache;
+
+		if (_cache.state == sc_thread_cache::DEAD)
+			return nullptr;
+
+		// NOTE: odr-using the guard here registers its destructor for this thread
+
+		thread_local sc_thread_guard _guard{};
+
+		(void)&_guard;
+
+		_cache.state = sc_thread_cache::ACTIVE;
+
+		return &_cache;
+	}
+
+
+	// NOTE: allocations too large for any class are prefixed by this header, which sits immediately
+	//		 before the pointer returned
+
+	struct sc_large_header final {
+
+		void*		base;
+		tt_size		size;
+	};
+
+	inline void* sc_large_alloc(tt_size n, tt_size alignment) noexcept {
+
+
+		if (alignment < alignof(sc_large_header))
+			alignment = alignof(sc_large_header);
+
+		const auto _offset = (sizeof(sc_large_header) + alignment - 1) & ~(alignment - 1);
+
+		// NOTE: reject sizes which would wrap around once the header, and rounding to alignment, are added
+
+		if (n > ~(tt_size)0 - _offset - alignment)
+			return nullptr;
+
+		auto _base = (tt_byte*)sc_system_aligned_alloc(_offset + n, alignment);
+
+		if (!_base)
+			return nullptr;
+
+		auto r = _base + _offset;
+
+		auto _header = (sc_large_header*)r - 1;
+
+		_header->base = _base;
+		_header->size = n;
+
+		auto& _central = sc_get_central();
+
+		_central.large_bytes_in_use += n;
+		++(_central.large_allocations);
+
+		return r;
+	}
+
+	inline void sc_large_dealloc(void* x) noexcept {
+
+
+		auto _header = (sc_large_header*)x - 1;
+
+		auto& _central = sc_get_central();
+
+		_central.large_bytes_in_use -= _header->size;
+		--(_central.large_allocations);
+
+		sc_system_aligned_free(_header->base);
+	}
+}
+
+namespace tt {
+
+
+	inline void* size_class_alloc(tt_size n, tt_size alignment) noexcept {
+
+
+		if (n == 0 || alignment == 0)
+			return nullptr;
+
+		tt_assert((alignment & (alignment - 1)) == 0);
+
+		const auto cls = _tt::sc_class_of(n, alignment);
+
+		if (cls >= _tt::SC_CLASSES)
+			return _tt::sc_large_alloc(n, alignment);
+
+		auto _cache = _tt::sc_get_active_thread_cache();
+
+		if (!_cache) {
+
+
+			_tt::sc_free_node* _node = nullptr;
+
+			if (_tt::sc_get_central().take(cls, _node, 1) == 0)
+				return nullptr;
+
+			_tt::sc_get_central().classes[cls].bytes_in_use += (tt_ssize)_tt::SC_CLASS_SIZES[cls];
+
+			return _node;
+		}
+
+		auto& _class = _cache->classes[cls];
+
+		// NOTE: refill half the cache at once, so alternating alloc/dealloc calls at the boundary
+		//		 don't bounce blocks back and forth with the central freelist
+
+		if (!_class.head) {
+
+
+			++(_cache->misses);
+
+			_class.count += _tt::sc_get_central().take(cls, _class.head, _tt::sc_class_cache_capacity(cls) / 2);
+
+			if (!_class.head)
+				return nullptr;
+
+			// NOTE: piggyback on the refill to publish this thread's statistics
+
+			_tt::sc_flush_class(*_cache, cls, _class.count);
+
+			_tt::sc_get_central().cache_hits += _cache->hits;
+			_tt::sc_get_central().cache_misses += _cache->misses;
+
+			_cache->hits = 0;
+			_cache->misses = 0;
+		}
+
+		else
+			++(_cache->hits);
+
+		auto r = _class.head;
+
+		_class.head = r->next;
+
+		--(_class.count);
+
+		_class.in_use_delta += (tt_ssize)_tt::SC_CLASS_SIZES[cls];
+
+		return r;
+	}
+
+	inline void size_class_dealloc(void* x) noexcept {
+
+
+		if (!x)
+			return;
+
+		const auto _entry = _tt::sc_get_central().lookup(x);
+
+		if (_entry == 0) {
+
+
+			_tt::sc_large_dealloc(x);
+
+			return;
+		}
+
+		const auto cls = _entry - 1;
+
+		auto _node = (_tt::sc_free_node*)x;
+
+		auto _cache = _tt::sc_get_active_thread_cache();
+
+		if (!_cache) {
+
+
+			_tt::sc_get_central().give(cls, _node, _node, 1);
+			_tt::sc_get_central().classes[cls].bytes_in_use -= (tt_ssize)_tt::SC_CLASS_SIZES[cls];
+
+			return;
+		}
+
+		auto& _class = _cache->classes[cls];
+
+		_node->next = _class.head;
+
+		_class.head = _node;
+
+		++(_class.count);
+
+		_class.in_use_delta -= (tt_ssize)_tt::SC_CLASS_SIZES[cls];
+
+		// NOTE: once the cache overflows, return half of it in a single batch, which is also how
+		//		 blocks deallocated on other threads find their way back to the central freelist
+
+		const auto _capacity = _tt::sc_class_cache_capacity(cls);
+
+		if (_class.count > _capacity)
+			_tt::sc_flush_class(*_cache, cls, _capacity / 2);
+	}
+
+	inline tt_size size_class_usable_size(const void* x) noexcept {
+
+
+		if (!x)
+			return 0;
+
+		const auto _entry = _tt::sc_get_central().lookup(x);
+
+		if (_entry == 0)
+			return ((const _tt::sc_large_header*)x - 1)->size;
+
+		return _tt::SC_CLASS_SIZES[_entry - 1];
+	}
+
+	inline void size_class_flush_thread_cache() noexcept {
+
+
+		if (auto _cache = _tt::sc_get_active_thread_cache())
+			_tt::sc_flush_thread_cache(*_cache);
+	}
+
+	inline tt::size_class_allocator_stats size_class_stats() {
+
+
+		auto& _central = _tt::sc_get_central();
+
+		tt::size_class_allocator_stats r{};
+
+		r.classes.reserve(_tt::SC_CLASSES);
+
+		TT_FOR(i, _tt::SC_CLASSES) {
+
+
+			tt::size_class_info _info{};
+
+			const auto _in_use = _central.classes[i].bytes_in_use.load();
+
+			_info.size = _tt::SC_CLASS_SIZES[i];
+			_info.alignment = _tt::sc_class_alignment(i);
+			_info.bytes_in_use = _in_use > 0 ? (tt_size)_in_use : 0;
+			_info.bytes_reserved = _central.classes[i].bytes_reserved;
+
+			r.classes.push_back(_info);
+		}
+
+		r.large_bytes_in_use = _central.large_bytes_in_use;
+		r.large_allocations = _central.large_allocations;
+		r.cache_hits = _central.cache_hits;
+		r.cache_misses = _central.cache_misses;
+
+		return r;
+	}
+}
@@ -17,6 +17,7 @@
 #include "exceptions.h"
 #include "forward_declarations.h"
 
+#include "memory_util.h"
 #include "contiguous_iterator.h"
 
 #include "range.h"
@@ -310,12 +311,12 @@ namespace tt {
 		// Searches for an element with the given value, returning a past-the-end iterator if no match was found.
 		// The starting iterator of the search may be specified.
 		// To search for a match following a previously found one, pass that match's iterator, incremented.
-		inline iterator find(const_reference x, iterator start) noexcept { return std::find(start, end(), x); }
+		inline iterator find(const_reference x, iterator start) noexcept { return begin() + find_index(x, tt_size(start.get() - data())); }
 
 		// Searches for an element with the given value, returning a past-the-end iterator if no match was found.
 		// The starting iterator of the search may be specified.
 		// To search for a match following a previously found one, pass that match's iterator, incremented.
-		inline const_iterator find(const_reference x, iterator start) const noexcept { return std::find(start, end(), x); }
+		inline const_iterator find(const_reference x, iterator start) const noexcept { return begin() + find_index(x, tt_size(start.get() - data())); }
 
 		// Searches for an element with the given value, returning a past-the-end iterator if no match was found.
 		inline iterator find(const_reference x) noexcept { return find(x, begin()); }
@@ -325,14 +326,37 @@ namespace tt {
 
 		// A version of find which operates according to an index rather than an iterator.
 		// If an element cannot be found, the size of the container is returned.
+		// This is performed via tt::find_in_array, and so slices of 1, 2 and 4 byte types are searched using SIMD kernels.
 		inline tt_size find_index(const_reference x, tt_size start = 0) const noexcept {
 
 
-			for (; start < size(); ++start)
-				if (at_unchecked(start) == x)
-					return start;
+			if (start >= size())
+				return size();
 
-			return size();
+			return start + tt::find_in_array(data() + start, size() - start, x);
+		}
+
+		// Searches for an element equal to any element of the given set, returning its index, or the size of the container if no match was found.
+		// This is performed via tt::find_any_in_array, and so slices of 1, 2 and 4 byte types are searched using SIMD kernels.
+		inline tt_size find_any_index(tt::slice<const value_t> set, tt_size start = 0) const noexcept {
+
+
+			if (start >= size())
+				return size();
+
+			return start + tt::find_any_in_array(data() + start, size() - start, set.data(), set.size());
+		}
+
+		// Searches for a run of elements equal to the given needle, returning the index of its first element, or the size of the container if no match was found.
+		// An empty needle is found at the starting index, if it is within the slice.
+		// This is performed via tt::search_array, and so slices of 1, 2 and 4 byte types are searched using SIMD kernels.
+		inline tt_size search_index(tt::slice<const value_t> needle, tt_size start = 0) const noexcept {
+
+
+			if (start >= size())
+				return size();
+
+			return start + tt::search_array(data() + start, size() - start, needle.data(), needle.size());
 		}
 
 		// Returns a string visualization of the slice.
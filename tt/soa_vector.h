@@ -0,0 +1,843 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's structure-of-arrays container implementation.
+
+// A soa_vector stores each of its fields in its own contiguous 'column', rather than storing whole
+// rows contiguously, such that loops over a subset of fields touch only the memory they use, and
+// may be vectorized. Columns share a single allocation, each aligned to at least a cache line.
+
+
+#include <new>
+#include <tuple>
+#include <utility>
+#include <iterator>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "exceptions.h"
+#include "forward_declarations.h"
+
+#include "math_util.h"
+#include "memory_util.h"
+#include "placement_construction.h"
+#include "aligned_allocator.h"
+#include "inline_layout.h"
+
+#include "slice.h"
+
+
+namespace _tt {
+
+
+	// NOTE: columns have no header, but inline_layout requires one, so this empty one is used
+
+	struct soa_column_header final {};
+
+	template<typename Field>
+	using soa_column_layout = tt::inline_layout<_tt::soa_column_header, Field>;
+
+	template<tt_size N>
+	constexpr tt_size soa_max_of(const tt_size(&x)[N]) noexcept {
+
+
+		tt_size r = 0;
+
+		TT_FOR(i, N)
+			r = x[i] > r ? x[i] : r;
+
+		return r;
+	}
+
+	template<tt_size Alignment>
+	struct soa_block final {
+
+		alignas(Alignment) tt_byte _dummy[Alignment];
+	};
+}
+
+namespace tt {
+
+
+	// A proxy iterator used to iterate across the rows of a tt::soa_vector.
+	// Dereferencing yields a tuple of references to the fields of the row, rather than a reference to a row object.
+	template<typename Vector>
+	class soa_vector_iterator final {
+	public:
+
+		using vector_t = typename Vector;
+
+		// If the iterator is a 'const-iterator' or not.
+		static constexpr tt_bool IS_CONST = std::is_const_v<vector_t>;
+
+		using this_t = tt::soa_vector_iterator<vector_t>;
+
+		using difference_type = std::ptrdiff_t;
+		using value_type = typename std::remove_const_t<vector_t>::value_t;
+		using reference = std::conditional_t<IS_CONST, typename std::remove_const_t<vector_t>::const_row_t, typename std::remove_const_t<vector_t>::row_t>;
+		using pointer = void;
+
+		using iterator_category = std::random_access_iterator_tag;
+
+
+		// Default initializes a null soa_vector iterator.
+		inline soa_vector_iterator() noexcept {
+
+
+			_owner = nullptr;
+			_index = 0;
+		}
+
+		// Explicitly initializes an iterator of the row at index of owner.
+		inline soa_vector_iterator(vector_t* owner, tt_size index) noexcept {
+
+
+			_owner = owner;
+			_index = index;
+		}
+
+		// Copy-initializes a soa_vector iterator.
+		inline soa_vector_iterator(const this_t& x) noexcept {
+
+
+			TT_COPY(_owner, x);
+			TT_COPY(_index, x);
+		}
+
+		inline ~soa_vector_iterator() noexcept {};
+
+		inline this_t& operator=(const this_t& rhs) noexcept { TT_COPY(_owner, rhs); TT_COPY(_index, rhs); TT_RETURN_THIS; }
+
+		// Returns the row index of the iterator.
+		constexpr tt_size index() const noexcept { return _index; }
+
+		// Returns if the iterator is a const-iterator or not.
+		constexpr tt_bool is_const() const noexcept { return IS_CONST; }
+
+		// Returns the const-iterator equivalent of this iterator.
+		inline tt::soa_vector_iterator<std::add_const_t<vector_t>> to_const() const noexcept {
+
+
+			return tt::soa_vector_iterator<std::add_const_t<vector_t>>(_owner, _index);
+		}
+
+		// Returns if this and the given soa_vector iterator are equal.
+		constexpr tt_bool equal(const this_t& other) const noexcept { return _owner == other._owner && _index == other._index; }
+
+		constexpr tt_bool operator==(const this_t& rhs) const noexcept { return equal(rhs); }
+		constexpr tt_bool operator!=(const this_t& rhs) const noexcept { return !equal(rhs); }
+
+		constexpr tt_bool operator<(const this_t& rhs) const noexcept { return _index < rhs._index; }
+		constexpr tt_bool operator<=(const this_t& rhs) const noexcept { return _index <= rhs._index; }
+		constexpr tt_bool operator>(const this_t& rhs) const noexcept { return _index > rhs._index; }
+		constexpr tt_bool operator>=(const this_t& rhs) const noexcept { return _index >= rhs._index; }
+
+		inline reference operator*() const { return _owner->at_unchecked(_index); }
+
+		constexpr difference_type operator-(const this_t& x) const { return (difference_type)_index - (difference_type)x._index; }
+
+		inline this_t operator+(difference_type x) const { return this_t(_owner, _index + x); }
+		inline this_t operator-(difference_type x) const { return this_t(_owner, _index - x); }
+
+		inline reference operator[](tt_size index) const { return *(*this + index); }
+
+		inline this_t& operator++() { ++_index; TT_RETURN_THIS; }
+		inline this_t operator++(int) { auto t = *this; ++* this; return t; }
+
+		inline this_t& operator--() { --_index; TT_RETURN_THIS; }
+		inline this_t operator--(int) { auto t = *this; --* this; return t; }
+
+		inline this_t& operator+=(difference_type x) { _index += x; TT_RETURN_THIS; }
+		inline this_t& operator-=(difference_type x) { _index -= x; TT_RETURN_THIS; }
+
+
+	private:
+
+		vector_t* _owner;
+		tt_size _index;
+	};
+
+
+	// The Tirous Toolbox library's structure-of-arrays container implementation.
+	// Each field is stored in its own column, each of which is accessible as a tt::slice, with rows accessed as tuples of references.
+	// Columns share a single allocation, and are each aligned to ALIGNMENT bytes.
+	// Fields must be nothrow move-constructible, so that reallocation may provide a strong guarantee.
+	template<typename... Fields>
+	class soa_vector final {
+	public:
+
+		static_assert(sizeof...(Fields) > 0, "tt::soa_vector must have at least one field!");
+		static_assert((std::is_nothrow_move_constructible_v<Fields> && ...), "tt::soa_vector fields must be nothrow move-constructible!");
+
+		using this_t = tt::soa_vector<Fields...>;
+
+		// The number of fields (ie. columns) of the container.
+		static constexpr tt_size FIELDS = sizeof...(Fields);
+
+		// The alignment of each column, which is at least that of a cache line.
+		static constexpr tt_size ALIGNMENT = _tt::soa_max_of({ (tt_size)64, alignof(Fields)... });
+
+		// The type of the field at index Index.
+		template<tt_size Index>
+		using field_t = std::tuple_element_t<Index, std::tuple<Fields...>>;
+
+		using value_t = std::tuple<Fields...>;
+		using row_t = std::tuple<Fields&...>;
+		using const_row_t = std::tuple<const Fields&...>;
+
+		using block_t = _tt::soa_block<ALIGNMENT>;
+		using allocator_t = tt::aligned_allocator<block_t, ALIGNMENT>;
+
+		using iterator = tt::soa_vector_iterator<this_t>;
+		using const_iterator = tt::soa_vector_iterator<const this_t>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+
+		// Default initializes an empty soa_vector.
+		inline soa_vector() noexcept;
+
+		// Initializes a soa_vector of n value-initialized rows.
+		inline explicit soa_vector(tt_size n);
+
+		// Copy-initializes a soa_vector.
+		inline soa_vector(const this_t& x);
+
+		// Move-initializes a soa_vector.
+		inline soa_vector(this_t&& x) noexcept;
+
+		inline ~soa_vector() noexcept;
+
+		inline this_t& operator=(const this_t& rhs);
+		inline this_t& operator=(this_t&& rhs) noexcept;
+
+		// Returns the number of rows in the container.
+		constexpr tt_size size() const noexcept { return _size; }
+
+		// Returns the number of rows the container may hold without reallocating.
+		constexpr tt_size capacity() const noexcept { return _capacity; }
+
+		// Returns if the container is non-empty.
+		constexpr tt_bool has_size() const noexcept { return size() > 0; }
+
+		// Returns if the container is empty.
+		constexpr tt_bool empty() const noexcept { return !has_size(); }
+
+		// Returns if the given index is within the bounds of the container.
+		constexpr tt_bool in_bounds(tt_size x) const noexcept { return x < size(); }
+
+		// Returns the number of bytes allocated for the container's columns, for a capacity of n rows.
+		static constexpr tt_size bytes_for(tt_size n) noexcept;
+
+		// Returns a pointer to the column of the field at index Index, or nullptr if the container has no capacity.
+		template<tt_size Index>
+		inline field_t<Index>* data() noexcept { return (field_t<Index>*)_columns[Index]; }
+
+		// Returns a pointer to the column of the field at index Index, or nullptr if the container has no capacity.
+		template<tt_size Index>
+		inline const field_t<Index>* data() const noexcept { return (const field_t<Index>*)_columns[Index]; }
+
+		// Returns a slice of the column of the field at index Index.
+		template<tt_size Index>
+		inline tt::slice<field_t<Index>> column() noexcept { return tt::slice<field_t<Index>>(data<Index>(), size()); }
+
+		// Returns a const-slice of the column of the field at index Index.
+		template<tt_size Index>
+		inline tt::slice<const field_t<Index>> column() const noexcept { return tt::slice<const field_t<Index>>(data<Index>(), size()); }
+
+		// Returns an lvalue of the field at index Index of the row at index ind.
+		// This performs no bounds checking, and thus the lvalue returned may be invalid.
+		template<tt_size Index>
+		inline field_t<Index>& get_unchecked(tt_size ind) noexcept { return data<Index>()[ind]; }
+
+		// Returns an lvalue of the field at index Index of the row at index ind.
+		// This performs no bounds checking, and thus the lvalue returned may be invalid.
+		template<tt_size Index>
+		inline const field_t<Index>& get_unchecked(tt_size ind) const noexcept { return data<Index>()[ind]; }
+
+		// Returns an lvalue of the field at index Index of the row at index ind.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		template<tt_size Index>
+		inline field_t<Index>& get(tt_size ind);
+
+		// Returns an lvalue of the field at index Index of the row at index ind.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		template<tt_size Index>
+		inline const field_t<Index>& get(tt_size ind) const;
+
+		// Returns a tuple of references to the fields of the row at the given index.
+		// This performs no bounds checking, and thus the references returned may be invalid.
+		inline row_t at_unchecked(tt_size x) noexcept { return _row(x, std::index_sequence_for<Fields...>{}); }
+
+		// Returns a tuple of references to the fields of the row at the given index.
+		// This performs no bounds checking, and thus the references returned may be invalid.
+		inline const_row_t at_unchecked(tt_size x) const noexcept { return _row(x, std::index_sequence_for<Fields...>{}); }
+
+		// Returns a tuple of references to the fields of the row at the given index.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		// Provides a strong guarantee of exception-safety.
+		inline row_t at(tt_size x);
+
+		// Returns a tuple of references to the fields of the row at the given index.
+		// Throws tt::out_of_range_error if index is out-of-bounds.
+		// Provides a strong guarantee of exception-safety.
+		inline const_row_t at(tt_size x) const;
+
+		inline row_t operator[](tt_size x) { return at(x); }
+		inline const_row_t operator[](tt_size x) const { return at(x); }
+
+		// Returns a tuple of references to the fields of the first row.
+		// Throws tt::out_of_range_error if the container has no first row.
+		inline row_t front();
+
+		// Returns a tuple of references to the fields of the first row.
+		// Throws tt::out_of_range_error if the container has no first row.
+		inline const_row_t front() const;
+
+		// Returns a tuple of references to the fields of the last row.
+		// Throws tt::out_of_range_error if the container has no last row.
+		inline row_t back();
+
+		// Returns a tuple of references to the fields of the last row.
+		// Throws tt::out_of_range_error if the container has no last row.
+		inline const_row_t back() const;
+
+		// Appends a row, constructing each of its fields from the corresponding argument.
+		// Provides a strong guarantee of exception-safety.
+		// Throws tt::max_size_error if reallocating would require more bytes than are allowed.
+		template<typename... Args>
+		inline this_t& push_back(Args&&... args);
+
+		// Removes the last row.
+		// If the container is empty, the function fails quietly.
+		inline this_t& pop_back() noexcept;
+
+		// Removes the row at the given index, moving all rows beyond it back one index.
+		// If index is out-of-bounds, the function fails quietly.
+		inline this_t& erase(tt_size ind) noexcept;
+
+		// Removes the row at the given index, moving the last row into its place, rather than shifting all rows beyond it.
+		// If index is out-of-bounds, the function fails quietly.
+		inline this_t& swap_erase(tt_size ind) noexcept;
+
+		// Resizes the container to n rows, value-initializing any rows added.
+		// Throws tt::max_size_error if reallocating would require more bytes than are allowed.
+		inline this_t& resize(tt_size n);
+
+		// Ensures the container's capacity is at least n rows.
+		// Provides a strong guarantee of exception-safety.
+		// Throws tt::max_size_error if reallocating would require more bytes than are allowed.
+		inline this_t& reserve(tt_size n);
+
+		// Reduces the container's capacity to its size.
+		inline this_t& shrink_to_fit();
+
+		// Removes all rows from the container, without changing its capacity.
+		inline this_t& clear() noexcept;
+
+		// Removes all rows from the container, and releases its memory.
+		inline this_t& reset() noexcept;
+
+		// Swaps the contents of this and the given container.
+		inline void swap(this_t& other) noexcept;
+
+		inline iterator begin() noexcept { return iterator(this, 0); }
+		inline const_iterator begin() const noexcept { return cbegin(); }
+		inline const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+
+		inline iterator end() noexcept { return iterator(this, size()); }
+		inline const_iterator end() const noexcept { return cend(); }
+		inline const_iterator cend() const noexcept { return const_iterator(this, size()); }
+
+		inline reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+		inline const_reverse_iterator rbegin() const noexcept { return crbegin(); }
+		inline const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+		inline reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+		inline const_reverse_iterator rend() const noexcept { return crend(); }
+		inline const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+
+	private:
+
+		allocator_t _al;
+
+		block_t* _block;
+
+		tt_byte* _columns[FIELDS];
+
+		tt_size _size, _capacity;
+
+
+		template<tt_size Index>
+		static constexpr tt_size _column_bytes(tt_size n) noexcept {
+
+
+			return tt::aligned_size(_tt::soa_column_layout<field_t<Index>>::get_bytes_per_body(n), ALIGNMENT);
+		}
+
+		template<tt_size... Is>
+		static constexpr tt_size _bytes_for(tt_size n, std::index_sequence<Is...>) noexcept {
+
+
+			return (_column_bytes<Is>(n) + ...);
+		}
+
+		template<tt_size... Is>
+		static inline void _place_columns(block_t* block, tt_size n, tt_byte** columns, std::index_sequence<Is...>) noexcept {
+
+
+			tt_size _offset = 0;
+
+			((columns[Is] = (tt_byte*)block + _offset, _offset += _column_bytes<Is>(n)), ...);
+		}
+
+		template<tt_size... Is>
+		inline row_t _row(tt_size x, std::index_sequence<Is...>) noexcept {
+
+
+			return row_t(get_unchecked<Is>(x)...);
+		}
+
+		template<tt_size... Is>
+		inline const_row_t _row(tt_size x, std::index_sequence<Is...>) const noexcept {
+
+
+			return const_row_t(get_unchecked<Is>(x)...);
+		}
+
+		// NOTE: constructs each field of row ind, destroying those already constructed if one throws
+
+		template<typename... Args, tt_size... Is>
+		inline void _construct_row(tt_size ind, std::index_sequence<Is...>, Args&&... args) {
+
+
+			tt_size _constructed = 0;
+
+			try {
+
+
+				((tt::construct_at(data<Is>() + ind, TT_FMOVE(Args, args)), ++_constructed), ...);
+			}
+			catch (...) {
+
+
+				((Is < _constructed ? tt::destroy_at(data<Is>() + ind) : (void)0), ...);
+
+				throw;
+			}
+		}
+
+		template<tt_size... Is>
+		inline void _destroy_rows(tt_size first, tt_size last, std::index_sequence<Is...>) noexcept {
+
+
+			(tt::destroy_n_at(data<Is>() + first, last - first), ...);
+		}
+
+		template<tt_size... Is>
+		inline void _relocate_row(tt_size from, tt_size to, std::index_sequence<Is...>) noexcept {
+
+
+			((get_unchecked<Is>(to) = std::move(get_unchecked<Is>(from))), ...);
+		}
+
+		template<tt_size Index>
+		static inline void _relocate_column(field_t<Index>* from, field_t<Index>* to, tt_size n) noexcept {
+
+
+			if constexpr (std::is_trivially_copyable_v<field_t<Index>>)
+				tt::copy_block(from, to, n);
+
+			else
+				TT_FOR(i, n)
+					tt::construct_at(to + i, std::move(from[i])),
+					tt::destroy_at(from + i);
+		}
+
+		template<tt_size... Is>
+		inline void _relocate_columns(tt_byte** columns, std::index_sequence<Is...>) noexcept {
+
+
+			(_relocate_column<Is>(data<Is>(), (field_t<Is>*)columns[Is], size()), ...);
+		}
+
+		template<tt_size... Is>
+		inline void _copy_columns(const this_t& x, std::index_sequence<Is...>);
+
+		inline void _change_capacity(tt_size n);
+
+		inline tt_size _calc_geometric_growth(tt_size minimum) const noexcept;
+	};
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>::soa_vector() noexcept {
+
+
+	_block = nullptr;
+
+	TT_FOR(i, FIELDS)
+		_columns[i] = nullptr;
+
+	_size = 0;
+	_capacity = 0;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>::soa_vector(tt_size n)
+	: soa_vector() {
+
+
+	resize(n);
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>::soa_vector(const this_t& x)
+	: soa_vector() {
+
+
+	_copy_columns(x, std::index_sequence_for<Fields...>{});
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>::soa_vector(this_t&& x) noexcept
+	: soa_vector() {
+
+
+	swap(x);
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>::~soa_vector() noexcept {
+
+
+	reset();
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::operator=(const this_t& rhs) {
+
+
+	TT_SELF_COPY_TEST(rhs);
+
+	this_t _temp(rhs);
+
+	swap(_temp);
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::operator=(this_t&& rhs) noexcept {
+
+
+	TT_SELF_MOVE_TEST(rhs);
+
+	reset();
+
+	swap(rhs);
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+constexpr tt_size tt::soa_vector<Fields...>::bytes_for(tt_size n) noexcept {
+
+
+	return _bytes_for(n, std::index_sequence_for<Fields...>{});
+}
+
+template<typename... Fields>
+template<tt_size Index>
+inline typename tt::soa_vector<Fields...>::template field_t<Index>& tt::soa_vector<Fields...>::get(tt_size ind) {
+
+
+	if (!in_bounds(ind))
+		TT_THROW(tt::out_of_range_error, "soa_vector index out-of-range!");
+
+	return get_unchecked<Index>(ind);
+}
+
+template<typename... Fields>
+template<tt_size Index>
+inline const typename tt::soa_vector<Fields...>::template field_t<Index>& tt::soa_vector<Fields...>::get(tt_size ind) const {
+
+
+	if (!in_bounds(ind))
+		TT_THROW(tt::out_of_range_error, "soa_vector index out-of-range!");
+
+	return get_unchecked<Index>(ind);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::row_t tt::soa_vector<Fields...>::at(tt_size x) {
+
+
+	if (!in_bounds(x))
+		TT_THROW(tt::out_of_range_error, "soa_vector index out-of-range!");
+
+	return at_unchecked(x);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::const_row_t tt::soa_vector<Fields...>::at(tt_size x) const {
+
+
+	if (!in_bounds(x))
+		TT_THROW(tt::out_of_range_error, "soa_vector index out-of-range!");
+
+	return at_unchecked(x);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::row_t tt::soa_vector<Fields...>::front() {
+
+
+	if (empty())
+		TT_THROW(tt::out_of_range_error, "soa_vector has no front element!");
+
+	return at_unchecked(0);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::const_row_t tt::soa_vector<Fields...>::front() const {
+
+
+	if (empty())
+		TT_THROW(tt::out_of_range_error, "soa_vector has no front element!");
+
+	return at_unchecked(0);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::row_t tt::soa_vector<Fields...>::back() {
+
+
+	if (empty())
+		TT_THROW(tt::out_of_range_error, "soa_vector has no back element!");
+
+	return at_unchecked(size() - 1);
+}
+
+template<typename... Fields>
+inline typename tt::soa_vector<Fields...>::const_row_t tt::soa_vector<Fields...>::back() const {
+
+
+	if (empty())
+		TT_THROW(tt::out_of_range_error, "soa_vector has no back element!");
+
+	return at_unchecked(size() - 1);
+}
+
+template<typename... Fields>
+template<typename... Args>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::push_back(Args&&... args) {
+
+
+	static_assert(sizeof...(Args) == FIELDS, "tt::soa_vector::push_back requires one argument per field!");
+
+	if (size() == capacity())
+		_change_capacity(_calc_geometric_growth(size() + 1));
+
+	_construct_row(size(), std::index_sequence_for<Fields...>{}, TT_FMOVE_N(Args, args));
+
+	++_size;
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::pop_back() noexcept {
+
+
+	if (empty())
+		TT_RETURN_THIS;
+
+	_destroy_rows(size() - 1, size(), std::index_sequence_for<Fields...>{});
+
+	--_size;
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::erase(tt_size ind) noexcept {
+
+
+	if (!in_bounds(ind))
+		TT_RETURN_THIS;
+
+	for (tt_size i = ind + 1; i < size(); ++i)
+		_relocate_row(i, i - 1, std::index_sequence_for<Fields...>{});
+
+	return pop_back();
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::swap_erase(tt_size ind) noexcept {
+
+
+	if (!in_bounds(ind))
+		TT_RETURN_THIS;
+
+	if (ind != size() - 1)
+		_relocate_row(size() - 1, ind, std::index_sequence_for<Fields...>{});
+
+	return pop_back();
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::resize(tt_size n) {
+
+
+	if (n < size()) {
+
+
+		_destroy_rows(n, size(), std::index_sequence_for<Fields...>{});
+
+		_size = n;
+	}
+
+	else if (n > size()) {
+
+
+		reserve(n);
+
+		while (size() < n)
+			push_back(Fields{}...);
+	}
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::reserve(tt_size n) {
+
+
+	if (n > capacity())
+		_change_capacity(n);
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::shrink_to_fit() {
+
+
+	if (capacity() > size())
+		_change_capacity(size());
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::clear() noexcept {
+
+
+	_destroy_rows(0, size(), std::index_sequence_for<Fields...>{});
+
+	_size = 0;
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline tt::soa_vector<Fields...>& tt::soa_vector<Fields...>::reset() noexcept {
+
+
+	clear();
+
+	if (_block)
+		_al.deallocate(_block, bytes_for(capacity()) / sizeof(block_t));
+
+	_block = nullptr;
+
+	TT_FOR(i, FIELDS)
+		_columns[i] = nullptr;
+
+	_capacity = 0;
+
+	TT_RETURN_THIS;
+}
+
+template<typename... Fields>
+inline void tt::soa_vector<Fields...>::swap(this_t& other) noexcept {
+
+
+	std::swap(_block, other._block);
+	std::swap(_columns, other._columns);
+	std::swap(_size, other._size);
+	std::swap(_capacity, other._capacity);
+}
+
+template<typename... Fields>
+template<tt_size... Is>
+inline void tt::soa_vector<Fields...>::_copy_columns(const this_t& x, std::index_sequence<Is...>) {
+
+
+	reserve(x.size());
+
+	// NOTE: copy row by row, so that if a copy throws, the rows copied so far are cleaned up by our destructor
+
+	TT_FOR(i, x.size()) {
+
+
+		_construct_row(i, std::index_sequence<Is...>{}, x.get_unchecked<Is>(i)...);
+
+		++_size;
+	}
+}
+
+template<typename... Fields>
+inline void tt::soa_vector<Fields...>::_change_capacity(tt_size n) {
+
+
+	tt_assert(n >= size());
+
+	if (n > (tt::max_size - ALIGNMENT * FIELDS) / (_tt::soa_max_of({ sizeof(Fields)... }) * FIELDS))
+		TT_THROW(tt::max_size_error, "tt::soa_vector capacity change exceeds max size!");
+
+	block_t* _new_block = nullptr;
+
+	tt_byte* _new_columns[FIELDS] = {};
+
+	if (n > 0) {
+
+
+		_new_block = _al.allocate(bytes_for(n) / sizeof(block_t)); // <- nothing to worry about if this throws, thus strong guarantee
+
+		if (!_new_block)
+			throw std::bad_alloc();
+
+		_place_columns(_new_block, n, _new_columns, std::index_sequence_for<Fields...>{});
+	}
+
+	// nothing beyond here can throw, thus strong guarantee
+
+	_relocate_columns(_new_columns, std::index_sequence_for<Fields...>{});
+
+	if (_block)
+		_al.deallocate(_block, bytes_for(capacity()) / sizeof(block_t));
+
+	_block = _new_block;
+
+	TT_FOR(i, FIELDS)
+		_columns[i] = _new_columns[i];
+
+	_capacity = n;
+}
+
+template<typename... Fields>
+inline tt_size tt::soa_vector<Fields...>::_calc_geometric_growth(tt_size minimum) const noexcept {
+
+
+	tt_size r = capacity() + capacity() / 2;
+
+	return r < minimum ? minimum : r;
+}
+
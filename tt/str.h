@@ -16,32 +16,79 @@
 
 // These strings will NOT be null terminated.
 
-// These strings will provide hash precomputation.
+// These strings will provide hash precomputation, with their hashes being computed lazily, upon first
+// being needed, and then cached, such that strings which are never hashed (ie. most substrings made
+// while tokenizing) never pay for it.
+
+// String literals made via the '_tt' literal suffix instead have their hashes computed at compile-time,
+// whenever they're constant expressions (ie. constexpr variables, or case labels), with hash codes being
+// the same whether computed at compile-time or at runtime, such that the two may be freely mixed.
+// (See tt::basic_str_literal in this regard.)
 
 // These strings can be instructed to NOT take ownership of memory when initialized from a C-string,
 // which is to allow for the creation of strings from constant string literals without allocating.
 // (See tt::basic_str<Char>::literal in this regard.)
 
+// These strings store their characters in a single block of memory, which begins with an intrusive
+// reference count, such that making a string requires only one allocation, and copying a string only
+// one atomic increment. Short strings instead store their characters inline, within the string itself,
+// such that making and copying them requires no allocation, and no reference counting, at all.
+
 
-// TODO: if we ever need it, maybe add a concatenating '+' operator overload
+// TODO: if we ever need it, maybe add a concatenating '+' operator overload (for now, see tt::basic_str_builder and tt::basic_str_rope)
 
 
 #include <memory>
+#include <atomic>
 #include <string>
+#include <iterator>
 #include <string_view>
 
 #include "aliases.h"
+#include "exceptions.h"
+#include "math_util.h"
+#include "memory_util.h"
 #include "allocation.h"
+#include "placement_construction.h"
+#include "inline_layout.h"
 #include "hash.h"
+#include "bulk_hash.h"
 #include "visualize.h"
 
 
+namespace _tt {
+
+
+	// NOTE: the header of the block holding the characters of a string, shared by the strings copied from it
+
+	struct str_block_header final {
+
+		std::atomic<tt_size> refs;
+
+		// NOTE: the number of characters the block holds, such that views of only part of it can be told apart
+
+		tt_size length;
+	};
+}
+
 namespace tt {
 
 
 	template<typename Char>
 	class basic_str;
 
+	template<typename Char>
+	class basic_str_builder;
+
+	template<typename Char>
+	class basic_str_split;
+
+	template<typename Char>
+	class basic_str_literal;
+
+	template<typename Char>
+	class basic_str_interner;
+
 
 	using str	= basic_str<tt_char>;
 	using wstr	= basic_str<tt_wchar>;
@@ -66,6 +113,9 @@ namespace tt {
 
 		using this_t					= basic_str<char_t>;
 
+		// The maximum number of characters a string may store inline, within the string itself.
+		static constexpr tt_size SMALL_CAPACITY = 16 / sizeof(char_t);
+
 
 		using iterator					= typename string_view_t::const_iterator;
 		using const_iterator			= iterator;
@@ -78,7 +128,8 @@ namespace tt {
 
 		// Initializes a string of a view v of memory block m.
 		// Here m may be nullptr to initialize non-owning strings which simply view memory.
-		inline basic_str(const std::shared_ptr<char_t[]>& m, string_view_t v) noexcept;
+		// If m is not nullptr, the characters of v are copied, rather than m being shared.
+		inline basic_str(const std::shared_ptr<char_t[]>& m, string_view_t v);
 
 		// Initializes a string of count characters of chr.
 		inline basic_str(tt_size count, char_t chr);
@@ -113,17 +164,27 @@ namespace tt {
 		inline basic_str(string_view_t other) 
 			: basic_str(other.data(), other.length()) {}
 
-		basic_str(const this_t&) = default;
+		// Initializes a non-owning string of the characters of literal x, with its hash code already computed.
+		inline basic_str(const tt::basic_str_literal<char_t>& x) noexcept;
+
+		inline basic_str(const this_t& x) noexcept;
 		inline basic_str(this_t&& x) noexcept;
 
-		~basic_str() noexcept = default;
+		inline ~basic_str() noexcept { _release(); }
 
-		this_t& operator=(const this_t&) = default;
+		inline this_t& operator=(const this_t& rhs) noexcept;
 		inline this_t& operator=(this_t&& rhs) noexcept;
 
 
-		// Returns the shared memory block used to store the state of the string, if any.
-		inline std::shared_ptr<const char_t[]> get_memory_block() const noexcept { return std::static_pointer_cast<const char_t[]>(_storage); }
+		// Returns the shared memory block used to store the characters of the string, if any, which keeps them alive while held.
+		// Small strings, and non-owning strings, have no memory block.
+		inline std::shared_ptr<const char_t[]> get_memory_block() const;
+
+		// Returns if the string stores its characters in a shared memory block.
+		inline tt_bool has_memory_block() const noexcept { return _owns_block(); }
+
+		// Returns if the string stores its characters inline, within the string itself.
+		inline tt_bool is_small() const noexcept { return !_view.empty() && _view.data() == _small; }
 
 
 		inline const char_t* data() const noexcept { return _view.data(); }
@@ -168,7 +229,42 @@ namespace tt {
 		inline this_t substr(tt_size ind, tt_size len = tt::max_size) const noexcept;
 
 
-		constexpr const tt_size& hash() const noexcept { return _hash; }
+		// NOTE: the searches below return the length of the string, rather than npos, if nothing is found,
+		//		 in the manner of tt::slice<Value>::find_index, and search using the SIMD kernels of memory_util.h
+
+		// Returns the index of the first occurrence of chr at or after index start, or the length of the string if there is none.
+		inline tt_size find(char_t chr, tt_size start = 0) const noexcept;
+
+		// Returns the index of the first occurrence of needle at or after index start, or the length of the string if there is none.
+		// An empty needle is found at index start, if it is within the string.
+		inline tt_size find(string_view_t needle, tt_size start = 0) const noexcept;
+
+		// Returns the index of the first occurrence of any character of set at or after index start, or the length of the string if there is none.
+		inline tt_size find_any_of(string_view_t set, tt_size start = 0) const noexcept;
+
+		inline tt_bool contains(char_t chr) const noexcept { return find(chr) < length(); }
+		inline tt_bool contains(string_view_t needle) const noexcept { return needle.empty() || find(needle) < length(); }
+
+		// Returns a range of the substrings of the string separated by delimiter, which are found as the range is iterated.
+		inline tt::basic_str_split<char_t> split(char_t delimiter) const noexcept;
+
+		// Returns a range of the substrings of the string separated by delimiter, which are found as the range is iterated.
+		// Throws tt::illegal_argument_error if delimiter is empty.
+		inline tt::basic_str_split<char_t> split(string_view_t delimiter) const;
+
+
+		// Returns the hash code of the string, computing it if it has not yet been computed.
+		// This is equivalent to hash_view(view()).
+		inline tt_size hash() const noexcept;
+
+		// Returns if the hash code of the string has been computed yet.
+		inline tt_bool is_hashed() const noexcept { return _hash.load(std::memory_order_relaxed) != _NOT_HASHED; }
+
+		// Returns the hash code of a string of the characters of v.
+		// This is tt::bulk_hash_array(v.data(), v.length()), unless that would be the sentinel value strings use to mark their hash codes as not yet computed, in which case it is remapped.
+		// This may be computed at compile-time, producing the same hash code as at runtime.
+		static constexpr tt_size hash_view(string_view_t v) noexcept;
+
 		inline tt_string vis() const { return tt_string(_view); }
 
 
@@ -181,40 +277,244 @@ namespace tt {
 
 	private:
 
-		struct _Deleter final {
+		// NOTE: builders allocate blocks of this layout themselves, and hand them over to the strings they build
 
-			inline void operator()(char_t* x) const noexcept {
+		friend class tt::basic_str_builder<char_t>;
 
+		// NOTE: interners make their canonical strings via _make_block_backed, such that copies of them share their characters
 
-				_dealloc(x);
-			}
+		friend class tt::basic_str_interner<char_t>;
+
+
+		using _layout_t = tt::inline_layout<_tt::str_block_header, char_t>;
+		using _unit_t = typename _layout_t::unit;
+
+
+		// NOTE: small strings store their characters in _small, with their views viewing it, and all other
+		//		 strings use _block, which is nullptr for empty and non-owning strings
+
+		union {
+			_unit_t*				_block		= nullptr;
+			char_t					_small[SMALL_CAPACITY];
 		};
 
+		// NOTE: the hash code is computed lazily, and cached, with _NOT_HASHED marking it as not yet computed,
+		//		 and with it being atomic, as strings may be hashed by multiple threads at once, which may each
+		//		 compute it, but which will all compute, and store, the same value
 
-		// NOTE: remember that we need to use a shared pointer here for thread-safety reasons, as
-		//		 std::shared_ptr does some fancy thread-safety stuff internally that we need
+		static constexpr tt_size _NOT_HASHED = 0;
 
-		std::shared_ptr<char_t[]>	_storage	= nullptr;
 		string_view_t				_view		= {};
-		tt_size						_hash		= 0;
+		mutable std::atomic<tt_size>	_hash		= _NOT_HASHED;
+
+
+		inline tt_bool _owns_block() const noexcept { return !is_small() && _block; }
+
+		// NOTE: returns if the string owns a block, and views all of it (ie. it isn't a substr of a longer string)
 
+		inline tt_bool _views_whole_block() const noexcept { return _owns_block() && _view.data() == _chars_of(_block) && _view.length() == _layout_t::deref_header(_block).length; }
 
-		// NOTE: this is the *official* way to perform hash precomputation
+		static inline char_t* _chars_of(_unit_t* block) noexcept { return &_layout_t::deref_body_item(block, 0); }
 
-		inline tt_size _calc_hash() const noexcept { return hash_of(_view); }
+		// NOTE: these manage the reference count of the string's block, if any, with the last string to release
+		//		 a block deallocating it
 
+		inline void _acquire() const noexcept;
+		inline void _release() noexcept;
 
-		// NOTE: these just wrap memory allocation/deallocation and building shared pointers
+		static inline void _release_block(_unit_t* block) noexcept;
 
-		static inline char_t* _alloc(tt_size count) { return alloc_uninit<char_t>(count); }
-		static inline void _dealloc(char_t* x) noexcept { tt_assert(x); dealloc_uninit(x); }
+		// NOTE: this makes the string an owning string of count uninitialized characters, returning them, and
+		//		 storing them inline if there are few enough (and allow_small), with the string presumed to be empty beforehand
 
-		static inline std::shared_ptr<char_t[]> _alloc_ptr(tt_size count);
+		inline char_t* _init_chars(tt_size count, tt_bool allow_small = true);
+
+		// NOTE: this returns an owning string of a copy of v which stores its characters in a block, even if
+		//		 it's short enough to be a small string, such that its copies all view the same characters
+
+		static inline this_t _make_block_backed(string_view_t v);
+
+		inline void _copy_from(const this_t& x) noexcept;
+		inline void _move_from(this_t& x) noexcept;
 	};
 
 
+	// A string literal alongside its hash code, both of which are known at compile-time if the literal is a constant expression.
+	// These are made via the '_tt' literal suffix, and convert implicitly into non-owning strings whose hash codes are already computed.
+	// Literal keys (ie. of a hash map of tt::basic_str_hash, or case labels switching on a string's hash code) thus cost no hashing at runtime.
+	// Behaviour is undefined if a literal, or a string made of it, outlives the characters it views.
 	template<typename Char>
-	inline tt_bool operator==(const basic_str<Char>& lhs, const basic_str<Char>& rhs) noexcept { return lhs.view() == rhs.view(); }
+	class basic_str_literal final {
+	public:
+
+		using char_t = typename Char;
+
+		using str_t = tt::basic_str<char_t>;
+		using string_view_t = typename str_t::string_view_t;
+
+		using this_t = tt::basic_str_literal<char_t>;
+
+
+		// Initializes a literal of the characters of v, computing its hash code.
+		explicit constexpr basic_str_literal(string_view_t v) noexcept 
+			: _view(v), 
+			_hash(str_t::hash_view(v)) {}
+
+
+		constexpr tt_size length() const noexcept { return _view.length(); }
+		constexpr tt_bool has_length() const noexcept { return length() > 0; }
+		constexpr tt_bool empty() const noexcept { return !has_length(); }
+
+		constexpr const char_t* data() const noexcept { return _view.data(); }
+
+		constexpr string_view_t view() const noexcept { return _view; }
+
+		// Returns the hash code of the literal, which is that of a string of its characters.
+		constexpr tt_size hash() const noexcept { return _hash; }
+
+		// Returns a non-owning string of the characters of the literal, with its hash code already computed.
+		inline str_t str() const noexcept { return str_t(*this); }
+
+
+		inline tt_string vis() const { return tt_string(_view); }
+
+
+	private:
+
+		string_view_t	_view;
+		tt_size			_hash;
+	};
+
+
+	using str_literal	= basic_str_literal<tt_char>;
+	using wstr_literal	= basic_str_literal<tt_wchar>;
+
+	using str8_literal	= basic_str_literal<tt_char8>;
+	using str16_literal = basic_str_literal<tt_char16>;
+	using str32_literal = basic_str_literal<tt_char32>;
+
+
+	// A range of the substrings of a string separated by a delimiter, which are found as the range is iterated, without allocating.
+	// Substrings share the storage of the string split, in the manner of tt::basic_str<Char>::substr, with the range holding a copy of the string split.
+	// Empty substrings are not skipped, such that a string of n delimiters is split into n + 1 substrings, and an empty string into one empty substring.
+	// Delimiters longer than tt::basic_str<Char>::SMALL_CAPACITY are copied into storage of their own, which allocates.
+	template<typename Char>
+	class basic_str_split final {
+	public:
+
+		using char_t = typename Char;
+
+		using str_t = tt::basic_str<char_t>;
+		using string_view_t = typename str_t::string_view_t;
+
+		using this_t = tt::basic_str_split<char_t>;
+
+
+		class iterator final {
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = str_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = str_t;
+
+
+			iterator() = default;
+
+
+			// Returns the current substring.
+			inline str_t operator*() const noexcept { return _split->_s.substr(_start, _end - _start); }
+
+			// Returns a view of the current substring.
+			inline string_view_t view() const noexcept { return _split->_s.view(_start, _end - _start); }
+
+			inline iterator& operator++() noexcept {
+
+
+				if (_end == _split->_s.length())
+					_split = nullptr,
+					_start = 0,
+					_end = 0;
+
+				else
+					_start = _end + _split->_delimiter.length(),
+					_end = _split->_s.find(_split->_delimiter.view(), _start);
+
+				TT_RETURN_THIS;
+			}
+
+			inline iterator operator++(int) noexcept { auto t = *this; ++*this; return t; }
+
+			inline tt_bool operator==(const iterator& rhs) const noexcept { return _split == rhs._split && _start == rhs._start; }
+			inline tt_bool operator!=(const iterator& rhs) const noexcept { return !(*this == rhs); }
+
+
+		private:
+
+			friend class tt::basic_str_split<char_t>;
+
+
+			// NOTE: the past-the-end iterator has no _split
+
+			const this_t* _split = nullptr;
+			tt_size _start = 0;
+			tt_size _end = 0;
+
+
+			inline iterator(const this_t* split) noexcept
+				: _split(split),
+				_start(0),
+				_end(split->_s.find(split->_delimiter.view())) {}
+		};
+
+		using const_iterator = iterator;
+
+
+		// Initializes a range of the substrings of s separated by delimiter.
+		// Throws tt::illegal_argument_error if delimiter is empty.
+		inline basic_str_split(str_t s, str_t delimiter)
+			: _s(std::move(s)),
+			_delimiter(std::move(delimiter)) {
+
+
+			if (_delimiter.empty())
+				TT_THROW(tt::illegal_argument_error, "tt::basic_str_split delimiter cannot be empty!");
+		}
+
+
+		inline iterator begin() const noexcept { return iterator(this); }
+		inline iterator cbegin() const noexcept { return begin(); }
+
+		inline iterator end() const noexcept { return iterator(); }
+		inline iterator cend() const noexcept { return end(); }
+
+
+	private:
+
+		str_t _s;
+		str_t _delimiter;
+	};
+
+
+	// NOTE: strings viewing the same characters (ie. canonical strings of a tt::basic_str_interner) are equal, and
+	//		 non-empty strings of different (already computed) hashes are unequal, both without comparing their characters
+
+	template<typename Char>
+	inline tt_bool operator==(const basic_str<Char>& lhs, const basic_str<Char>& rhs) noexcept {
+
+
+		if (lhs.length() != rhs.length())
+			return false;
+
+		if (lhs.data() == rhs.data() || lhs.empty())
+			return true;
+
+		if (lhs.is_hashed() && rhs.is_hashed() && lhs.hash() != rhs.hash())
+			return false;
+
+		return lhs.view() == rhs.view();
+	}
 	template<typename Char>
 	inline tt_bool operator==(const basic_str<Char>& lhs, std::basic_string_view<Char> rhs) noexcept { return lhs.view() == rhs; }
 	template<typename Char>
@@ -244,21 +544,92 @@ namespace tt {
 	inline tt_bool operator!=(const Char* lhs, const basic_str<Char>& rhs) noexcept { return !(lhs == rhs); }
 
 
+	// NOTE: literals of different hash codes are unequal without comparing their characters, as are strings of a
+	//		 different (already computed) hash code than a literal's, with literals' hash codes always being known
+
+	template<typename Char>
+	constexpr tt_bool operator==(const basic_str_literal<Char>& lhs, const basic_str_literal<Char>& rhs) noexcept { return lhs.hash() == rhs.hash() && lhs.view() == rhs.view(); }
+	template<typename Char>
+	inline tt_bool operator==(const basic_str<Char>& lhs, const basic_str_literal<Char>& rhs) noexcept {
+
+
+		if (lhs.length() != rhs.length())
+			return false;
+
+		if (lhs.is_hashed() && lhs.hash() != rhs.hash())
+			return false;
+
+		return lhs.view() == rhs.view();
+	}
+	template<typename Char>
+	inline tt_bool operator==(const basic_str_literal<Char>& lhs, const basic_str<Char>& rhs) noexcept { return rhs == lhs; }
+
+	template<typename Char>
+	constexpr tt_bool operator!=(const basic_str_literal<Char>& lhs, const basic_str_literal<Char>& rhs) noexcept { return !(lhs == rhs); }
+	template<typename Char>
+	inline tt_bool operator!=(const basic_str<Char>& lhs, const basic_str_literal<Char>& rhs) noexcept { return !(lhs == rhs); }
+	template<typename Char>
+	inline tt_bool operator!=(const basic_str_literal<Char>& lhs, const basic_str<Char>& rhs) noexcept { return !(lhs == rhs); }
+
+
+	// A transparent hash function object of tt::basic_str, which also hashes literals, string views, standard strings and C-strings, without building strings of them.
+	// Hash maps using this, alongside tt::basic_str_equal, may thus look up tt::basic_str keys via these other string types (see tt::flat_hash_map.)
+	template<typename Char>
+	struct basic_str_hash final {
+
+		using is_transparent = void;
+
+
+		inline tt_size operator()(const basic_str<Char>& x) const noexcept { return x.hash(); }
+		inline tt_size operator()(const basic_str_literal<Char>& x) const noexcept { return x.hash(); }
+		inline tt_size operator()(std::basic_string_view<Char> x) const noexcept { return basic_str<Char>::hash_view(x); }
+		inline tt_size operator()(const std::basic_string<Char>& x) const noexcept { return basic_str<Char>::hash_view((std::basic_string_view<Char>)x); }
+		inline tt_size operator()(const Char* x) const noexcept { return basic_str<Char>::hash_view(std::basic_string_view<Char>(x)); }
+	};
+
+	// A transparent equality function object of tt::basic_str, which also compares them against string views, standard strings and C-strings.
+	template<typename Char>
+	struct basic_str_equal final {
+
+		using is_transparent = void;
+
+
+		template<typename Lhs, typename Rhs>
+		inline tt_bool operator()(const Lhs& lhs, const Rhs& rhs) const noexcept { return lhs == rhs; }
+	};
+
+
+	using str_hash		= basic_str_hash<tt_char>;
+	using wstr_hash		= basic_str_hash<tt_wchar>;
+
+	using str_equal		= basic_str_equal<tt_char>;
+	using wstr_equal	= basic_str_equal<tt_wchar>;
+
+
+	// NOTE: these return literals, rather than strings, as strings cannot be constant expressions, and so could
+	//		 not have their hash codes computed at compile-time, with literals converting into strings implicitly
+
 	namespace string_literals {
 
 
-		inline str8 operator""_tt(const tt_char8 * s, tt_size len) { return str8(nullptr, tt_string8_view(s, len)); }
-		inline str16 operator""_tt(const tt_char16 * s, tt_size len) { return str16(nullptr, tt_string16_view(s, len)); }
-		inline str32 operator""_tt(const tt_char32 * s, tt_size len) { return str32(nullptr, tt_string32_view(s, len)); }
-		inline wstr operator""_tt(const tt_wchar * s, tt_size len) { return wstr(nullptr, tt_wstring_view(s, len)); }
+		constexpr str8_literal operator""_tt(const tt_char8 * s, tt_size len) noexcept { return str8_literal(tt_string8_view(s, len)); }
+		constexpr str16_literal operator""_tt(const tt_char16 * s, tt_size len) noexcept { return str16_literal(tt_string16_view(s, len)); }
+		constexpr str32_literal operator""_tt(const tt_char32 * s, tt_size len) noexcept { return str32_literal(tt_string32_view(s, len)); }
+		constexpr wstr_literal operator""_tt(const tt_wchar * s, tt_size len) noexcept { return wstr_literal(tt_wstring_view(s, len)); }
 	}
 	
 
 	template<typename Char>
-	inline tt::basic_str<Char>::basic_str(const std::shared_ptr<char_t[]>& m, string_view_t v) noexcept 
-		: _storage(m), 
-		_view(v), 
-		_hash(_calc_hash()) {}
+	inline tt::basic_str<Char>::basic_str(const std::shared_ptr<char_t[]>& m, string_view_t v) 
+		: basic_str() {
+
+
+		if (m)
+			*this = this_t(v);
+
+		else
+			_view = v;
+	}
 	
 	template<typename Char>
 	inline basic_str<Char>::basic_str(tt_size count, char_t chr) 
@@ -266,10 +637,7 @@ namespace tt {
 
 
 		if (count > 0)
-			_storage = _alloc_ptr(count),
-			_view = string_view_t(_storage.get(), count),
-			fill_array<char_t>(_storage.get(), count, chr),
-			_hash = _calc_hash(); // <- NOTE: this must happen AFTER we fill our array!
+			fill_array<char_t>(_init_chars(count), count, chr);
 	}
 	
 	template<typename Char>
@@ -280,10 +648,7 @@ namespace tt {
 		tt_assert(s);
 
 		if (count > 0)
-			_storage = _alloc_ptr(count),
-			_view = string_view_t(_storage.get(), count),
-			copy_block(s, _storage.get(), count),
-			_hash = _calc_hash(); // <- NOTE: this must happen AFTER we copy our array!
+			copy_block(s, _init_chars(count), count);
 	}
 	
 	template<typename Char>
@@ -292,17 +657,40 @@ namespace tt {
 	
 	template<typename Char>
 	inline basic_str<Char>::basic_str(const char_t* s, no_alloc_t) noexcept 
-		: _storage(nullptr), 
-		_view(s, measure_cstr(s)), 
-		_hash(_calc_hash()) {}
+		: _block(nullptr), 
+		_view(s, measure_cstr(s)) {}
+
+	template<typename Char>
+	inline basic_str<Char>::basic_str(const tt::basic_str_literal<char_t>& x) noexcept 
+		: _block(nullptr), 
+		_view(x.view()), 
+		_hash(x.hash()) {}
+
+	template<typename Char>
+	inline basic_str<Char>::basic_str(const this_t& x) noexcept {
+
+
+		_copy_from(x);
+	}
 	
 	template<typename Char>
 	inline basic_str<Char>::basic_str(this_t&& x) noexcept {
 
 
-		TT_MOVE(_storage, x);
-		TT_MOVE(_view, x);
-		TT_MOVESET(_hash, x, x._calc_hash());
+		_move_from(x);
+	}
+
+	template<typename Char>
+	inline typename basic_str<Char>::this_t& basic_str<Char>::operator=(const this_t& rhs) noexcept {
+
+
+		TT_SELF_COPY_TEST(rhs);
+
+		_release();
+
+		_copy_from(rhs);
+
+		TT_RETURN_THIS;
 	}
 	
 	template<typename Char>
@@ -311,45 +699,274 @@ namespace tt {
 
 		TT_SELF_MOVE_TEST(rhs);
 
-		TT_MOVE(_storage, rhs);
-		TT_MOVE(_view, rhs);
-		TT_MOVESET(_hash, rhs, rhs._calc_hash());
+		_release();
+
+		_move_from(rhs);
 
 		TT_RETURN_THIS;
 	}
 
 	template<typename Char>
-	template<typename Other>
-	inline tt_bool tt::basic_str<Char>::equal(const Other& other) const noexcept {
+	inline std::shared_ptr<const typename basic_str<Char>::char_t[]> basic_str<Char>::get_memory_block() const {
+
+
+		if (!_owns_block())
+			return nullptr;
+
+		// NOTE: the shared pointer holds a reference of its own, released by its deleter
+
+		struct _Deleter final {
+
+			_unit_t* block;
+
+
+			inline void operator()(const char_t*) const noexcept {
+
+
+				_release_block(block);
+			}
+		};
+
+		_acquire();
+
+		try {
+
+
+			return std::shared_ptr<const char_t[]>(_chars_of(_block), _Deleter{ _block });
+		}
+		catch (...) {
+
+
+			_release_block(_block);
+
+			throw;
+		}
+	}
+
+	template<typename Char>
+	inline tt_size basic_str<Char>::hash() const noexcept {
+
+
+		tt_size r = _hash.load(std::memory_order_relaxed);
+
+		if (r == _NOT_HASHED)
+			r = hash_view(_view),
+			_hash.store(r, std::memory_order_relaxed);
+
+		return r;
+	}
+
+	template<typename Char>
+	constexpr tt_size basic_str<Char>::hash_view(string_view_t v) noexcept {
+
 
+		const tt_size r = tt::bulk_hash_array(v.data(), v.length());
 
-		return *this == other;
+		return r != _NOT_HASHED ? r : _NOT_HASHED + 1;
 	}
 
 	template<typename Char>
 	inline typename basic_str<Char>::this_t basic_str<Char>::substr(tt_size ind, tt_size len) const noexcept {
 
 
-		auto r = *this;
+		const auto _sub = _view.substr(ind, len);
 
-		r._view = r._view.substr(ind, len);
-		r._hash = r._calc_hash();
+		this_t r;
+
+		// NOTE: substrings short enough to be small strings are copied, rather than sharing blocks, as doing
+		//		 so is as cheap as a reference count increment, and avoids keeping larger blocks alive
+
+		if (_sub.empty())
+			return r;
+
+		if (_owns_block() && _sub.length() > SMALL_CAPACITY)
+			r._block = _block,
+			r._view = _sub,
+			_acquire();
+
+		else if (_owns_block() || is_small())
+			copy_block(_sub.data(), r._init_chars(_sub.length()), _sub.length());
+
+		else
+			r._view = _sub;
+
+		// NOTE: the substring's hash is left to be computed lazily, if ever
 
 		return r;
 	}
 
 	template<typename Char>
-	inline std::shared_ptr<typename basic_str<Char>::char_t[]> basic_str<Char>::_alloc_ptr(tt_size count) {
+	inline tt_size basic_str<Char>::find(char_t chr, tt_size start) const noexcept {
+
+
+		if (start >= length())
+			return length();
+
+		return start + tt::find_in_array(data() + start, length() - start, chr);
+	}
+
+	template<typename Char>
+	inline tt_size basic_str<Char>::find(string_view_t needle, tt_size start) const noexcept {
+
+
+		if (start >= length())
+			return length();
+
+		return start + tt::search_array(data() + start, length() - start, needle.data(), needle.length());
+	}
+
+	template<typename Char>
+	inline tt_size basic_str<Char>::find_any_of(string_view_t set, tt_size start) const noexcept {
+
+
+		if (start >= length())
+			return length();
+
+		return start + tt::find_any_in_array(data() + start, length() - start, set.data(), set.length());
+	}
+
+	template<typename Char>
+	inline tt::basic_str_split<typename basic_str<Char>::char_t> basic_str<Char>::split(char_t delimiter) const noexcept {
+
+
+		// NOTE: a single character delimiter is a small string, and so this never allocates, nor throws
+
+		return tt::basic_str_split<char_t>(*this, this_t(1, delimiter));
+	}
+
+	template<typename Char>
+	inline tt::basic_str_split<typename basic_str<Char>::char_t> basic_str<Char>::split(string_view_t delimiter) const {
+
+
+		return tt::basic_str_split<char_t>(*this, this_t(delimiter));
+	}
+
+	template<typename Char>
+	inline void basic_str<Char>::_acquire() const noexcept {
+
+
+		if (_owns_block())
+			_layout_t::deref_header(_block).refs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	template<typename Char>
+	inline void basic_str<Char>::_release() noexcept {
+
+
+		if (_owns_block())
+			_release_block(_block);
+
+		_block = nullptr;
+		_view = {};
+	}
+
+	template<typename Char>
+	inline void basic_str<Char>::_release_block(_unit_t* block) noexcept {
+
+
+		tt_assert(block);
+
+		if (_layout_t::deref_header(block).refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+
+
+			tt::destroy_at(&_layout_t::deref_header(block));
+
+			tt::aligned_dealloc_uninit(block);
+		}
+	}
+
+	template<typename Char>
+	inline typename basic_str<Char>::char_t* basic_str<Char>::_init_chars(tt_size count, tt_bool allow_small) {
 
 
 		tt_assert(count > 0);
+		tt_assert(_view.empty() && !_owns_block());
+
+		if (allow_small && count <= SMALL_CAPACITY) {
+
 
-		return std::shared_ptr<char_t[]>(
-			_alloc(count), 
-			_Deleter{});
+			_view = string_view_t(_small, count);
+
+			return _small;
+		}
+
+		_unit_t* _new_block = tt::aligned_alloc_uninit<_unit_t>(tt::aligned_size(_layout_t::get_bytes_total(count), _layout_t::BLOCK_ALIGNMENT) / sizeof(_unit_t), _layout_t::BLOCK_ALIGNMENT);
+
+		if (!_new_block)
+			throw std::bad_alloc();
+
+		tt::construct_at(&_layout_t::deref_header(_new_block))->refs.store(1, std::memory_order_relaxed);
+
+		_layout_t::deref_header(_new_block).length = count;
+
+		_block = _new_block;
+		_view = string_view_t(_chars_of(_new_block), count);
+
+		return _chars_of(_new_block);
+	}
+
+	template<typename Char>
+	inline typename basic_str<Char>::this_t basic_str<Char>::_make_block_backed(string_view_t v) {
+
+
+		this_t r;
+
+		if (!v.empty())
+			copy_block(v.data(), r._init_chars(v.length(), false), v.length());
+
+		return r;
+	}
+
+	template<typename Char>
+	inline void basic_str<Char>::_copy_from(const this_t& x) noexcept {
+
+
+		if (x.is_small())
+			copy_block(x._small, _small, x.length()),
+			_view = string_view_t(_small, x.length());
+
+		else
+			_block = x._block,
+			_view = x._view,
+			_acquire();
+
+		_hash.store(x._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	template<typename Char>
+	inline void basic_str<Char>::_move_from(this_t& x) noexcept {
+
+
+		if (x.is_small())
+			copy_block(x._small, _small, x.length()),
+			_view = string_view_t(_small, x.length());
+
+		else
+			_block = x._block,
+			_view = x._view;
+
+		// NOTE: the cached hash is transferred, rather than recomputed, with the moved-from string, which
+		//		 is now empty, having its hash marked as not yet computed
+
+		_hash.store(x._hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		x._block = nullptr;
+		x._view = {};
+		x._hash.store(_NOT_HASHED, std::memory_order_relaxed);
 	}
 }
 
-TT_HASHERS(0) { TT_REGISTER_HASH_T(tt::basic_str, <typename Char>, <Char>); }
-TT_VISUALIZERS(0) { TT_REGISTER_VISUALIZE_T(tt::basic_str, <typename Char>, <Char>); }
+TT_HASHERS(0) {
+
+
+	TT_REGISTER_HASH_T(tt::basic_str, <typename Char>, <Char>);
+	TT_REGISTER_HASH_T(tt::basic_str_literal, <typename Char>, <Char>);
+}
+
+TT_VISUALIZERS(0) {
+
+
+	TT_REGISTER_VISUALIZE_T(tt::basic_str, <typename Char>, <Char>);
+	TT_REGISTER_VISUALIZE_T(tt::basic_str_literal, <typename Char>, <Char>);
+}
 
@@ -0,0 +1,365 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's string 'builder' implementation.
+
+// A builder appends characters into storage which grows geometrically, such that building a string
+// from n appended characters takes amortized O(n) time, and then hands this storage over to the
+// tt::basic_str it builds, such that finalizing a builder copies nothing.
+
+// This works as builders store their characters in a block of the same layout as those of strings,
+// such that the block a builder builds into simply becomes the block of the string it builds.
+
+
+/*
+
+	Strings built from a builder share the builder's whole block, including any capacity it has beyond the length
+	of the string, for as long as they (or their substrings) are alive. Where this matters, shrink_to_fit may be
+	used prior to building, at the cost of a copy.
+
+	Strings short enough to be small strings are instead copied out of the builder, with the builder keeping its
+	block, such that builders used to repeatedly build short strings only ever allocate once.
+
+*/
+
+
+#include <string_view>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "exceptions.h"
+#include "numeric_limits.h"
+#include "memory_util.h"
+#include "hash_functions.h"
+#include "str.h"
+
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's string 'builder' implementation.
+	// Appends characters into geometrically grown storage, which is then handed over to the string built, without copying.
+	// Builders are move-only, and are not thread-safe.
+	template<typename Char>
+	class basic_str_builder final {
+	public:
+
+		using char_t = typename Char;
+
+		using str_t = tt::basic_str<char_t>;
+		using string_view_t = typename str_t::string_view_t;
+
+		using this_t = tt::basic_str_builder<char_t>;
+
+		// The capacity of a builder's first block, unless more is reserved.
+		static constexpr tt_size MIN_CAPACITY = 64 / sizeof(char_t);
+
+		// The maximum number of characters a builder may hold.
+		static constexpr tt_size MAX_LENGTH = (max_of<tt_size> / 2) / sizeof(char_t);
+
+
+		// Default initializes an empty builder, which allocates nothing until first appended to.
+		basic_str_builder() = default;
+
+		// Initializes an empty builder with a capacity of at least capacity characters.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if capacity exceeds MAX_LENGTH.
+		explicit inline basic_str_builder(tt_size capacity) { reserve(capacity); }
+
+		basic_str_builder(const this_t&) = delete;
+
+		inline basic_str_builder(this_t&& x) noexcept { swap(x); }
+
+		inline ~basic_str_builder() noexcept { reset(); }
+
+		this_t& operator=(const this_t&) = delete;
+
+		inline this_t& operator=(this_t&& rhs) noexcept {
+
+
+			TT_SELF_MOVE_TEST(rhs);
+
+			reset();
+
+			swap(rhs);
+
+			TT_RETURN_THIS;
+		}
+
+
+		// Returns the number of characters appended to the builder.
+		inline tt_size length() const noexcept { return _length; }
+		inline tt_bool has_length() const noexcept { return length() > 0; }
+		inline tt_bool empty() const noexcept { return !has_length(); }
+
+		// Returns the number of characters the builder may hold before it must grow.
+		inline tt_size capacity() const noexcept { return _capacity; }
+
+		// Returns a pointer to the characters of the builder, or nullptr if it has no block.
+		// This is invalidated by anything which grows, shrinks, builds, or resets the builder.
+		inline const char_t* data() const noexcept { return _block ? _chars() : nullptr; }
+
+		// Returns a view of the characters of the builder.
+		// This is invalidated by anything which grows, shrinks, builds, or resets the builder.
+		inline string_view_t view() const noexcept { return string_view_t(data(), length()); }
+
+		inline operator string_view_t() const noexcept { return view(); }
+
+
+		// Ensures the builder has a capacity of at least capacity characters.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if capacity exceeds MAX_LENGTH.
+		inline void reserve(tt_size capacity);
+
+		// Reallocates the builder's block to be exactly as large as its characters, or releases it, if the builder is empty.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		inline void shrink_to_fit();
+
+
+		// NOTE: the view appended to may view the builder's own characters, and so the builder's old
+		//		 block is only ever released after the appended characters have been copied
+
+		// Appends the characters of v to the builder.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if the builder's length would exceed MAX_LENGTH.
+		inline this_t& append(string_view_t v);
+
+		// Appends count characters of chr to the builder.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if the builder's length would exceed MAX_LENGTH.
+		inline this_t& append(tt_size count, char_t chr);
+
+		// Appends the characters of s to the builder.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if the builder's length would exceed MAX_LENGTH.
+		inline this_t& append(const str_t& s) { return append(s.view()); }
+
+		// Appends chr to the builder.
+		// Throws std::bad_alloc if the block cannot be allocated.
+		// Throws tt::max_size_error if the builder's length would exceed MAX_LENGTH.
+		inline this_t& append(char_t chr) { return append(1, chr); }
+
+		inline void push_back(char_t chr) { append(chr); }
+
+		inline this_t& operator+=(string_view_t v) { return append(v); }
+		inline this_t& operator+=(const str_t& s) { return append(s); }
+		inline this_t& operator+=(char_t chr) { return append(chr); }
+
+
+		// Returns a string of the characters of the builder, and empties the builder.
+		// The builder's block becomes the block of the string, without being copied, unless the string is short enough to be a small string.
+		inline str_t build() noexcept;
+
+
+		// Empties the builder, keeping its block.
+		inline void clear() noexcept { _length = 0; }
+
+		// Empties the builder, releasing its block.
+		inline void reset() noexcept;
+
+		inline void swap(this_t& other) noexcept {
+
+
+			std::swap(_block, other._block);
+			std::swap(_length, other._length);
+			std::swap(_capacity, other._capacity);
+		}
+
+
+	private:
+
+		using _layout_t = typename str_t::_layout_t;
+		using _unit_t = typename str_t::_unit_t;
+
+
+		_unit_t* _block = nullptr;
+		tt_size _length = 0;
+		tt_size _capacity = 0;
+
+
+		inline char_t* _chars() const noexcept { return str_t::_chars_of(_block); }
+
+		// NOTE: this makes room for count more characters, returning the old block to be released by the
+		//		 caller once it's done, if the builder had to move to a new block, or nullptr otherwise
+
+		inline _unit_t* _make_room(tt_size count);
+
+		// NOTE: this moves the characters of the builder to a new block of capacity characters, returning the old block
+
+		inline _unit_t* _move_to(tt_size capacity);
+
+		static inline void _dealloc(_unit_t* block) noexcept;
+	};
+
+
+	using str_builder	= basic_str_builder<tt_char>;
+	using wstr_builder	= basic_str_builder<tt_wchar>;
+
+	using str8_builder	= basic_str_builder<tt_char8>;
+	using str16_builder = basic_str_builder<tt_char16>;
+	using str32_builder = basic_str_builder<tt_char32>;
+
+
+	template<typename Char>
+	inline void basic_str_builder<Char>::reserve(tt_size capacity) {
+
+
+		if (capacity > MAX_LENGTH)
+			TT_THROW(tt::max_size_error, "tt::basic_str_builder capacity exceeds max length!");
+
+		if (capacity > _capacity)
+			_dealloc(_move_to(capacity));
+	}
+
+	template<typename Char>
+	inline void basic_str_builder<Char>::shrink_to_fit() {
+
+
+		if (_length == _capacity)
+			return;
+
+		if (_length == 0)
+			reset();
+
+		else
+			_dealloc(_move_to(_length));
+	}
+
+	template<typename Char>
+	inline typename basic_str_builder<Char>::this_t& basic_str_builder<Char>::append(string_view_t v) {
+
+
+		if (v.empty())
+			TT_RETURN_THIS;
+
+		_unit_t* _old = _make_room(v.length());
+
+		copy_block(v.data(), _chars() + _length, v.length());
+
+		_length += v.length();
+
+		_dealloc(_old);
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Char>
+	inline typename basic_str_builder<Char>::this_t& basic_str_builder<Char>::append(tt_size count, char_t chr) {
+
+
+		if (count == 0)
+			TT_RETURN_THIS;
+
+		_dealloc(_make_room(count));
+
+		fill_array<char_t>(_chars() + _length, count, chr);
+
+		_length += count;
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Char>
+	inline typename basic_str_builder<Char>::str_t basic_str_builder<Char>::build() noexcept {
+
+
+		str_t r;
+
+		if (_length == 0)
+			return r;
+
+		if (_length <= str_t::SMALL_CAPACITY) {
+
+
+			copy_block(_chars(), r._small, _length);
+
+			r._view = string_view_t(r._small, _length);
+
+			_length = 0;
+
+			return r;
+		}
+
+		// NOTE: the block's reference count is only meaningful once a string owns it
+
+		_layout_t::deref_header(_block).refs.store(1, std::memory_order_relaxed);
+		_layout_t::deref_header(_block).length = _capacity;
+
+		r._block = _block;
+		r._view = string_view_t(_chars(), _length);
+
+		_block = nullptr;
+		_length = 0;
+		_capacity = 0;
+
+		return r;
+	}
+
+	template<typename Char>
+	inline void basic_str_builder<Char>::reset() noexcept {
+
+
+		_dealloc(_block);
+
+		_block = nullptr;
+		_length = 0;
+		_capacity = 0;
+	}
+
+	template<typename Char>
+	inline typename basic_str_builder<Char>::_unit_t* basic_str_builder<Char>::_make_room(tt_size count) {
+
+
+		if (count > MAX_LENGTH - _length)
+			TT_THROW(tt::max_size_error, "tt::basic_str_builder length exceeds max length!");
+
+		const tt_size _needed = _length + count;
+
+		if (_needed <= _capacity)
+			return nullptr;
+
+		// NOTE: the builder's capacity at least doubles whenever it grows (up to MAX_LENGTH), which is what amortizes appending
+
+		return _move_to(tt::max(_needed, tt::min(tt::max(_capacity * 2, MIN_CAPACITY), MAX_LENGTH)));
+	}
+
+	template<typename Char>
+	inline typename basic_str_builder<Char>::_unit_t* basic_str_builder<Char>::_move_to(tt_size capacity) {
+
+
+		tt_assert(capacity >= _length && capacity > 0);
+
+		_unit_t* _new_block = tt::aligned_alloc_uninit<_unit_t>(tt::aligned_size(_layout_t::get_bytes_total(capacity), _layout_t::BLOCK_ALIGNMENT) / sizeof(_unit_t), _layout_t::BLOCK_ALIGNMENT);
+
+		if (!_new_block)
+			throw std::bad_alloc();
+
+		tt::construct_at(&_layout_t::deref_header(_new_block));
+
+		if (_length > 0)
+			copy_block(_chars(), str_t::_chars_of(_new_block), _length);
+
+		_unit_t* _old = _block;
+
+		_block = _new_block;
+		_capacity = capacity;
+
+		return _old;
+	}
+
+	template<typename Char>
+	inline void basic_str_builder<Char>::_dealloc(_unit_t* block) noexcept {
+
+
+		if (!block)
+			return;
+
+		tt::destroy_at(&_layout_t::deref_header(block));
+
+		tt::aligned_dealloc_uninit(block);
+	}
+}
@@ -0,0 +1,447 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's string 'interner' implementation.
+
+// An interner maps each distinct string it's given to a single 'canonical' tt::basic_str, such that
+// interning equal strings always results in strings viewing the same characters. As strings of the
+// same characters compare equal without comparing them, and as strings precompute their hashes,
+// canonical strings compare and hash in constant time, making them ideal for symbols, identifiers,
+// and the like, which are compared far more often than they are made.
+
+// Canonical strings are never small strings, even if short enough to be, as small strings store their
+// characters inline, and so copies of them would be compared by their characters, rather than by address.
+
+
+/*
+
+	Interners are thread-safe, and stripe their strings across a number of independently locked 'shards', selected
+	by the hashes of the strings, such that threads interning different strings rarely contend with one another.
+
+	Lookups of strings which have already been interned never lock, as each shard's table is an append-only array
+	of atomic pointers to its canonical strings, which is only ever replaced (when it grows) by a larger copy, with
+	the tables it replaces being kept alive until the interner is cleared or destroyed, such that lookups racing with
+	insertions or growth simply miss, and then retry under the shard's lock.
+
+	The characters of canonical strings may either be heap allocated, in which case canonical strings own their
+	characters as any other string does, and may thus outlive the interner, or be allocated from a tt::arena per
+	shard, in which case canonical strings merely view their characters, and are invalidated when the interner is
+	cleared or destroyed.
+
+	Canonical strings are never removed from an interner, other than by clearing it.
+
+*/
+
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string_view>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "numeric_limits.h"
+#include "memory_util.h"
+#include "hash_functions.h"
+#include "arena.h"
+#include "str.h"
+#include "flat_hash_map.h"
+
+
+namespace _tt {
+
+
+	// NOTE: a table is an open-addressing array of atomic pointers to canonical strings, which are only ever
+	//		 set once, from nullptr, and which are probed linearly, with the table being kept at most half full
+
+	template<typename Char>
+	struct str_interner_table final {
+
+		tt_size														mask;
+		std::unique_ptr<std::atomic<const tt::basic_str<Char>*>[]>	slots;
+
+
+		inline explicit str_interner_table(tt_size capacity)
+			: mask(capacity - 1),
+			slots(std::make_unique<std::atomic<const tt::basic_str<Char>*>[]>(capacity)) {
+
+
+			tt_assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+			TT_FOR(i, capacity)
+				slots[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		inline tt_size capacity() const noexcept { return mask + 1; }
+	};
+
+	// NOTE: shards are cache line aligned so that threads locking neighbouring shards don't falsely share
+
+	template<typename Char>
+	struct alignas(64) str_interner_shard final {
+
+		std::mutex															mtx;
+		std::atomic<_tt::str_interner_table<Char>*>							table		= nullptr;
+		std::atomic<tt_size>												size		= 0;
+		std::vector<std::unique_ptr<_tt::str_interner_table<Char>>>			tables;
+		std::deque<tt::basic_str<Char>>										strings;
+		tt::arena															arena;
+	};
+}
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's string interner, which maps each distinct string it's given to a single canonical tt::basic_str.
+	// Interners are thread-safe, other than clear, and moving them.
+	template<typename Char>
+	class basic_str_interner final {
+	public:
+
+		using char_t			= typename Char;
+
+		using this_t			= tt::basic_str_interner<char_t>;
+
+		using str_t				= tt::basic_str<char_t>;
+		using string_view_t		= typename str_t::string_view_t;
+
+		// The default number of shards of an interner.
+		static constexpr tt_size DEFAULT_SHARDS = 16;
+
+		// The capacity of the table of a shard when its first string is interned.
+		static constexpr tt_size MIN_TABLE_CAPACITY = 16;
+
+
+		// Initializes an interner of the given number of shards (rounded up to a power of two.)
+		// If arena_backed, the characters of canonical strings are allocated from an arena per shard, and canonical strings are invalidated when the interner is cleared or destroyed.
+		inline explicit basic_str_interner(tt_bool arena_backed = false, tt_size shards = DEFAULT_SHARDS);
+
+		basic_str_interner(const this_t&) = delete;
+
+		inline basic_str_interner(this_t&& x) noexcept
+			: _shards(std::move(x._shards)),
+			_shard_mask(x._shard_mask),
+			_arena_backed(x._arena_backed) {}
+
+		~basic_str_interner() noexcept = default;
+
+		this_t& operator=(const this_t&) = delete;
+
+		inline this_t& operator=(this_t&& rhs) noexcept;
+
+
+		// Returns the interner used by tt::intern, which is heap-backed, and lives until the program exits.
+		static inline this_t& global();
+
+
+		// Returns the number of shards of the interner.
+		inline tt_size shards() const noexcept { return _shard_mask + 1; }
+
+		// Returns if the characters of the interner's canonical strings are allocated from arenas.
+		inline tt_bool is_arena_backed() const noexcept { return _arena_backed; }
+
+		// Returns the number of canonical strings in the interner.
+		// As other threads may be interning strings, this is only a snapshot.
+		inline tt_size size() const noexcept;
+
+		// Returns if the interner has no canonical strings.
+		// As other threads may be interning strings, this is only a snapshot.
+		inline tt_bool empty() const noexcept { return size() == 0; }
+
+
+		// Returns a pointer to the canonical string equal to s, or nullptr if s has not been interned.
+		// This never locks, and the pointer returned is valid until the interner is cleared or destroyed.
+		inline const str_t* find(string_view_t s) const noexcept;
+
+		// Returns if a canonical string equal to s has been interned.
+		// This never locks.
+		inline tt_bool contains(string_view_t s) const noexcept { return find(s); }
+
+
+		// Returns the canonical string equal to s, interning a copy of s if there is none.
+		// Interning an empty string always returns an empty string, without interning it.
+		// Only locks if s has not yet been interned.
+		inline str_t intern(string_view_t s);
+
+		// Returns the canonical string equal to s, interning s if there is none.
+		// If the interner is heap-backed, and s owns its characters, s itself is interned, without copying its characters.
+		// Interning an empty string always returns an empty string, without interning it.
+		// Only locks if s has not yet been interned.
+		inline str_t intern(const str_t& s);
+
+
+		// Discards all canonical strings of the interner, invalidating the pointers returned by find, and, if the interner is arena-backed, the canonical strings themselves.
+		// This is not thread-safe.
+		inline void clear() noexcept;
+
+
+	private:
+
+		using _table_t		= _tt::str_interner_table<char_t>;
+		using _shard_t		= _tt::str_interner_shard<char_t>;
+
+		std::unique_ptr<_shard_t[]>		_shards;
+		tt_size							_shard_mask;
+		tt_bool							_arena_backed;
+
+
+		// NOTE: the high bits of the mixed hash select the shard, and the low bits select the slot within
+		//		 its table, so that the two don't correlate
+
+		static inline tt_size _mix(tt_size hash) noexcept { return _tt::flat_mix(hash); }
+
+		inline _shard_t& _shard_of(tt_size mixed) const noexcept { return _shards[(mixed >> (sizeof(tt_size) * 8 - 16)) & _shard_mask]; }
+
+		static inline const str_t* _probe(const _table_t* table, string_view_t s, tt_size hash, tt_size mixed) noexcept;
+
+		// NOTE: s_str, if not nullptr, is a string equal to s which may be interned in place of a copy of s
+
+		inline str_t _intern(string_view_t s, const str_t* s_str);
+
+		inline void _grow(_shard_t& shard);
+	};
+
+
+	template<typename Char>
+	inline basic_str_interner<Char>::basic_str_interner(tt_bool arena_backed, tt_size shards)
+		: _arena_backed(arena_backed) {
+
+
+		tt_size _n = 1;
+
+		while (_n < shards && _n < ((tt_size)1 << 16))
+			_n *= 2;
+
+		_shards = std::make_unique<_shard_t[]>(_n);
+		_shard_mask = _n - 1;
+	}
+
+	template<typename Char>
+	inline typename basic_str_interner<Char>::this_t& basic_str_interner<Char>::operator=(this_t&& rhs) noexcept {
+
+
+		TT_SELF_MOVE_TEST(rhs);
+
+		TT_MOVE(_shards, rhs);
+		TT_COPY(_shard_mask, rhs);
+		TT_COPY(_arena_backed, rhs);
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Char>
+	inline typename basic_str_interner<Char>::this_t& basic_str_interner<Char>::global() {
+
+
+		static this_t _global;
+
+		return _global;
+	}
+
+	template<typename Char>
+	inline tt_size basic_str_interner<Char>::size() const noexcept {
+
+
+		tt_size r = 0;
+
+		TT_FOR(i, shards())
+			r += _shards[i].size.load(std::memory_order_relaxed);
+
+		return r;
+	}
+
+	template<typename Char>
+	inline const typename basic_str_interner<Char>::str_t* basic_str_interner<Char>::find(string_view_t s) const noexcept {
+
+
+		const tt_size _hash = str_t::hash_view(s);
+		const tt_size _mixed = _mix(_hash);
+
+		return _probe(_shard_of(_mixed).table.load(std::memory_order_acquire), s, _hash, _mixed);
+	}
+
+	template<typename Char>
+	inline typename basic_str_interner<Char>::str_t basic_str_interner<Char>::intern(string_view_t s) {
+
+
+		if (s.empty())
+			return str_t();
+
+		if (const auto ff = find(s))
+			return *ff;
+
+		return _intern(s, nullptr);
+	}
+
+	template<typename Char>
+	inline typename basic_str_interner<Char>::str_t basic_str_interner<Char>::intern(const str_t& s) {
+
+
+		if (s.empty())
+			return str_t();
+
+		if (const auto ff = find(s.view()))
+			return *ff;
+
+		return _intern(s.view(), &s);
+	}
+
+	template<typename Char>
+	inline void basic_str_interner<Char>::clear() noexcept {
+
+
+		TT_FOR(i, shards()) {
+
+
+			auto& _shard = _shards[i];
+
+			_shard.table.store(nullptr, std::memory_order_relaxed);
+			_shard.size.store(0, std::memory_order_relaxed);
+			_shard.tables.clear();
+			_shard.strings.clear();
+			_shard.arena.release();
+		}
+	}
+
+	template<typename Char>
+	inline const typename basic_str_interner<Char>::str_t* basic_str_interner<Char>::_probe(const _table_t* table, string_view_t s, tt_size hash, tt_size mixed) noexcept {
+
+
+		if (!table)
+			return nullptr;
+
+		for (tt_size i = mixed & table->mask; true; i = (i + 1) & table->mask) {
+
+
+			const str_t* _str = table->slots[i].load(std::memory_order_acquire);
+
+			if (!_str)
+				return nullptr;
+
+			if (_str->hash() == hash && _str->view() == s)
+				return _str;
+		}
+	}
+
+	template<typename Char>
+	inline typename basic_str_interner<Char>::str_t basic_str_interner<Char>::_intern(string_view_t s, const str_t* s_str) {
+
+
+		tt_assert(!s.empty());
+
+		const tt_size _hash = str_t::hash_view(s);
+		const tt_size _mixed = _mix(_hash);
+
+		auto& _shard = _shard_of(_mixed);
+
+		std::scoped_lock lk(_shard.mtx);
+
+		// NOTE: another thread may have interned s in between our lock-free lookup and locking
+
+		if (const auto ff = _probe(_shard.table.load(std::memory_order_relaxed), s, _hash, _mixed))
+			return *ff;
+
+		const tt_size _size = _shard.size.load(std::memory_order_relaxed);
+		_table_t* _table = _shard.table.load(std::memory_order_relaxed);
+
+		if (!_table || (_size + 1) * 2 > _table->capacity()) {
+
+
+			_grow(_shard);
+
+			_table = _shard.table.load(std::memory_order_relaxed);
+		}
+
+		// NOTE: the canonical string is fully constructed before it's published to the table, with the
+		//		 release store pairing with the acquire loads of _probe
+
+		if (_arena_backed) {
+
+
+			char_t* _chars = (char_t*)_shard.arena.allocate(s.length() * sizeof(char_t), alignof(char_t));
+
+			tt::copy_block(s.data(), _chars, s.length());
+
+			_shard.strings.push_back(str_t(nullptr, string_view_t(_chars, s.length())));
+		}
+		// NOTE: s_str's block is only shared if s_str views all of it, as otherwise interning a substr would
+		//		 keep the whole of the string it was cut from alive, for as long as the interner lives
+
+		else if (s_str && s_str->_views_whole_block())
+			_shard.strings.push_back(*s_str);
+
+		else
+			_shard.strings.push_back(str_t::_make_block_backed(s));
+
+		const str_t* _str = &_shard.strings.back();
+
+		// NOTE: canonical strings are hashed before being published, so lookups never need to hash them
+
+		(void)_str->hash();
+
+		tt_size i = _mixed & _table->mask;
+
+		while (_table->slots[i].load(std::memory_order_relaxed))
+			i = (i + 1) & _table->mask;
+
+		_table->slots[i].store(_str, std::memory_order_release);
+
+		_shard.size.store(_size + 1, std::memory_order_relaxed);
+
+		return *_str;
+	}
+
+	template<typename Char>
+	inline void basic_str_interner<Char>::_grow(_shard_t& shard) {
+
+
+		// NOTE: the old table is kept alive, as lock-free lookups may still be probing it
+
+		const _table_t* _old = shard.table.load(std::memory_order_relaxed);
+
+		auto _new = std::make_unique<_table_t>(_old ? _old->capacity() * 2 : MIN_TABLE_CAPACITY);
+
+		if (_old) {
+
+
+			TT_FOR(i, _old->capacity()) {
+
+
+				const str_t* _str = _old->slots[i].load(std::memory_order_relaxed);
+
+				if (!_str)
+					continue;
+
+				tt_size j = _mix(_str->hash()) & _new->mask;
+
+				while (_new->slots[j].load(std::memory_order_relaxed))
+					j = (j + 1) & _new->mask;
+
+				_new->slots[j].store(_str, std::memory_order_relaxed);
+			}
+		}
+
+		shard.tables.push_back(std::move(_new));
+
+		shard.table.store(shard.tables.back().get(), std::memory_order_release);
+	}
+
+
+	using str_interner		= basic_str_interner<tt_char>;
+	using wstr_interner		= basic_str_interner<tt_wchar>;
+
+
+	// Returns the canonical string equal to s, of the global interner of Char.
+	template<typename Char>
+	inline tt::basic_str<Char> intern(std::basic_string_view<Char> s) { return tt::basic_str_interner<Char>::global().intern(s); }
+
+	// Returns the canonical string equal to s, of the global interner of Char.
+	template<typename Char>
+	inline tt::basic_str<Char> intern(const tt::basic_str<Char>& s) { return tt::basic_str_interner<Char>::global().intern(s); }
+}
@@ -0,0 +1,243 @@
+
+
+#pragma once
+
+
+// The Tirous Toolbox library's string 'rope' implementation.
+
+// A rope is a sequence of strings, its 'pieces', which together form one long string, such that
+// concatenating strings into a rope copies none of their characters, but instead simply shares the
+// blocks of the strings concatenated, at the cost of a reference count increment per piece.
+
+// Ropes are thus intended for large concatenations (ie. assembling files from many large, already
+// existing, strings) wherein the characters concatenated need only be copied once, if at all, when
+// the rope is finally flattened into a single string.
+
+
+/*
+
+	Ropes store their pieces in a flat array, alongside the cumulative lengths of their pieces, rather than in a
+	balanced tree, as ropes are expected to be built by appending, and then read, with indexing a rope's characters
+	being a binary search of its pieces.
+
+	Pieces appended from string views, rather than strings, must be copied into strings of their own, and so ropes
+	are not a substitute for tt::basic_str_builder when concatenating many small pieces of text.
+
+*/
+
+
+#include <vector>
+#include <algorithm>
+#include <string_view>
+
+#include "aliases.h"
+#include "macros.h"
+#include "debug.h"
+
+#include "exceptions.h"
+#include "slice.h"
+#include "str.h"
+#include "str_builder.h"
+#include "visualize.h"
+
+
+namespace tt {
+
+
+	// The Tirous Toolbox library's string 'rope' implementation.
+	// A sequence of strings which together form one long string, concatenated by sharing their blocks, rather than copying their characters.
+	// Ropes are copyable, with copies sharing the blocks of their pieces, and are not thread-safe.
+	template<typename Char>
+	class basic_str_rope final {
+	public:
+
+		using char_t = typename Char;
+
+		using str_t = tt::basic_str<char_t>;
+		using string_view_t = typename str_t::string_view_t;
+		using builder_t = tt::basic_str_builder<char_t>;
+
+		using this_t = tt::basic_str_rope<char_t>;
+
+
+		// Default initializes an empty rope.
+		basic_str_rope() = default;
+
+		// Initializes a rope of the single piece s.
+		explicit inline basic_str_rope(str_t s) { append(std::move(s)); }
+
+		basic_str_rope(const this_t&) = default;
+		basic_str_rope(this_t&&) noexcept = default;
+
+		~basic_str_rope() noexcept = default;
+
+		this_t& operator=(const this_t&) = default;
+		this_t& operator=(this_t&&) noexcept = default;
+
+
+		// Returns the number of characters of the rope.
+		inline tt_size length() const noexcept { return _ends.empty() ? 0 : _ends.back(); }
+		inline tt_bool has_length() const noexcept { return length() > 0; }
+		inline tt_bool empty() const noexcept { return !has_length(); }
+
+		// Returns the number of pieces of the rope.
+		inline tt_size piece_count() const noexcept { return _pieces.size(); }
+
+		// Returns a slice of the pieces of the rope, in order.
+		// Empty strings are never pieces of a rope.
+		inline tt::slice<const str_t> pieces() const noexcept { return tt::slice<const str_t>(_pieces.data(), _pieces.size()); }
+
+
+		// Returns the character at the given index.
+		// Throws tt::out_of_range_error if ind is out-of-bounds.
+		inline char_t at(tt_size ind) const;
+
+		inline char_t operator[](tt_size ind) const { return at(ind); }
+
+
+		// Appends s to the rope, sharing its block, if any.
+		inline this_t& append(const str_t& s) { return append(str_t(s)); }
+
+		// Appends s to the rope, sharing its block, if any.
+		inline this_t& append(str_t&& s);
+
+		// Appends the characters of v to the rope, copying them into a new piece.
+		inline this_t& append(string_view_t v) { return append(str_t(v)); }
+
+		// Appends the pieces of other to the rope, sharing their blocks.
+		inline this_t& append(const this_t& other);
+
+		inline this_t& operator+=(const str_t& s) { return append(s); }
+		inline this_t& operator+=(str_t&& s) { return append(std::move(s)); }
+		inline this_t& operator+=(string_view_t v) { return append(v); }
+		inline this_t& operator+=(const this_t& other) { return append(other); }
+
+
+		// Returns a string of the characters of the rope.
+		// This copies the characters of the rope once, into a single block, unless the rope has only one piece, which is then simply returned.
+		inline str_t flatten() const;
+
+		// Writes the characters of the rope to builder b, such as to let them be followed by more.
+		inline void flatten_into(builder_t& b) const;
+
+
+		inline tt_string vis() const { return tt_string(flatten().view()); }
+
+
+		// Empties the rope, releasing its pieces.
+		inline void clear() noexcept {
+
+
+			_pieces.clear();
+			_ends.clear();
+		}
+
+		inline void swap(this_t& other) noexcept {
+
+
+			std::swap(_pieces, other._pieces);
+			std::swap(_ends, other._ends);
+		}
+
+
+	private:
+
+		// NOTE: _ends[i] is the index one past the last character of _pieces[i] within the rope
+
+		std::vector<str_t> _pieces;
+		std::vector<tt_size> _ends;
+	};
+
+
+	using str_rope		= basic_str_rope<tt_char>;
+	using wstr_rope		= basic_str_rope<tt_wchar>;
+
+	using str8_rope		= basic_str_rope<tt_char8>;
+	using str16_rope	= basic_str_rope<tt_char16>;
+	using str32_rope	= basic_str_rope<tt_char32>;
+
+
+	template<typename Char>
+	inline typename basic_str_rope<Char>::char_t basic_str_rope<Char>::at(tt_size ind) const {
+
+
+		if (ind >= length())
+			TT_THROW(tt::out_of_range_error, "tt::basic_str_rope index out-of-range!");
+
+		const tt_size _piece = tt_size(std::upper_bound(_ends.begin(), _ends.end(), ind) - _ends.begin());
+
+		const tt_size _start = _piece > 0 ? _ends[_piece - 1] : 0;
+
+		return _pieces[_piece][ind - _start];
+	}
+
+	template<typename Char>
+	inline typename basic_str_rope<Char>::this_t& basic_str_rope<Char>::append(str_t&& s) {
+
+
+		if (s.empty())
+			TT_RETURN_THIS;
+
+		const tt_size _end = length() + s.length();
+
+		_ends.push_back(_end);
+
+		try {
+
+
+			_pieces.push_back(std::move(s));
+		}
+		catch (...) {
+
+
+			_ends.pop_back();
+
+			throw;
+		}
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Char>
+	inline typename basic_str_rope<Char>::this_t& basic_str_rope<Char>::append(const this_t& other) {
+
+
+		// NOTE: other may be this rope, and so its piece count is taken beforehand
+
+		const tt_size _n = other.piece_count();
+
+		_pieces.reserve(_pieces.size() + _n);
+		_ends.reserve(_ends.size() + _n);
+
+		TT_FOR(i, _n)
+			append(other._pieces[i]);
+
+		TT_RETURN_THIS;
+	}
+
+	template<typename Char>
+	inline typename basic_str_rope<Char>::str_t basic_str_rope<Char>::flatten() const {
+
+
+		if (_pieces.size() == 1)
+			return _pieces.front();
+
+		builder_t b;
+
+		flatten_into(b);
+
+		return b.build();
+	}
+
+	template<typename Char>
+	inline void basic_str_rope<Char>::flatten_into(builder_t& b) const {
+
+
+		b.reserve(b.length() + length());
+
+		for (const auto& i : _pieces)
+			b.append(i);
+	}
+}
+
+TT_VISUALIZERS(0) { TT_REGISTER_VISUALIZE_T(tt::basic_str_rope, <typename Char>, <Char>); }
@@ -42,6 +42,7 @@ namespace tt {
 	
 
 	TT_EXCEPTION_STRUCT(thread_pool_zero_workers_error);
+	TT_EXCEPTION_STRUCT(thread_pool_inert_error);
 
 	class thread_pool final {
 	public:
@@ -97,6 +98,7 @@ namespace tt {
 
 		// Dispatches task x, adding it to the task queue of the thread-pool.
 		// Fails quietly if x is nullptr.
+		// Throws tt::thread_pool_inert_error if the thread-pool is inert (ie. it was shutdown), with x being discarded.
 		inline void dispatch_task(std::unique_ptr<tt::task> x);
 
 		// Dispatches a tt::regular_task<FType> of function f, using fargs, adding it to the task queue of the thread-pool.
@@ -108,7 +110,13 @@ namespace tt {
 
 	private:
 
+		// NOTE: tasks may use the thread-pool from worker-threads which are still running as it's shutdown
+		//		 (ie. tt::walk_directory), so _state is only ever accessed via std::atomic_load/std::atomic_store
+
 		std::shared_ptr<_tt::thread_pool_state> _state;
+
+
+		inline std::shared_ptr<_tt::thread_pool_state> _load_state() const noexcept;
 	};
 }
 
@@ -134,6 +142,7 @@ namespace _tt {
 		std::queue<std::unique_ptr<tt::task>>				task_queue			= {};
 		std::promise<void>									shutdown_promise	= {};
 		std::weak_ptr<thread_pool_state>					weak_this			= {};
+		tt_bool												shutdown_called		= false;
 
 #ifdef _TT_ENABLE_THREAD_POOL_DEBUGGING
 		std::mutex											debug_mtx			= {};
@@ -250,6 +259,11 @@ namespace _tt {
 		{
 			std::scoped_lock lk(mtx);
 
+			// NOTE: tasks dispatched concurrently with shutdown must not be queued after it discards the task queue
+
+			if (shutdown_called)
+				TT_THROW(tt::thread_pool_inert_error, "cannot dispatch tasks to a thread-pool which was shutdown!");
+
 			task_queue.push(std::move(x));
 
 			++tasks;
@@ -280,6 +294,8 @@ namespace _tt {
 
 		std::scoped_lock lk(mtx);
 
+		shutdown_called = true;
+
 		// NOTE: discard any tasks in the task queue
 
 		while (!task_queue.empty())
@@ -422,21 +438,23 @@ namespace tt {
 		if (n == 0)
 			TT_THROW(thread_pool_zero_workers_error, "tt::thread_pool::thread_pool n may not be 0!");
 
-		_state = std::make_shared<_tt::thread_pool_state>();
+		auto _s = std::make_shared<_tt::thread_pool_state>();
+
+		_s->startup(n, _s);
 
-		_state->startup(n, _state);
+		std::atomic_store(&_state, std::move(_s));
 	}
 
 	inline tt::thread_pool::thread_pool(thread_pool&& x) noexcept
-		: _state(TT_FMOVE(std::shared_ptr<_tt::thread_pool_state>, x._state)) {}
+		: _state(std::atomic_exchange(&x._state, std::shared_ptr<_tt::thread_pool_state>())) {}
 
 	inline tt::thread_pool::~thread_pool() noexcept {
 
 
 		// NOTE: remember that an 'inert' thread-pool still needs a working destructor
 
-		if (_state)
-			_state->shutdown();
+		if (const auto _s = _load_state())
+			_s->shutdown();
 	}
 
 	inline thread_pool& tt::thread_pool::operator=(thread_pool&& rhs) noexcept {
@@ -444,7 +462,7 @@ namespace tt {
 
 		TT_SELF_MOVE_TEST(rhs);
 
-		TT_MOVESET(_state, rhs, nullptr);
+		std::atomic_store(&_state, std::atomic_exchange(&rhs._state, std::shared_ptr<_tt::thread_pool_state>()));
 
 		TT_RETURN_THIS;
 	}
@@ -452,64 +470,82 @@ namespace tt {
 	inline std::future<void> tt::thread_pool::get_shutdown_future() {
 
 
-		tt_assert(_state);
+		const auto _s = _load_state();
+
+		tt_assert(_s);
 
-		return _state->shutdown_promise.get_future();
+		return _s->shutdown_promise.get_future();
 	}
 
 	inline void tt::thread_pool::shutdown() {
 
 
-		tt_assert(_state);
+		const auto _s = std::atomic_exchange(&_state, std::shared_ptr<_tt::thread_pool_state>());
 
-		_state->shutdown();
+		tt_assert(_s);
 
-		_state = nullptr;
+		_s->shutdown();
 	}
 
 	inline tt_size tt::thread_pool::get_worker_threads() const noexcept {
 
 
-		tt_assert(_state);
+		const auto _s = _load_state();
 
-		return _state->designated_workers;
+		tt_assert(_s);
+
+		return _s->designated_workers;
 	}
 
 	inline void tt::thread_pool::set_worker_threads(tt_size n) {
 
 
-		tt_assert(_state);
+		const auto _s = _load_state();
+
+		tt_assert(_s);
 
-		if (n > _state->designated_workers)
-			_state->add_workers(n - _state->designated_workers);
+		const tt_size _designated = _s->designated_workers;
 
-		else if (n < _state->designated_workers)
-			_state->remove_workers(_state->designated_workers - n);
+		if (n > _designated)
+			_s->add_workers(n - _designated);
+
+		else if (n < _designated)
+			_s->remove_workers(_designated - n);
 	}
 
 	inline tt_size tt::thread_pool::get_tasks() const noexcept {
 
 
-		tt_assert(_state);
+		const auto _s = _load_state();
+
+		tt_assert(_s);
 
-		return _state->tasks;
+		return _s->tasks;
 	}
 
 	inline tt_size tt::thread_pool::get_exceptions() const noexcept {
 
 
-		tt_assert(_state);
+		const auto _s = _load_state();
+
+		tt_assert(_s);
 
-		return _state->exceptions;
+		return _s->exceptions;
 	}
 
 	inline void tt::thread_pool::dispatch_task(std::unique_ptr<tt::task> x) {
 
 
-		tt_assert(_state);
+		// NOTE: as the thread-pool may be shutdown concurrently (see _state), this throws, rather
+		//		 than asserts, if the thread-pool is inert
+
+		const auto _s = _load_state();
+
+		if (!_s)
+			TT_THROW(tt::thread_pool_inert_error, "cannot dispatch tasks to an inert thread-pool!");
 
 		if (x)
-			_state->dispatch_task(std::move(x));
+			_s->dispatch_task(std::move(x));
 	}
 
 	template<typename FType, typename F, typename... FArgs>
@@ -523,5 +559,11 @@ namespace tt {
 
 		return _future;
 	}
+
+	inline std::shared_ptr<_tt::thread_pool_state> tt::thread_pool::_load_state() const noexcept {
+
+
+		return std::atomic_load(&_state);
+	}
 }
 